@@ -307,6 +307,17 @@ static CGFloat SDImageScaleFromPath(NSString *string) {
     return [self.animatedCoder animatedImageFrameAtIndex:index];
 }
 
+- (UIImage *)animatedImageFrameAtIndex:(NSUInteger)index thumbnailSize:(CGSize)thumbnailSize {
+    if (index >= self.animatedImageFrameCount) {
+        return nil;
+    }
+    if (self.isAllFramesLoaded || ![self.animatedCoder respondsToSelector:@selector(animatedImageFrameAtIndex:thumbnailSize:)]) {
+        // Already decoded, or coder does not support
+        return [self animatedImageFrameAtIndex:index];
+    }
+    return [self.animatedCoder animatedImageFrameAtIndex:index thumbnailSize:thumbnailSize];
+}
+
 - (NSTimeInterval)animatedImageDurationAtIndex:(NSUInteger)index {
     if (index >= self.animatedImageFrameCount) {
         return 0;
@@ -0,0 +1,65 @@
+/*
+* This file is part of the SDWebImage package.
+* (c) Olivier Poitrey <rs@dailymotion.com>
+*
+* For the full copyright and license information, please view the LICENSE
+* file that was distributed with this source code.
+*/
+
+#import <Foundation/Foundation.h>
+#import "SDWebImageCompat.h"
+
+@class SDAnimatedImagePlayer;
+
+/// The budget allocated to one animated image player, see `SDAnimatedImageGovernor.allocations`
+@interface SDAnimatedImageBudgetAllocation : NSObject
+
+/// The player which the budget allocated to
+@property (nonatomic, weak, readonly, nullable) SDAnimatedImagePlayer *player;
+/// The visible area in points of the player's view, which is the part of bounds not clipped by the window and the clipping superviews
+@property (nonatomic, assign, readonly) CGFloat visibleArea;
+/// The average frame rate (frames per second) of the animation, multiply the playback rate. This is sampled from the leading frames the player played, and updated on each rebalance
+@property (nonatomic, assign, readonly) double frameRate;
+/// The weight of this player, which is `visibleArea * frameRate`
+@property (nonatomic, assign, readonly) double weight;
+/// The memory cost in bytes allocated to the frame buffer. Players which share the same animated image share the same frame buffer, and get the total memory cost of them.
+@property (nonatomic, assign, readonly) NSUInteger memoryCost;
+/// The max concurrent decode count allocated to the frame buffer
+@property (nonatomic, assign, readonly) NSUInteger concurrentDecodeCount;
+
+@end
+
+/**
+ A process-wide governor which owns one memory and CPU budget for all the visible animated images, and split it across the frame buffers by visible area and frame rate.
+ `SDAnimatedImageView` register its player when moved to window, update the visible area on layout, and unregister when removed from window, the budget is rebalanced for each change. Changing the player's `playbackRate` rebalance the budget as well.
+ @note If the player's `maxBufferSize` is not zero, that value is used for the player instead of the budget allocated by governor.
+ */
+@interface SDAnimatedImageGovernor : NSObject
+
+/// The shared governor
+@property (nonatomic, class, readonly, nonnull) SDAnimatedImageGovernor *sharedGovernor;
+
+/// The total memory cost in bytes of all the animated frame buffers. Defaults to 0.
+/// `0` means automatically calculate by current memory usage, which is re-calculated on each rebalance (so the budget follows the free memory when players come and go).
+@property (nonatomic, assign) NSUInteger maxMemoryCost;
+
+/// The total max concurrent decode count of all the animated frame buffers. Defaults to the active processor count.
+/// This is a hard limit while any player is registered: the frames decoding at the same time across all the frame buffers never exceed it, even when each frame buffer is allocated the minimum one worker.
+@property (nonatomic, assign) NSUInteger maxConcurrentDecodeCount;
+
+/// The current budget allocations for all the registered players, in registration order.
+@property (nonatomic, copy, readonly, nonnull) NSArray<SDAnimatedImageBudgetAllocation *> *allocations;
+
+/// Register a player or update its visible area, then rebalance the budget. Nothing happens if the player is registered with the same visible area.
+/// @param player The animated image player
+/// @param visibleArea The visible area in points of the player's view
+- (void)registerPlayer:(nonnull SDAnimatedImagePlayer *)player visibleArea:(CGFloat)visibleArea;
+
+/// Unregister a player, then rebalance the budget. The player use its own buffer size calculation after unregistered.
+/// @param player The animated image player
+- (void)unregisterPlayer:(nonnull SDAnimatedImagePlayer *)player;
+
+/// Rebalance the budget across all the registered players. This is called automatically when registering or unregistering player, or when the max values changed.
+- (void)rebalance;
+
+@end
@@ -0,0 +1,233 @@
+/*
+* This file is part of the SDWebImage package.
+* (c) Olivier Poitrey <rs@dailymotion.com>
+*
+* For the full copyright and license information, please view the LICENSE
+* file that was distributed with this source code.
+*/
+
+#import "SDAnimatedImageGovernor.h"
+#import "SDAnimatedImagePlayer.h"
+#import "SDImageFramePool.h"
+#import "SDDeviceHelper.h"
+#import "SDInternalMacros.h"
+
+@interface SDAnimatedImagePlayer ()
+
+@property (nonatomic, strong) SDImageFramePool *framePool;
+@property (nonatomic, strong) id<SDAnimatedImageProvider> animatedProvider;
+@property (nonatomic, weak) SDAnimatedImageGovernor *governor;
+
+- (NSTimeInterval)averageFrameDuration;
+- (void)applyBudgetWithMemoryCost:(NSUInteger)memoryCost concurrentDecodeCount:(NSUInteger)concurrentDecodeCount;
+
+@end
+
+@interface SDAnimatedImageBudgetAllocation () <NSCopying>
+
+@property (nonatomic, weak, readwrite) SDAnimatedImagePlayer *player;
+@property (nonatomic, assign, readwrite) CGFloat visibleArea;
+@property (nonatomic, assign, readwrite) double frameRate;
+@property (nonatomic, assign, readwrite) double weight;
+@property (nonatomic, assign, readwrite) NSUInteger memoryCost;
+@property (nonatomic, assign, readwrite) NSUInteger concurrentDecodeCount;
+
+@end
+
+@implementation SDAnimatedImageBudgetAllocation
+
+- (id)copyWithZone:(NSZone *)zone {
+    SDAnimatedImageBudgetAllocation *allocation = [SDAnimatedImageBudgetAllocation new];
+    allocation.player = self.player;
+    allocation.visibleArea = self.visibleArea;
+    allocation.frameRate = self.frameRate;
+    allocation.weight = self.weight;
+    allocation.memoryCost = self.memoryCost;
+    allocation.concurrentDecodeCount = self.concurrentDecodeCount;
+    return allocation;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p, player: %p, visibleArea: %.0f, frameRate: %.1f, memoryCost: %lu, concurrentDecodeCount: %lu>", self.class, self, self.player, self.visibleArea, self.frameRate, (unsigned long)self.memoryCost, (unsigned long)self.concurrentDecodeCount];
+}
+
+@end
+
+@interface SDAnimatedImageGovernor () {
+    SD_LOCK_DECLARE(_lock);
+}
+
+@property (nonatomic, strong) NSMutableArray<SDAnimatedImageBudgetAllocation *> *registeredAllocations;
+
+@end
+
+@implementation SDAnimatedImageGovernor
+
++ (SDAnimatedImageGovernor *)sharedGovernor {
+    static dispatch_once_t onceToken;
+    static SDAnimatedImageGovernor *governor;
+    dispatch_once(&onceToken, ^{
+        governor = [[SDAnimatedImageGovernor alloc] init];
+    });
+    return governor;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _registeredAllocations = [NSMutableArray array];
+        _maxConcurrentDecodeCount = NSProcessInfo.processInfo.activeProcessorCount;
+        SD_LOCK_INIT(_lock);
+    }
+    return self;
+}
+
+- (void)setMaxMemoryCost:(NSUInteger)maxMemoryCost {
+    _maxMemoryCost = maxMemoryCost;
+    [self rebalance];
+}
+
+- (void)setMaxConcurrentDecodeCount:(NSUInteger)maxConcurrentDecodeCount {
+    _maxConcurrentDecodeCount = MAX(maxConcurrentDecodeCount, 1);
+    [self rebalance];
+}
+
+- (NSArray<SDAnimatedImageBudgetAllocation *> *)allocations {
+    NSMutableArray<SDAnimatedImageBudgetAllocation *> *allocations = [NSMutableArray array];
+    SD_LOCK(_lock);
+    for (SDAnimatedImageBudgetAllocation *allocation in self.registeredAllocations) {
+        if (allocation.player) {
+            [allocations addObject:[allocation copy]];
+        }
+    }
+    SD_UNLOCK(_lock);
+    return [allocations copy];
+}
+
+#pragma mark - Register
+
+- (void)registerPlayer:(SDAnimatedImagePlayer *)player visibleArea:(CGFloat)visibleArea {
+    if (!player) {
+        return;
+    }
+    visibleArea = MAX(visibleArea, 1);
+    SD_LOCK(_lock);
+    SDAnimatedImageBudgetAllocation *allocation = [self allocationForPlayer:player];
+    if (allocation && allocation.visibleArea == visibleArea) {
+        // Nothing changed
+        SD_UNLOCK(_lock);
+        return;
+    }
+    if (!allocation) {
+        allocation = [SDAnimatedImageBudgetAllocation new];
+        allocation.player = player;
+        [self.registeredAllocations addObject:allocation];
+    }
+    allocation.visibleArea = visibleArea;
+    SD_UNLOCK(_lock);
+    player.governor = self;
+    [self rebalance];
+}
+
+- (void)unregisterPlayer:(SDAnimatedImagePlayer *)player {
+    if (!player) {
+        return;
+    }
+    SD_LOCK(_lock);
+    SDAnimatedImageBudgetAllocation *allocation = [self allocationForPlayer:player];
+    if (allocation) {
+        [self.registeredAllocations removeObject:allocation];
+    }
+    SD_UNLOCK(_lock);
+    if (!allocation) {
+        return;
+    }
+    if (player.governor == self) {
+        player.governor = nil;
+    }
+    // Back to the player's own buffer size calculation
+    [player applyBudgetWithMemoryCost:0 concurrentDecodeCount:0];
+    [self rebalance];
+}
+
+#pragma mark - Rebalance
+
+- (void)rebalance {
+    NSUInteger maxMemoryCost = self.maxMemoryCost;
+    if (maxMemoryCost == 0) {
+        // Calculate based on current memory, these factors are by experience, shared by all players
+        NSUInteger total = [SDDeviceHelper totalMemory];
+        NSUInteger free = [SDDeviceHelper freeMemory];
+        maxMemoryCost = MIN(total * 0.2, free * 0.6);
+    }
+    NSUInteger maxConcurrentDecodeCount = self.maxConcurrentDecodeCount;
+
+    NSMutableArray<SDAnimatedImageBudgetAllocation *> *allocations = [NSMutableArray array];
+    SD_LOCK(_lock);
+    // Remove the released players
+    NSMutableArray<SDAnimatedImageBudgetAllocation *> *releasedAllocations = [NSMutableArray array];
+    for (SDAnimatedImageBudgetAllocation *allocation in self.registeredAllocations) {
+        if (!allocation.player) {
+            [releasedAllocations addObject:allocation];
+        }
+    }
+    [self.registeredAllocations removeObjectsInArray:releasedAllocations];
+
+    // Players of the same animated image share one frame pool, sum the weight for each frame pool
+    NSMapTable<SDImageFramePool *, NSNumber *> *poolWeights = [NSMapTable strongToStrongObjectsMapTable];
+    double totalWeight = 0;
+    for (SDAnimatedImageBudgetAllocation *allocation in self.registeredAllocations) {
+        SDAnimatedImagePlayer *player = allocation.player;
+        // Re-calculate each time, the playback rate and the sampled frame durations may change
+        allocation.frameRate = [self.class frameRateForPlayer:player];
+        allocation.weight = allocation.visibleArea * allocation.frameRate;
+        totalWeight += allocation.weight;
+        SDImageFramePool *framePool = player.framePool;
+        if (framePool) {
+            double poolWeight = [[poolWeights objectForKey:framePool] doubleValue] + allocation.weight;
+            [poolWeights setObject:@(poolWeight) forKey:framePool];
+        }
+    }
+    for (SDAnimatedImageBudgetAllocation *allocation in self.registeredAllocations) {
+        SDAnimatedImagePlayer *player = allocation.player;
+        double poolWeight = [[poolWeights objectForKey:player.framePool] doubleValue];
+        double ratio = totalWeight > 0 ? poolWeight / totalWeight : 0;
+        allocation.memoryCost = MAX((NSUInteger)(maxMemoryCost * ratio), 1);
+        // Each frame pool need at least one worker to make progress, the sum may exceed the budget when there are many frame pools, which is enforced by the global decode slots below
+        allocation.concurrentDecodeCount = MAX((NSUInteger)(maxConcurrentDecodeCount * ratio), 1);
+        [allocations addObject:allocation];
+    }
+    BOOL governed = self.registeredAllocations.count > 0;
+    SD_UNLOCK(_lock);
+    
+    // The frames decoding at the same time across all the frame pools never exceed the budget
+    SDImageFramePool.globalMaxConcurrentCount = governed ? maxConcurrentDecodeCount : 0;
+
+    // Apply outside the lock
+    for (SDAnimatedImageBudgetAllocation *allocation in allocations) {
+        [allocation.player applyBudgetWithMemoryCost:allocation.memoryCost concurrentDecodeCount:allocation.concurrentDecodeCount];
+    }
+}
+
+#pragma mark - Util
+
+// Should be called inside lock
+- (SDAnimatedImageBudgetAllocation *)allocationForPlayer:(SDAnimatedImagePlayer *)player {
+    for (SDAnimatedImageBudgetAllocation *allocation in self.registeredAllocations) {
+        if (allocation.player == player) {
+            return allocation;
+        }
+    }
+    return nil;
+}
+
+// Use the durations sampled by the player, scanning all the frame durations is expensive for large animated image
++ (double)frameRateForPlayer:(SDAnimatedImagePlayer *)player {
+    NSTimeInterval averageFrameDuration = [player averageFrameDuration];
+    if (averageFrameDuration <= 0) {
+        return 1;
+    }
+    return 1 / averageFrameDuration * MAX(player.playbackRate, 0);
+}
+
+@end
@@ -66,6 +66,28 @@ typedef NS_ENUM(NSUInteger, SDAnimatedImagePlaybackMode) {
 /// `NSUIntegerMax` means cache all the buffer. (Lowest CPU and Highest Memory)
 @property (nonatomic, assign) NSUInteger maxBufferSize;
 
+/// The number of frames ahead of the current frame to decode concurrently, used for expensive decoding (such as high resolution Animated WebP/APNG) which one core can not keep up with the frame rate. Default is 0.
+/// `0` means decode one frame at a time, or use the concurrent decode count allocated by `SDAnimatedImageGovernor` when the player is governed. `1` means decode one frame at a time.
+/// `> 1` means decode the next N frames with up to N background workers (limited by the processor count). The lookahead window is still limited by `maxBufferSize`, and frames are displayed in order.
+@property (nonatomic, assign) NSUInteger lookaheadFrameCount;
+
+/// The average count of buffer miss per second since the animation start playing, which means the next frame is not decoded when its timestamp is reached. This value is reset when stop playing.
+/// This can be used to detect whether the decoding speed is slower than rendering speed, and tune `lookaheadFrameCount` or `maxBufferSize`.
+@property (nonatomic, readonly) double bufferMissesPerSecond;
+
+/// The max pixel size to decode the frames, keep aspect ratio. Frames larger than this size are decoded through the thumbnail path if the provider supports `animatedImageFrameAtIndex:thumbnailSize:`, which save the frame buffer memory and decode time when rendering size is much smaller than the source size. Default is zero.
+/// `CGSizeZero` means decode frames with the full pixel size.
+/// @note The frame buffer is shared only between players which use the same provider and the same thumbnail pixel size. `SDAnimatedImageView` set this automatically when `decodeAtDisplaySize` is YES.
+@property (nonatomic, assign) CGSize thumbnailPixelSize;
+
+/// Whether to keep the animation in sync with wall-clock time when decoding falls behind. Default is NO.
+/// `NO` means when the next frame is not decoded, the current frame is held until it's ready, the animation runs slower than its real time.
+/// `YES` means the time still goes on when the next frame is not decoded, the frames which timestamp already passed are skipped, and the frame which will be due after the measured decode latency is prefetched. When frames keep being skipped, the frames are decoded at half resolution if the provider supports `animatedImageFrameAtIndex:thumbnailSize:`, until stop playing.
+@property (nonatomic, assign) BOOL realTimePlayback;
+
+/// The count of frames skipped in real-time playback since the animation start playing. This value is reset when stop playing.
+@property (nonatomic, readonly) NSUInteger skippedFrameCount;
+
 /// You can specify a runloop mode to let it rendering.
 /// Default is NSRunLoopCommonModes on multi-core device, NSDefaultRunLoopMode on single-core device
 @property (nonatomic, copy, nonnull) NSRunLoopMode runLoopMode;
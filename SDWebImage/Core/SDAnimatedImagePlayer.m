@@ -11,8 +11,14 @@
 #import "SDDisplayLink.h"
 #import "SDDeviceHelper.h"
 #import "SDImageFramePool.h"
+#import "SDAnimatedImageGovernor.h"
 #import "SDInternalMacros.h"
 
+// The consecutive skipped frame count in real-time mode to lower the decode resolution
+static const NSUInteger kSDAnimatedImagePlayerReduceResolutionSkippedCount = 3;
+// The leading frame count to sample the average frame duration before playing
+static const NSUInteger kSDAnimatedImagePlayerFrameDurationSampleCount = 4;
+
 @interface SDAnimatedImagePlayer () {
     NSRunLoopMode _runLoopMode;
 }
@@ -26,6 +32,16 @@
 @property (nonatomic, assign) NSUInteger currentFrameBytes;
 @property (nonatomic, assign) NSTimeInterval currentTime;
 @property (nonatomic, assign) BOOL bufferMiss;
+@property (nonatomic, assign) NSUInteger bufferMissCount;
+@property (nonatomic, assign, readwrite) NSUInteger skippedFrameCount;
+@property (nonatomic, assign) NSUInteger consecutiveSkippedFrameCount;
+@property (nonatomic, assign) BOOL reducedDecodeResolution;
+@property (nonatomic, assign) NSUInteger budgetMemoryCost; // allocated by `SDAnimatedImageGovernor`, 0 means not governed
+@property (nonatomic, assign) NSUInteger budgetConcurrentDecodeCount;
+@property (nonatomic, weak) SDAnimatedImageGovernor *governor;
+@property (nonatomic, assign) NSTimeInterval sampledFrameDuration; // sum of the durations of the leading frames, in order
+@property (nonatomic, assign) NSUInteger sampledFrameCount;
+@property (nonatomic, assign) NSTimeInterval playingDuration;
 @property (nonatomic, assign) BOOL needsDisplayWhenImageBecomesAvailable;
 @property (nonatomic, assign) BOOL shouldReverse;
 @property (nonatomic, strong) SDDisplayLink *displayLink;
@@ -59,14 +75,15 @@
 
 - (void)dealloc {
     // Dereference the frame pool, when zero the frame pool for provider will dealloc
-    [SDImageFramePool unregisterProvider:self.animatedProvider];
+    [SDImageFramePool unregisterProvider:self.animatedProvider thumbnailSize:self.framePool.preferredThumbnailSize];
 }
 
 #pragma mark - Private
 
 - (SDDisplayLink *)displayLink {
     if (!_displayLink) {
-        _displayLink = [SDDisplayLink displayLinkWithTarget:self selector:@selector(displayDidRefresh:)];
+        // All players share one underlying display link
+        _displayLink = [SDDisplayLink sharedDisplayLinkWithTarget:self selector:@selector(displayDidRefresh:)];
         [_displayLink addToRunLoop:[NSRunLoop mainRunLoop] forMode:self.runLoopMode];
         [_displayLink stop];
     }
@@ -132,6 +149,15 @@
     _currentLoopCount = 0;
     _currentTime = 0;
     _bufferMiss = NO;
+    _bufferMissCount = 0;
+    _playingDuration = 0;
+    _skippedFrameCount = 0;
+    _consecutiveSkippedFrameCount = 0;
+    if (_reducedDecodeResolution) {
+        _reducedDecodeResolution = NO;
+        // Back to the frame pool shared by players with the same size
+        [self switchFramePoolWithThumbnailSize:_thumbnailPixelSize];
+    }
     _needsDisplayWhenImageBecomesAvailable = NO;
 }
 
@@ -139,8 +165,98 @@
     [self.framePool removeAllFrames];
 }
 
+- (void)setThumbnailPixelSize:(CGSize)thumbnailPixelSize {
+    if (CGSizeEqualToSize(_thumbnailPixelSize, thumbnailPixelSize)) {
+        return;
+    }
+    _thumbnailPixelSize = thumbnailPixelSize;
+    // Switch to the frame pool shared by players with the same size
+    self.reducedDecodeResolution = NO;
+    [self switchFramePoolWithThumbnailSize:thumbnailPixelSize];
+}
+
+- (void)switchFramePoolWithThumbnailSize:(CGSize)thumbnailSize {
+    SDImageFramePool *previousFramePool = self.framePool;
+    self.framePool = [SDImageFramePool registerProvider:self.animatedProvider thumbnailSize:thumbnailSize];
+    [SDImageFramePool unregisterProvider:self.animatedProvider thumbnailSize:previousFramePool.preferredThumbnailSize];
+    // Frame bytes changed, re-calculate the max buffer count with the next decoded frame
+    self.currentFrameBytes = 0;
+    [self updateMaxConcurrentCount];
+}
+
+- (void)setLookaheadFrameCount:(NSUInteger)lookaheadFrameCount {
+    _lookaheadFrameCount = lookaheadFrameCount;
+    [self updateMaxConcurrentCount];
+}
+
+// The lookahead frame count in use, when not specified by user, the concurrent decode count allocated by governor is used
+- (NSUInteger)effectiveLookaheadFrameCount {
+    if (self.lookaheadFrameCount == 0 && self.budgetConcurrentDecodeCount > 1) {
+        return self.budgetConcurrentDecodeCount;
+    }
+    return self.lookaheadFrameCount;
+}
+
+- (void)updateMaxConcurrentCount {
+    // Up to one worker per processor
+    NSUInteger maxConcurrentCount = MIN(self.effectiveLookaheadFrameCount, NSProcessInfo.processInfo.activeProcessorCount);
+    if (self.budgetConcurrentDecodeCount > 0) {
+        maxConcurrentCount = MIN(maxConcurrentCount, self.budgetConcurrentDecodeCount);
+    }
+    self.framePool.maxConcurrentCount = MAX(maxConcurrentCount, 1);
+}
+
+- (void)applyBudgetWithMemoryCost:(NSUInteger)memoryCost concurrentDecodeCount:(NSUInteger)concurrentDecodeCount {
+    self.budgetMemoryCost = memoryCost;
+    self.budgetConcurrentDecodeCount = concurrentDecodeCount;
+    [self updateMaxConcurrentCount];
+    if (self.currentFrame) {
+        [self calculateMaxBufferCountWithFrame:self.currentFrame];
+    }
+}
+
+- (void)setPlaybackRate:(double)playbackRate {
+    if (_playbackRate == playbackRate) {
+        return;
+    }
+    _playbackRate = playbackRate;
+    // The frame rate changed, rebalance the budget
+    [self.governor rebalance];
+}
+
+// The average frame duration of the frames sampled so far, without playback rate. The frames are sampled in order while playing, so it never scan all the frame durations at once
+- (NSTimeInterval)averageFrameDuration {
+    if (self.sampledFrameCount == 0) {
+        NSUInteger sampleCount = MIN(self.totalFrameCount, kSDAnimatedImagePlayerFrameDurationSampleCount);
+        for (NSUInteger i = 0; i < sampleCount; i++) {
+            [self sampleFrameDuration:[self.animatedProvider animatedImageDurationAtIndex:i] atIndex:i];
+        }
+    }
+    if (self.sampledFrameCount == 0) {
+        return 0;
+    }
+    return self.sampledFrameDuration / self.sampledFrameCount;
+}
+
+- (void)sampleFrameDuration:(NSTimeInterval)duration atIndex:(NSUInteger)index {
+    if (index != self.sampledFrameCount || index >= self.totalFrameCount) {
+        // Already sampled, or out of order
+        return;
+    }
+    self.sampledFrameDuration += duration;
+    self.sampledFrameCount++;
+}
+
+- (double)bufferMissesPerSecond {
+    if (self.playingDuration <= 0) {
+        return 0;
+    }
+    return self.bufferMissCount / self.playingDuration;
+}
+
 #pragma mark - Animation Control
 - (void)startPlaying {
+    self.displayLink.preferredFrameInterval = 0;
     [self.displayLink start];
     // Setup frame
     [self setupCurrentFrame];
@@ -195,24 +311,15 @@
     
     // Calculate refresh duration
     NSTimeInterval duration = self.displayLink.duration;
+    self.playingDuration += duration;
     
     NSUInteger currentFrameIndex = self.currentFrameIndex;
-    NSUInteger nextFrameIndex = (currentFrameIndex + 1) % totalFrameCount;
-    
-    if (self.playbackMode == SDAnimatedImagePlaybackModeReverse) {
-        nextFrameIndex = currentFrameIndex == 0 ? (totalFrameCount - 1) : (currentFrameIndex - 1) % totalFrameCount;
-        
-    } else if (self.playbackMode == SDAnimatedImagePlaybackModeBounce ||
-               self.playbackMode == SDAnimatedImagePlaybackModeReversedBounce) {
-        if (currentFrameIndex == 0) {
-            self.shouldReverse = NO;
-        } else if (currentFrameIndex == totalFrameCount - 1) {
-            self.shouldReverse = YES;
-        }
-        nextFrameIndex = self.shouldReverse ? (currentFrameIndex - 1) : (currentFrameIndex + 1);
-        nextFrameIndex %= totalFrameCount;
-    }
+    BOOL shouldReverse = self.shouldReverse;
+    NSUInteger nextFrameIndex = [self nextFrameIndexOfIndex:currentFrameIndex shouldReverse:&shouldReverse];
+    self.shouldReverse = shouldReverse;
     
+    // Tell frame pool the play head, frames behind it will be evicted first
+    [self updateFramePoolPlayHead];
     
     // Check if we need to display new frame firstly
     if (self.needsDisplayWhenImageBecomesAvailable) {
@@ -224,24 +331,42 @@
             self.currentFrame = currentFrame;
             [self handleFrameChange];
             
+            if (!self.bufferMiss) {
+                // Decoding catch up the rendering
+                self.consecutiveSkippedFrameCount = 0;
+            }
             self.bufferMiss = NO;
             self.needsDisplayWhenImageBecomesAvailable = NO;
         }
         else {
+            if (!self.bufferMiss) {
+                self.bufferMissCount++;
+            }
             self.bufferMiss = YES;
         }
     }
     
+    // In real-time mode, the time still goes on when buffer miss, skip the late frames
+    if (self.bufferMiss && self.realTimePlayback) {
+        [self skipLateFramesWithDuration:duration];
+        // Wake up on every refresh to display the frame as soon as it's decoded
+        self.displayLink.preferredFrameInterval = 0;
+        return;
+    }
+    
     // Check if we have the frame buffer
     if (!self.bufferMiss) {
         // Then check if timestamp is reached
         self.currentTime += duration;
         NSTimeInterval currentDuration = [self.animatedProvider animatedImageDurationAtIndex:currentFrameIndex];
+        [self sampleFrameDuration:currentDuration atIndex:currentFrameIndex];
         currentDuration = currentDuration / playbackRate;
         if (self.currentTime < currentDuration) {
             // Current frame timestamp not reached, prefetch frame in advance.
             [self prefetchFrameAtIndex:currentFrameIndex
                              nextIndex:nextFrameIndex];
+            // Do not wake up until the current frame timestamp is reached
+            self.displayLink.preferredFrameInterval = currentDuration - self.currentTime;
             return;
         }
         
@@ -251,7 +376,7 @@
         self.currentTime -= currentDuration;
         NSTimeInterval nextDuration = [self.animatedProvider animatedImageDurationAtIndex:nextFrameIndex];
         nextDuration = nextDuration / playbackRate;
-        if (self.currentTime > nextDuration) {
+        if (self.currentTime > nextDuration && !self.realTimePlayback) {
             // Do not skip frame
             self.currentTime = nextDuration;
         }
@@ -278,6 +403,106 @@
     
     [self prefetchFrameAtIndex:currentFrameIndex
                      nextIndex:nextFrameIndex];
+    // Wake up on every refresh to display the next frame as soon as it's decoded
+    self.displayLink.preferredFrameInterval = 0;
+}
+
+// Calculate the next frame index by playback mode, update the reverse flag for bounce mode
+- (NSUInteger)nextFrameIndexOfIndex:(NSUInteger)currentFrameIndex shouldReverse:(BOOL *)shouldReverse {
+    NSUInteger totalFrameCount = self.totalFrameCount;
+    NSUInteger nextFrameIndex = (currentFrameIndex + 1) % totalFrameCount;
+    
+    if (self.playbackMode == SDAnimatedImagePlaybackModeReverse) {
+        nextFrameIndex = currentFrameIndex == 0 ? (totalFrameCount - 1) : (currentFrameIndex - 1) % totalFrameCount;
+        
+    } else if (self.playbackMode == SDAnimatedImagePlaybackModeBounce ||
+               self.playbackMode == SDAnimatedImagePlaybackModeReversedBounce) {
+        if (currentFrameIndex == 0) {
+            *shouldReverse = NO;
+        } else if (currentFrameIndex == totalFrameCount - 1) {
+            *shouldReverse = YES;
+        }
+        nextFrameIndex = *shouldReverse ? (currentFrameIndex - 1) : (currentFrameIndex + 1);
+        nextFrameIndex %= totalFrameCount;
+    }
+    return nextFrameIndex;
+}
+
+- (void)updateFramePoolPlayHead {
+    BOOL bounce = self.playbackMode == SDAnimatedImagePlaybackModeBounce || self.playbackMode == SDAnimatedImagePlaybackModeReversedBounce;
+    BOOL reversed = self.playbackMode == SDAnimatedImagePlaybackModeReverse || (bounce && self.shouldReverse);
+    [self.framePool setPlayHeadIndex:self.currentFrameIndex reversed:reversed bounce:bounce];
+}
+
+// Real-time mode, the frames which timestamp already passed during buffer miss are skipped, then prefetch the frame which will be due when decoding finished
+- (void)skipLateFramesWithDuration:(NSTimeInterval)duration {
+    double playbackRate = self.playbackRate;
+    self.currentTime += duration;
+    NSUInteger frameIndex = self.currentFrameIndex;
+    BOOL shouldReverse = self.shouldReverse;
+    NSUInteger skippedCount = 0;
+    NSTimeInterval frameDuration = [self.animatedProvider animatedImageDurationAtIndex:frameIndex] / playbackRate;
+    while (frameDuration > 0 && self.currentTime >= frameDuration) {
+        self.currentTime -= frameDuration;
+        frameIndex = [self nextFrameIndexOfIndex:frameIndex shouldReverse:&shouldReverse];
+        skippedCount++;
+        if (frameIndex == 0) {
+            // Update the loop count
+            self.currentLoopCount++;
+            [self handleLoopChange];
+            
+            // if reached the max loop count, stop animating, 0 means loop indefinitely
+            NSUInteger maxLoopCount = self.totalLoopCount;
+            if (maxLoopCount != 0 && (self.currentLoopCount >= maxLoopCount)) {
+                [self stopPlaying];
+                return;
+            }
+        }
+        frameDuration = [self.animatedProvider animatedImageDurationAtIndex:frameIndex] / playbackRate;
+    }
+    if (skippedCount > 0) {
+        self.shouldReverse = shouldReverse;
+        self.currentFrameIndex = frameIndex;
+        self.skippedFrameCount += skippedCount;
+        self.consecutiveSkippedFrameCount += skippedCount;
+        [self updateFramePoolPlayHead];
+        [self reduceDecodeResolutionIfNeeded];
+    }
+    
+    // Prefetch along the skipping path, the frame which is due after the decode latency
+    NSTimeInterval aheadTime = self.currentTime + self.framePool.averageDecodeDuration;
+    NSUInteger fetchFrameIndex = frameIndex;
+    frameDuration = [self.animatedProvider animatedImageDurationAtIndex:fetchFrameIndex] / playbackRate;
+    for (NSUInteger i = 0; frameDuration > 0 && aheadTime >= frameDuration && i < self.totalFrameCount; i++) {
+        aheadTime -= frameDuration;
+        fetchFrameIndex = [self nextFrameIndexOfIndex:fetchFrameIndex shouldReverse:&shouldReverse];
+        frameDuration = [self.animatedProvider animatedImageDurationAtIndex:fetchFrameIndex] / playbackRate;
+    }
+    if (![self.framePool frameAtIndex:fetchFrameIndex]) {
+        // Calculate max buffer size
+        [self calculateMaxBufferCountWithFrame:self.currentFrame];
+        if (self.effectiveLookaheadFrameCount > 1) {
+            [self.framePool prefetchFramesFromIndex:fetchFrameIndex count:self.effectiveLookaheadFrameCount];
+        } else {
+            [self.framePool prefetchFrameAtIndex:fetchFrameIndex];
+        }
+    }
+}
+
+// Sustained buffer miss in real-time mode, lower the decode resolution to half
+- (void)reduceDecodeResolutionIfNeeded {
+    if (self.reducedDecodeResolution || self.consecutiveSkippedFrameCount < kSDAnimatedImagePlayerReduceResolutionSkippedCount) {
+        return;
+    }
+    CGImageRef cgImage = self.currentFrame.CGImage;
+    size_t width = CGImageGetWidth(cgImage);
+    size_t height = CGImageGetHeight(cgImage);
+    if (width <= 1 || height <= 1) {
+        return;
+    }
+    self.reducedDecodeResolution = YES;
+    // Use the frame pool for the reduced size, the players sharing the current frame pool keep their resolution
+    [self switchFramePoolWithThumbnailSize:CGSizeMake(width / 2, height / 2)];
 }
 
 // Check if we should prefetch next frame or current frame
@@ -295,6 +520,15 @@
     if (self.framePool.currentFrameCount == self.totalFrameCount) {
         bufferFull = YES;
     }
+    if (self.effectiveLookaheadFrameCount > 1) {
+        if (!bufferFull) {
+            // Calculate max buffer size
+            [self calculateMaxBufferCountWithFrame:self.currentFrame];
+            // Keep the next N frames decoding concurrently, frames already buffered or decoding are skipped
+            [self.framePool prefetchFramesFromIndex:fetchFrameIndex count:self.effectiveLookaheadFrameCount];
+        }
+        return;
+    }
     if (!fetchFrame && !bufferFull) {
         // Calculate max buffer size
         [self calculateMaxBufferCountWithFrame:self.currentFrame];
@@ -331,6 +565,9 @@
     NSUInteger max = 0;
     if (self.maxBufferSize > 0) {
         max = self.maxBufferSize;
+    } else if (self.budgetMemoryCost > 0) {
+        // Allocated by `SDAnimatedImageGovernor`
+        max = self.budgetMemoryCost;
     } else {
         // Calculate based on current memory, these factors are by experience
         NSUInteger total = [SDDeviceHelper totalMemory];
@@ -11,23 +11,31 @@
 #if SD_MAC
 
 #import "NSData+ImageContentType.h"
+#import "SDImageFrame.h"
 
 /**
  A subclass of `NSBitmapImageRep` to fix that GIF duration issue because `NSBitmapImageRep` will reset `NSImageCurrentFrameDuration` by using `kCGImagePropertyGIFDelayTime` but not `kCGImagePropertyGIFUnclampedDelayTime`.
  This also fix the GIF loop count issue, which will use the Netscape standard (See http://www6.uniovi.es/gifanim/gifabout.htm)  to only place once when the `kCGImagePropertyGIFLoopCount` is nil. This is what modern browser's behavior.
  Built in GIF coder use this instead of `NSBitmapImageRep` for better GIF rendering. If you do not want this, only enable `SDImageIOCoder`, which just call `NSImage` API and actually use `NSBitmapImageRep` for GIF image.
  This also support APNG format using `SDImageAPNGCoder`. Which provide full alpha-channel support and the correct duration match the `kCGImagePropertyAPNGUnclampedDelayTime`.
+ This also support frame-backed animation using `initWithFrames:`, which hold the frames directly without any encoding step. `SDImageCoderHelper` use this to create animated `NSImage` from frames.
  */
 @interface SDAnimatedImageRep : NSBitmapImageRep
 
 /// Current animated image format.
-/// @note This format is only valid when `animatedImageData` not nil
+/// @note This format is only valid when `animatedImageData` not nil. For frame-backed image rep, this is GIF.
 @property (nonatomic, assign, readonly) SDImageFormat animatedImageFormat;
 
 /// This allows to retrive the compressed data like GIF using `sd_imageData` on parent `NSImage`, without re-encoding (waste CPU and RAM)
 /// @note This is typically nonnull when you create with `initWithData:`, even it's marked as weak, because ImageIO retain it
+/// @note For frame-backed image rep, the frames are encoded to GIF on the first access, and the data is cached until `NSImageLoopCount` property changes.
 @property (nonatomic, readonly, nullable, weak) NSData *animatedImageData;
 
+/// Create a frame-backed animated image rep, which serve the frames for `NSImageView` animation directly, without encoding to GIF and decoding back. The first frame is used as the bitmap content.
+/// @param frames The animated frames, should contains at least one frame
+/// @note The loop count defaults to 1, the same as the GIF without loop count metadata. It can be changed by `NSImageLoopCount` property or `sd_imageLoopCount` on parent `NSImage`.
+- (nullable instancetype)initWithFrames:(nonnull NSArray<SDImageFrame *> *)frames;
+
 @end
 
 #endif
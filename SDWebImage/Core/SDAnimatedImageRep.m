@@ -24,13 +24,28 @@
 
 @implementation SDAnimatedImageRep {
     CGImageSourceRef _imageSource;
+    CFArrayRef _backingFrames; // Use CF type because super will copy all ivars without retain
+    CFDataRef _backingFramesData; // The GIF data encoded from backing frames, lazily
+    NSUInteger _currentFrameIndex;
+    NSUInteger _loopCount;
 }
 
+@synthesize frames = _frames;
+@synthesize animatedImageData = _animatedImageData;
+
 - (void)dealloc {
     if (_imageSource) {
         CFRelease(_imageSource);
         _imageSource = NULL;
     }
+    if (_backingFrames) {
+        CFRelease(_backingFrames);
+        _backingFrames = NULL;
+    }
+    if (_backingFramesData) {
+        CFRelease(_backingFramesData);
+        _backingFramesData = NULL;
+    }
 }
 
 - (instancetype)copyWithZone:(NSZone *)zone {
@@ -39,9 +54,110 @@
     if (imageRep->_imageSource) {
         CFRetain(imageRep->_imageSource);
     }
+    if (imageRep->_backingFrames) {
+        CFRetain(imageRep->_backingFrames);
+    }
+    if (imageRep->_backingFramesData) {
+        CFRetain(imageRep->_backingFramesData);
+    }
     return imageRep;
 }
 
+- (instancetype)initWithFrames:(NSArray<SDImageFrame *> *)frames {
+    NSImage *posterImage = frames.firstObject.image;
+    CGImageRef posterImageRef = posterImage.CGImage;
+    if (!posterImageRef) {
+        return nil;
+    }
+    self = [super initWithCGImage:posterImageRef];
+    if (self) {
+        _backingFrames = (__bridge_retained CFArrayRef)[frames copy];
+        _animatedImageFormat = SDImageFormatGIF;
+        // The same as the GIF without loop count metadata, which was used to represent the frames
+        _loopCount = 1;
+        self.size = posterImage.size;
+    }
+    return self;
+}
+
+#pragma mark - Frames
+
+- (NSArray<SDImageFrame *> *)frames {
+    if (_backingFrames) {
+        return (__bridge NSArray<SDImageFrame *> *)_backingFrames;
+    }
+    return _frames;
+}
+
+- (NSData *)animatedImageData {
+    if (_backingFrames) {
+        @synchronized (self) {
+            if (!_backingFramesData) {
+                // Encode only when someone actually ask for data, and only once
+                NSData *data = [SDImageGIFCoder.sharedCoder encodedDataWithFrames:self.frames loopCount:_loopCount format:SDImageFormatGIF options:nil];
+                _backingFramesData = (__bridge_retained CFDataRef)data;
+            }
+            return (__bridge NSData *)_backingFramesData;
+        }
+    }
+    return _animatedImageData;
+}
+
+- (SDImageFrame *)currentBackingFrame {
+    NSArray<SDImageFrame *> *frames = self.frames;
+    if (_currentFrameIndex >= frames.count) {
+        return frames.firstObject;
+    }
+    return frames[_currentFrameIndex];
+}
+
+- (CGImageRef)CGImage {
+    if (_backingFrames) {
+        return self.currentBackingFrame.image.CGImage;
+    }
+    return [super CGImage];
+}
+
+- (CGImageRef)CGImageForProposedRect:(NSRect *)proposedDestRect context:(NSGraphicsContext *)context hints:(NSDictionary<NSImageHintKey, id> *)hints {
+    if (_backingFrames) {
+        // NSImage draw and `CGImageForProposedRect:` use this, return the current frame instead of the poster bitmap
+        return self.currentBackingFrame.image.CGImage;
+    }
+    return [super CGImageForProposedRect:proposedDestRect context:context hints:hints];
+}
+
+- (BOOL)draw {
+    if (_backingFrames) {
+        NSRect rect = NSMakeRect(0, 0, self.size.width, self.size.height);
+        return [self drawInRect:rect fromRect:NSZeroRect operation:NSCompositingOperationSourceOver fraction:1 respectFlipped:NO hints:nil];
+    }
+    return [super draw];
+}
+
+- (BOOL)drawInRect:(NSRect)dstSpacePortionRect fromRect:(NSRect)srcSpacePortionRect operation:(NSCompositingOperation)op fraction:(CGFloat)requestedAlpha respectFlipped:(BOOL)respectContextIsFlipped hints:(NSDictionary<NSImageHintKey, id> *)hints {
+    if (_backingFrames) {
+        // Draw the current frame instead of the poster bitmap
+        [self.currentBackingFrame.image drawInRect:dstSpacePortionRect fromRect:srcSpacePortionRect operation:op fraction:requestedAlpha respectFlipped:respectContextIsFlipped hints:hints];
+        return YES;
+    }
+    return [super drawInRect:dstSpacePortionRect fromRect:srcSpacePortionRect operation:op fraction:requestedAlpha respectFlipped:respectContextIsFlipped hints:hints];
+}
+
+- (id)valueForProperty:(NSBitmapImageRepPropertyKey)property {
+    if (_backingFrames) {
+        if ([property isEqualToString:NSImageFrameCount]) {
+            return @(self.frames.count);
+        } else if ([property isEqualToString:NSImageCurrentFrame]) {
+            return @(_currentFrameIndex);
+        } else if ([property isEqualToString:NSImageCurrentFrameDuration]) {
+            return @(self.currentBackingFrame.duration);
+        } else if ([property isEqualToString:NSImageLoopCount]) {
+            return @(_loopCount);
+        }
+    }
+    return [super valueForProperty:property];
+}
+
 // `NSBitmapImageRep`'s `imageRepWithData:` is not designed initializer
 + (instancetype)imageRepWithData:(NSData *)data {
     SDAnimatedImageRep *imageRep = [[SDAnimatedImageRep alloc] initWithData:data];
@@ -110,6 +226,23 @@
 
 // `NSBitmapImageRep` will use `kCGImagePropertyGIFDelayTime` whenever you call `setProperty:withValue:` with `NSImageCurrentFrame` to change the current frame. We override it and use the actual `kCGImagePropertyGIFUnclampedDelayTime` if need.
 - (void)setProperty:(NSBitmapImageRepPropertyKey)property withValue:(id)value {
+    if (_backingFrames) {
+        // The frames are served directly, no need to update the bitmap
+        if ([property isEqualToString:NSImageCurrentFrame]) {
+            _currentFrameIndex = MIN([value unsignedIntegerValue], self.frames.count - 1);
+            return;
+        } else if ([property isEqualToString:NSImageLoopCount]) {
+            @synchronized (self) {
+                _loopCount = [value unsignedIntegerValue];
+                // The encoded data contains loop count
+                if (_backingFramesData) {
+                    CFRelease(_backingFramesData);
+                    _backingFramesData = NULL;
+                }
+            }
+            return;
+        }
+    }
     [super setProperty:property withValue:value];
     if ([property isEqualToString:NSImageCurrentFrame]) {
         // Access the image source
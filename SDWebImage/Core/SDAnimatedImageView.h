@@ -85,6 +85,13 @@ NS_SWIFT_UI_ACTOR
  `NSUIntegerMax` means cache all the buffer. (Lowest CPU and Highest Memory)
  */
 @property (nonatomic, assign) NSUInteger maxBufferSize;
+/**
+ Whether or not to decode the animated frames at the rendered pixel size, instead of the full image pixel size. If enable, the view tell the player its pixel size (bounds size multiply the screen scale, considering the `contentMode` on iOS/tvOS and `imageScaling` on macOS), and frames are decoded through the thumbnail path at that size when it's smaller than the image. The content modes which don't scale the image decode at full pixel size. The size is rounded up to a coarse bucket, so small bounds changes (such as during animation) don't rebuild the frame buffer. This can save the frame buffer memory and decode time for large animated image shown in small view.
+ The frame buffer is shared only between the views which render the same animated image at the same pixel size. See `SDAnimatedImagePlayer.thumbnailPixelSize`
+ @note The provider should implement `animatedImageFrameAtIndex:thumbnailSize:`, or the frames are still decoded at full pixel size.
+ Default is NO.
+ */
+@property (nonatomic, assign) BOOL decodeAtDisplaySize;
 /**
  Whehter or not to enable incremental image load for animated image. This is for the animated image which `sd_isIncremental` is YES (See `UIImage+Metadata.h`). If enable, animated image rendering will stop at the last frame available currently, and continue when another `setImage:` trigger, where the new animated image's `animatedImageData` should be updated from the previous one. If the `sd_isIncremental` is NO. The incremental image load stop.
  @note If you are confused about this description, open Chrome browser to view some large GIF images with low network speed to see the animation behavior.
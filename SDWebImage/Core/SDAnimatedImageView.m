@@ -12,6 +12,7 @@
 
 #import "UIImage+Metadata.h"
 #import "NSImage+Compatibility.h"
+#import "SDAnimatedImageGovernor.h"
 #import "SDInternalMacros.h"
 #import "objc/runtime.h"
 
@@ -77,6 +78,16 @@
     return [self.transformer transformedImageWithImage:frame forKey:@""];
 }
 
+- (UIImage *)animatedImageFrameAtIndex:(NSUInteger)index thumbnailSize:(CGSize)thumbnailSize {
+    UIImage *frame;
+    if ([self.provider respondsToSelector:@selector(animatedImageFrameAtIndex:thumbnailSize:)]) {
+        frame = [self.provider animatedImageFrameAtIndex:index thumbnailSize:thumbnailSize];
+    } else {
+        frame = [self.provider animatedImageFrameAtIndex:index];
+    }
+    return [self.transformer transformedImageWithImage:frame forKey:@""];
+}
+
 @end
 
 @interface UIImageView () <CALayerDelegate>
@@ -185,6 +196,9 @@
     
     if (!self.isProgressive) {
         // Stop animating
+        if (self.player) {
+            [SDAnimatedImageGovernor.sharedGovernor unregisterPlayer:self.player];
+        }
         self.player = nil;
         self.currentFrame = nil;
         self.currentFrameIndex = 0;
@@ -262,6 +276,8 @@
         super.highlighted = NO;
         
         [self stopAnimating];
+        [self updateThumbnailPixelSize];
+        [self updateAnimationBudget];
         [self checkPlay];
     }
     [self.imageViewLayer setNeedsDisplay];
@@ -325,6 +341,12 @@
 }
 
 
+- (void)setDecodeAtDisplaySize:(BOOL)decodeAtDisplaySize
+{
+    _decodeAtDisplaySize = decodeAtDisplaySize;
+    [self updateThumbnailPixelSize];
+}
+
 - (BOOL)shouldIncrementalLoad
 {
     if (!_initFinished) {
@@ -363,9 +385,27 @@
     [super didMoveToWindow];
 #endif
     
+    [self updateThumbnailPixelSize];
+    [self updateAnimationBudget];
     [self checkPlay];
 }
 
+#if SD_MAC
+- (void)layout
+#else
+- (void)layoutSubviews
+#endif
+{
+#if SD_MAC
+    [super layout];
+#else
+    [super layoutSubviews];
+#endif
+    
+    [self updateThumbnailPixelSize];
+    [self updateAnimationBudget];
+}
+
 #if SD_MAC
 - (void)setAlphaValue:(CGFloat)alphaValue
 #else
@@ -388,6 +428,22 @@
     [self checkPlay];
 }
 
+#if SD_MAC
+- (void)setImageScaling:(NSImageScaling)imageScaling
+{
+    [super setImageScaling:imageScaling];
+    
+    [self updateThumbnailPixelSize];
+}
+#else
+- (void)setContentMode:(UIViewContentMode)contentMode
+{
+    [super setContentMode:contentMode];
+    
+    [self updateThumbnailPixelSize];
+}
+#endif
+
 #pragma mark - UIImageView Method Overrides
 #pragma mark Image Data
 
@@ -511,6 +567,105 @@
     self.shouldAnimate = self.player && isVisible;
 }
 
+// Register the player to the global animation budget when on window, the budget is split by visible area
+- (void)updateAnimationBudget
+{
+    if (!self.player) {
+        return;
+    }
+    if (self.window) {
+        CGRect visibleRect = self.bounds;
+        if (CGRectIsEmpty(visibleRect)) {
+            // Not layout yet, use the image size
+            visibleRect = (CGRect){CGPointZero, self.image.size};
+        } else {
+            // Clip by the superviews which clip the content, and the window
+            for (UIView *view = self.superview; view; view = view.superview) {
+#if SD_MAC
+                BOOL clipsToBounds = view.layer.masksToBounds || view == self.window.contentView;
+#else
+                BOOL clipsToBounds = view.clipsToBounds || view == self.window;
+#endif
+                if (!clipsToBounds) {
+                    continue;
+                }
+                CGRect clipRect = [self convertRect:view.bounds fromView:view];
+                visibleRect = CGRectIntersection(visibleRect, clipRect);
+                if (CGRectIsNull(visibleRect)) {
+                    visibleRect = CGRectZero;
+                    break;
+                }
+            }
+        }
+        [SDAnimatedImageGovernor.sharedGovernor registerPlayer:self.player visibleArea:visibleRect.size.width * visibleRect.size.height];
+    } else {
+        [SDAnimatedImageGovernor.sharedGovernor unregisterPlayer:self.player];
+    }
+}
+
+// Tell the player the rendered pixel size, frames are decoded at that size when it's smaller than the image
+- (void)updateThumbnailPixelSize
+{
+    if (!self.player) {
+        return;
+    }
+    if (!self.decodeAtDisplaySize) {
+        self.player.thumbnailPixelSize = CGSizeZero;
+        return;
+    }
+    CGSize boundsSize = self.bounds.size;
+    CGSize imageSize = self.image.size;
+    if (!self.window || boundsSize.width <= 0 || boundsSize.height <= 0 || imageSize.width <= 0 || imageSize.height <= 0) {
+        // Not layout yet, keep the current size
+        return;
+    }
+    // The thumbnail decode keep the aspect ratio, so fit modes use the smaller axis ratio, and the modes which cover the bounds or stretch each axis use the larger one. The modes which don't scale draw at the natural size
+    BOOL scaled = YES;
+    BOOL cover = NO;
+#if SD_MAC
+    CGFloat screenScale = self.window.backingScaleFactor;
+    switch (self.imageScaling) {
+        case NSImageScaleProportionallyDown:
+        case NSImageScaleProportionallyUpOrDown:
+            break;
+        case NSImageScaleAxesIndependently:
+            cover = YES;
+            break;
+        default:
+            scaled = NO;
+            break;
+    }
+#else
+    CGFloat screenScale = self.window.screen.scale;
+    switch (self.contentMode) {
+        case UIViewContentModeScaleAspectFit:
+            break;
+        case UIViewContentModeScaleAspectFill:
+        case UIViewContentModeScaleToFill:
+        case UIViewContentModeRedraw:
+            cover = YES;
+            break;
+        default:
+            scaled = NO;
+            break;
+    }
+#endif
+    CGSize pixelSize = CGSizeZero;
+    if (scaled) {
+        CGFloat imageScale = self.image.scale;
+        CGSize imagePixelSize = CGSizeMake(imageSize.width * imageScale, imageSize.height * imageScale);
+        CGFloat widthRatio = boundsSize.width * screenScale / imagePixelSize.width;
+        CGFloat heightRatio = boundsSize.height * screenScale / imagePixelSize.height;
+        CGFloat ratio = cover ? MAX(widthRatio, heightRatio) : MIN(widthRatio, heightRatio);
+        // Round up the ratio to the quarter power of 2, so the frame pool is switched only when the size bucket changes, not on each bounds change during animation
+        ratio = pow(2, ceil(log2(ratio) * 4) / 4);
+        if (ratio < 1) {
+            pixelSize = CGSizeMake(ceil(imagePixelSize.width * ratio), ceil(imagePixelSize.height * ratio));
+        }
+    }
+    self.player.thumbnailPixelSize = pixelSize;
+}
+
 // Update progressive status only after `setImage:` call.
 - (void)updateIsProgressiveWithImage:(UIImage *)image
 {
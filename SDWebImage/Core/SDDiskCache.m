@@ -9,14 +9,18 @@
 #import "SDDiskCache.h"
 #import "SDImageCacheConfig.h"
 #import "SDFileAttributeHelper.h"
+#import "SDDiskCacheIndex.h"
 #import <CommonCrypto/CommonDigest.h>
 
 static NSString * const SDDiskCacheExtendedAttributeName = @"com.hackemist.SDDiskCache";
+// The incremental eviction remove files until the total size fall below this ratio of `maxDiskSize`
+static const double kSDDiskCacheEvictionLowWaterRatio = 0.9;
 
 @interface SDDiskCache ()
 
 @property (nonatomic, copy) NSString *diskCachePath;
 @property (nonatomic, strong, nonnull) NSFileManager *fileManager;
+@property (nonatomic, strong, nullable) SDDiskCacheIndex *index;
 
 @end
 
@@ -45,11 +49,20 @@ static NSString * const SDDiskCacheExtendedAttributeName = @"com.hackemist.SDDis
     }
   
     [self createDirectory];
+    
+    if (self.config.shouldUseDiskCacheIndex) {
+        self.index = [[SDDiskCacheIndex alloc] initWithDirectory:self.diskCachePath fileManager:self.fileManager];
+        self.index.orderByAccessDate = self.config.diskCacheExpireType == SDImageCacheConfigExpireTypeAccessDate;
+    }
 }
 
 - (BOOL)containsDataForKey:(NSString *)key {
     NSParameterAssert(key);
     NSString *filePath = [self cachePathForKey:key];
+    if (self.index) {
+        // Query from index, no filesystem syscall
+        return [self.index entryForFileName:filePath.lastPathComponent] || [self.index entryForFileName:filePath.stringByDeletingPathExtension.lastPathComponent];
+    }
     BOOL exists = [self.fileManager fileExistsAtPath:filePath];
     
     // fallback because of https://github.com/rs/SDWebImage/pull/976 that added the extension to the disk file name
@@ -69,7 +82,10 @@ static NSString * const SDDiskCacheExtendedAttributeName = @"com.hackemist.SDDis
     if (filePath == nil || [@"(null)" isEqualToString: filePath]) {
         return nil;
     }
-    NSData *data = [NSData dataWithContentsOfFile:filePath options:self.config.diskCacheReadingOptions error:nil];
+    if (self.index) {
+        return [self indexedDataForFilePath:filePath];
+    }
+    NSData *data = [self readDataAtPath:filePath];
     if (data) {
         [[NSURL fileURLWithPath:filePath] setResourceValue:[NSDate date] forKey:NSURLContentAccessDateKey error:nil];
         return data;
@@ -78,7 +94,7 @@ static NSString * const SDDiskCacheExtendedAttributeName = @"com.hackemist.SDDis
     // fallback because of https://github.com/rs/SDWebImage/pull/976 that added the extension to the disk file name
     // checking the key with and without the extension
     filePath = filePath.stringByDeletingPathExtension;
-    data = [NSData dataWithContentsOfFile:filePath options:self.config.diskCacheReadingOptions error:nil];
+    data = [self readDataAtPath:filePath];
     if (data) {
         [[NSURL fileURLWithPath:filePath] setResourceValue:[NSDate date] forKey:NSURLContentAccessDateKey error:nil];
         return data;
@@ -87,6 +103,41 @@ static NSString * const SDDiskCacheExtendedAttributeName = @"com.hackemist.SDDis
     return nil;
 }
 
+- (nullable NSData *)indexedDataForFilePath:(nonnull NSString *)filePath {
+    NSString *fileName = filePath.lastPathComponent;
+    if (![self.index entryForFileName:fileName]) {
+        // fallback because of https://github.com/rs/SDWebImage/pull/976 that added the extension to the disk file name
+        filePath = filePath.stringByDeletingPathExtension;
+        fileName = filePath.lastPathComponent;
+        if (![self.index entryForFileName:fileName]) {
+            // Miss without any syscall
+            return nil;
+        }
+    }
+    NSData *data = [self readDataAtPath:filePath];
+    if (data) {
+        // Record the access date in index instead of file attribute
+        [self.index touchEntryForFileName:fileName];
+    } else {
+        // The file is removed outside, sync the index
+        [self.index removeEntryForFileName:fileName];
+    }
+    return data;
+}
+
+- (nullable NSData *)readDataAtPath:(nonnull NSString *)filePath {
+    if (!self.config.shouldMapDiskCacheData) {
+        return [NSData dataWithContentsOfFile:filePath options:self.config.diskCacheReadingOptions error:nil];
+    }
+    // Zero-copy, the mapping is released with the data
+    NSData *data = [NSData dataWithContentsOfFile:filePath options:self.config.diskCacheReadingOptions | NSDataReadingMappedAlways error:nil];
+    if (!data) {
+        // Mapping may fail for empty file
+        data = [NSData dataWithContentsOfFile:filePath options:self.config.diskCacheReadingOptions & ~NSDataReadingMappedAlways error:nil];
+    }
+    return data;
+}
+
 - (void)setData:(NSData *)data forKey:(NSString *)key {
     NSParameterAssert(data);
     NSParameterAssert(key);
@@ -96,7 +147,21 @@ static NSString * const SDDiskCacheExtendedAttributeName = @"com.hackemist.SDDis
     // transform to NSURL
     NSURL *fileURL = [NSURL fileURLWithPath:cachePathForKey isDirectory:NO];
     
-    [data writeToURL:fileURL options:self.config.diskCacheWritingOptions error:nil];
+    NSDataWritingOptions writingOptions = self.config.diskCacheWritingOptions;
+    if (self.config.shouldMapDiskCacheData) {
+        // The file may be mapped by previous reading, replace it instead of truncate in place
+        writingOptions |= NSDataWritingAtomic;
+    }
+    [self.index beginEntryForFileName:fileURL.lastPathComponent];
+    BOOL success = [data writeToURL:fileURL options:writingOptions error:nil];
+    if (success) {
+        [self.index setEntryForFileName:fileURL.lastPathComponent size:data.length];
+        // Keep the cache continuously under the size limit
+        NSUInteger maxDiskSize = self.config.maxDiskSize;
+        if ([self shouldUseIncrementalEviction] && maxDiskSize > 0 && self.index.totalSize > maxDiskSize) {
+            [self removeOldestDataWithIndexIncrementally];
+        }
+    }
 }
 
 - (NSData *)extendedDataForKey:(NSString *)key {
@@ -128,11 +193,13 @@ static NSString * const SDDiskCacheExtendedAttributeName = @"com.hackemist.SDDis
     NSParameterAssert(key);
     NSString *filePath = [self cachePathForKey:key];
     [self.fileManager removeItemAtPath:filePath error:nil];
+    [self.index removeEntryForFileName:filePath.lastPathComponent];
 }
 
 - (void)removeAllData {
     [self.fileManager removeItemAtPath:self.diskCachePath error:nil];
     [self createDirectory];
+    [self.index removeAllEntries];
 }
 
 - (void)createDirectory {
@@ -149,6 +216,14 @@ static NSString * const SDDiskCacheExtendedAttributeName = @"com.hackemist.SDDis
 }
 
 - (void)removeExpiredData {
+    if ([self shouldUseIncrementalEviction]) {
+        [self removeOldestDataWithIndexIncrementally];
+        return;
+    }
+    if (self.index) {
+        [self removeExpiredDataWithIndex];
+        return;
+    }
     NSURL *diskCacheURL = [NSURL fileURLWithPath:self.diskCachePath isDirectory:YES];
     
     // Compute content date key to be used for tests
@@ -242,12 +317,91 @@ static NSString * const SDDiskCacheExtendedAttributeName = @"com.hackemist.SDDis
     }
 }
 
+- (void)removeExpiredDataWithIndex {
+    BOOL useAccessDate = self.config.diskCacheExpireType == SDImageCacheConfigExpireTypeAccessDate;
+    BOOL shouldExpire = self.config.maxDiskAge >= 0;
+    NSTimeInterval expirationDate = [NSDate date].timeIntervalSince1970 - self.config.maxDiskAge;
+    NSMutableArray<SDDiskCacheIndexEntry *> *remainEntries = [NSMutableArray array];
+    NSUInteger currentCacheSize = 0;
+    
+    // Same as the directory enumeration, but using the index entries in memory
+    for (SDDiskCacheIndexEntry *entry in [self.index allEntries]) {
+        NSTimeInterval date = useAccessDate ? entry.accessDate : entry.writeDate;
+        if (shouldExpire && date <= expirationDate) {
+            [self removeFileWithIndexEntry:entry];
+            continue;
+        }
+        currentCacheSize += entry.size;
+        [remainEntries addObject:entry];
+    }
+    
+    NSUInteger maxDiskSize = self.config.maxDiskSize;
+    if (maxDiskSize > 0 && currentCacheSize > maxDiskSize) {
+        // Target half of our maximum cache size for this cleanup pass.
+        const NSUInteger desiredCacheSize = maxDiskSize / 2;
+        
+        // Sort the remaining cache entries by date (oldest first).
+        [remainEntries sortUsingComparator:^NSComparisonResult(SDDiskCacheIndexEntry *entry1, SDDiskCacheIndexEntry *entry2) {
+            NSTimeInterval date1 = useAccessDate ? entry1.accessDate : entry1.writeDate;
+            NSTimeInterval date2 = useAccessDate ? entry2.accessDate : entry2.writeDate;
+            return date1 < date2 ? NSOrderedAscending : (date1 > date2 ? NSOrderedDescending : NSOrderedSame);
+        }];
+        
+        // Delete files until we fall below our desired cache size.
+        for (SDDiskCacheIndexEntry *entry in remainEntries) {
+            [self removeFileWithIndexEntry:entry];
+            currentCacheSize -= entry.size;
+            if (currentCacheSize < desiredCacheSize) {
+                break;
+            }
+        }
+    }
+    [self.index synchronize];
+}
+
+- (BOOL)shouldUseIncrementalEviction {
+    return self.index && self.config.maxDiskEvictionCount > 0;
+}
+
+// Walk from the oldest entry, remove the expired files, and the oldest files when exceed size limit, at most `maxDiskEvictionCount` files
+- (void)removeOldestDataWithIndexIncrementally {
+    BOOL useAccessDate = self.config.diskCacheExpireType == SDImageCacheConfigExpireTypeAccessDate;
+    BOOL shouldExpire = self.config.maxDiskAge >= 0;
+    NSTimeInterval expirationDate = [NSDate date].timeIntervalSince1970 - self.config.maxDiskAge;
+    NSUInteger maxDiskSize = self.config.maxDiskSize;
+    NSUInteger desiredCacheSize = (NSUInteger)(maxDiskSize * kSDDiskCacheEvictionLowWaterRatio);
+    NSUInteger currentCacheSize = self.index.totalSize;
+    
+    NSArray<SDDiskCacheIndexEntry *> *oldestEntries = [self.index oldestEntriesWithLimit:self.config.maxDiskEvictionCount];
+    for (SDDiskCacheIndexEntry *entry in oldestEntries) {
+        NSTimeInterval date = useAccessDate ? entry.accessDate : entry.writeDate;
+        BOOL isExpired = shouldExpire && date <= expirationDate;
+        BOOL isOversized = maxDiskSize > 0 && currentCacheSize > desiredCacheSize;
+        if (!isExpired && !isOversized) {
+            // The entries are ordered, the rest are newer
+            break;
+        }
+        [self removeFileWithIndexEntry:entry];
+        currentCacheSize -= entry.size;
+    }
+    [self.index synchronize];
+}
+
+- (void)removeFileWithIndexEntry:(SDDiskCacheIndexEntry *)entry {
+    NSString *filePath = [self.diskCachePath stringByAppendingPathComponent:entry.fileName];
+    [self.fileManager removeItemAtPath:filePath error:nil];
+    [self.index removeEntryForFileName:entry.fileName];
+}
+
 - (nullable NSString *)cachePathForKey:(NSString *)key {
     NSParameterAssert(key);
     return [self cachePathForKey:key inPath:self.diskCachePath];
 }
 
 - (NSUInteger)totalSize {
+    if (self.index) {
+        return self.index.totalSize;
+    }
     NSUInteger size = 0;
 
     // Use URL-based enumerator instead of Path(NSString *)-based enumerator to reduce
@@ -274,6 +428,9 @@ static NSString * const SDDiskCacheExtendedAttributeName = @"com.hackemist.SDDis
 }
 
 - (NSUInteger)totalCount {
+    if (self.index) {
+        return self.index.totalCount;
+    }
     NSUInteger count = 0;
     @autoreleasepool {
         NSURL *diskCacheURL = [NSURL fileURLWithPath:self.diskCachePath isDirectory:YES];
@@ -338,6 +495,10 @@ static NSString * const SDDiskCacheExtendedAttributeName = @"com.hackemist.SDDis
         // Remove the old path
         [self.fileManager removeItemAtURL:srcURL error:nil];
     }
+    if ([dstPath isEqualToString:self.diskCachePath]) {
+        // The files are moved outside of index, rebuild it
+        [self.index rebuild];
+    }
 }
 
 #pragma mark - Hash
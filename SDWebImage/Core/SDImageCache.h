@@ -354,6 +354,21 @@ typedef NS_OPTIONS(NSUInteger, SDImageCacheOptions) {
  */
 - (nullable SDImageCacheToken *)queryCacheOperationForKey:(nullable NSString *)key options:(SDImageCacheOptions)options context:(nullable SDWebImageContext *)context cacheType:(SDImageCacheType)queryCacheType done:(nullable SDImageCacheQueryCompletionBlock)doneBlock;
 
+/**
+ * Asynchronously queries the cache for multiple keys at once, for list or grid prefetching.
+ * All the memory cache hits are answered synchronously. The remaining keys are read from disk in one ioQueue pass in the order of keys, and the results are streamed back one by one as soon as each key is decoded.
+ * Whether the disk query for each key is synchronous follows the same rule as the single key query: `SDImageCacheQueryMemoryDataSync` for memory cache hit, `SDImageCacheQueryDiskDataSync` for memory cache miss.
+ *
+ * @param keys      The unique keys used to store the wanted images.
+ * @param options   A mask to specify options to use for this cache query
+ * @param context   A context contains different options to perform specify changes or processes, see `SDWebImageContextOption`. This hold the extra objects which `options` enum can not hold.
+ * @param queryCacheType Specify where to query the cache from. By default we use `.all`, which means both memory cache and disk cache. You can choose to query memory only or disk only as well. Pass `.none` is invalid and callback with nil immediately.
+ * @param doneBlock The completion block, called once for each key (the order is not guaranteed). The cache type is the same as `queryCacheOperationForKey:options:context:cacheType:done:` report for that key, check the image or data for miss. Will not get called for the remaining keys if the operation is cancelled
+ *
+ * @return a SDImageCacheToken instance to cancel the remaining queries, or nil if all keys are answered synchronously. Cancel it does not callback
+ */
+- (nullable SDImageCacheToken *)queryCacheOperationForKeys:(nonnull NSArray<NSString *> *)keys options:(SDImageCacheOptions)options context:(nullable SDWebImageContext *)context cacheType:(SDImageCacheType)queryCacheType done:(nullable SDImageCacheBatchQueryCompletionBlock)doneBlock;
+
 /**
  * Synchronously query the memory cache.
  *
@@ -398,6 +413,17 @@ typedef NS_OPTIONS(NSUInteger, SDImageCacheOptions) {
  */
 - (nullable UIImage *)imageFromCacheForKey:(nullable NSString *)key options:(SDImageCacheOptions)options context:(nullable SDWebImageContext *)context;
 
+/**
+ * Synchronously query the region of image (like a tile of huge image) from the cache. The decoded region image is stored into memory cache with the key from `SDRegionedKeyForKey`, so query the same tile again only hit the memory cache. When the image for the key is stored or removed from disk, the region images decoded from the previous data are no longer returned (the memory cache key then contains a generation suffix).
+ * The recent queried image data is kept, so the tiles of the same image share the same subsampled level image. See `SDRegionImageCoder`.
+ *
+ * @param key The unique key used to store the image
+ * @param region The source rect in pixels of the image, before applying the EXIF orientation
+ * @param pixelSize The target pixel size of the tile. Pass `CGSizeZero` to use the region size.
+ * @return The region image for the given key, or nil if not found.
+ */
+- (nullable UIImage *)imageFromCacheForKey:(nullable NSString *)key region:(CGRect)region pixelSize:(CGSize)pixelSize;
+
 #pragma mark - Remove Ops
 
 /**
@@ -467,6 +493,18 @@ typedef NS_OPTIONS(NSUInteger, SDImageCacheOptions) {
  */
 - (void)calculateSizeWithCompletionBlock:(nullable SDImageCacheCalculateSizeBlock)completionBlock;
 
+/**
+ * The number of asynchronous disk cache queries which are waiting for, or performing the disk data read in ioQueue.
+ * This can be used to monitor the IO stage queue depth of disk cache query.
+ */
+@property (nonatomic, assign, readonly) NSUInteger pendingDiskReadCount;
+
+/**
+ * The number of asynchronous disk cache queries which are waiting for, or performing the image decoding in decode queue.
+ * This can be used to monitor the decode stage queue depth of disk cache query. The decode concurrency is limited by `SDImageCacheConfig.maxConcurrentDecodeCount`.
+ */
+@property (nonatomic, assign, readonly) NSUInteger pendingDecodeCount;
+
 @end
 
 /**
@@ -16,7 +16,9 @@
 #import "UIImage+Metadata.h"
 #import "UIImage+ExtendedCacheData.h"
 #import "SDCallbackQueue.h"
+#import "SDImageSourceCache.h"
 #import "SDImageTransformer.h" // TODO, remove this
+#import <stdatomic.h>
 
 // TODO, remove this
 static BOOL SDIsThumbnailKey(NSString *key) {
@@ -66,7 +68,13 @@ static BOOL SDIsThumbnailKey(NSString *key) {
 
 static NSString * _defaultDiskCacheDirectory;
 
-@interface SDImageCache ()
+// Prune the recorded image source keys which are evicted from `SDImageSourceCache` when reaching this count
+static const NSUInteger kSDImageCacheImageSourceKeysPruneCount = 1024;
+
+@interface SDImageCache () {
+    atomic_ulong _pendingDiskReadCount;
+    atomic_ulong _pendingDecodeCount;
+}
 
 #pragma mark - Properties
 @property (nonatomic, strong, readwrite, nonnull) id<SDMemoryCache> memoryCache;
@@ -74,6 +82,13 @@ static NSString * _defaultDiskCacheDirectory;
 @property (nonatomic, copy, readwrite, nonnull) SDImageCacheConfig *config;
 @property (nonatomic, copy, readwrite, nonnull) NSString *diskCachePath;
 @property (nonatomic, strong, nonnull) dispatch_queue_t ioQueue;
+@property (nonatomic, strong, nonnull) NSOperationQueue *decodeQueue;
+@property (nonatomic, strong, nonnull) NSCache<NSString *, NSData *> *regionImageDataCache;
+// The generation of the region images for the key, bumped when the image data of the key is changed, so the region images decoded from the previous data are never hit
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSString *, NSNumber *> *regionImageGenerations;
+@property (nonatomic, assign) NSUInteger lastRegionImageGeneration;
+// The keys this cache decoded with the shared `SDImageSourceCache`, so clearing this cache does not remove the image sources of other caches
+@property (nonatomic, strong, nonnull) NSMutableSet<NSString *> *imageSourceKeys;
 
 @end
 
@@ -131,6 +146,23 @@ static NSString * _defaultDiskCacheDirectory;
         _ioQueue = dispatch_queue_create("com.hackemist.SDImageCache.ioQueue", ioQueueAttributes);
         NSAssert(_ioQueue, @"The IO queue should not be nil. Your configured `ioQueueAttributes` may be wrong");
         
+        // Create decode queue
+        _decodeQueue = [NSOperationQueue new];
+        _decodeQueue.name = @"com.hackemist.SDImageCache.decodeQueue";
+        NSUInteger maxConcurrentDecodeCount = _config.maxConcurrentDecodeCount;
+        if (maxConcurrentDecodeCount == 0) {
+            maxConcurrentDecodeCount = NSProcessInfo.processInfo.activeProcessorCount;
+        }
+        _decodeQueue.maxConcurrentOperationCount = maxConcurrentDecodeCount;
+        atomic_init(&_pendingDiskReadCount, 0);
+        atomic_init(&_pendingDecodeCount, 0);
+        
+        // Keep the recent image data for region query, the coder reuse the subsampled level image for the same data
+        _regionImageDataCache = [NSCache new];
+        _regionImageDataCache.countLimit = 4;
+        _regionImageGenerations = [NSMutableDictionary dictionary];
+        _imageSourceKeys = [NSMutableSet set];
+        
         // Init the memory cache
         NSAssert([config.memoryCacheClass conformsToProtocol:@protocol(SDMemoryCache)], @"Custom memory cache class must conform to `SDMemoryCache` protocol");
         _memoryCache = [[config.memoryCacheClass alloc] initWithConfig:_config];
@@ -360,6 +392,8 @@ static NSString * _defaultDiskCacheDirectory;
     }
     
     [self.diskCache setData:imageData forKey:key];
+    // The cached data, image source and region images belong to the previous data
+    [self invalidateRegionImagesForKey:key];
 }
 
 #pragma mark - Query and Retrieve Ops
@@ -485,6 +519,36 @@ static NSString * _defaultDiskCacheDirectory;
     return image;
 }
 
+- (nullable UIImage *)imageFromCacheForKey:(nullable NSString *)key region:(CGRect)region pixelSize:(CGSize)pixelSize {
+    if (!key) {
+        return nil;
+    }
+    NSString *regionKey = [self regionedKeyForKey:key region:region pixelSize:pixelSize];
+    UIImage *image = [self imageFromMemoryCacheForKey:regionKey];
+    if (image) {
+        return image;
+    }
+    
+    NSData *data = [self.regionImageDataCache objectForKey:key];
+    if (!data) {
+        data = [self diskImageDataForKey:key];
+        if (!data) {
+            return nil;
+        }
+        [self.regionImageDataCache setObject:data forKey:key];
+    }
+    [self recordImageSourceKey:key];
+    SDImageCoderOptions *options = @{SDImageCoderDecodeScaleFactor : @(SDImageScaleFactorForKey(key)),
+                                     SDImageCoderDecodeImageSourceCacheKey : key};
+    image = [[SDImageCodersManager sharedManager] decodedImageWithData:data region:region pixelSize:pixelSize options:options];
+    if (image && self.config.shouldCacheImagesInMemory) {
+        NSUInteger cost = image.sd_memoryCost;
+        [self.memoryCache setObject:image forKey:regionKey cost:cost];
+    }
+    
+    return image;
+}
+
 - (nullable NSData *)diskImageDataBySearchingAllPathsForKey:(nullable NSString *)key {
     if (!key) {
         return nil;
@@ -499,7 +563,11 @@ static NSString * _defaultDiskCacheDirectory;
     if (self.additionalCachePathBlock) {
         NSString *filePath = self.additionalCachePathBlock(key);
         if (filePath) {
-            data = [NSData dataWithContentsOfFile:filePath options:self.config.diskCacheReadingOptions error:nil];
+            NSDataReadingOptions readingOptions = self.config.diskCacheReadingOptions;
+            if (self.config.shouldMapDiskCacheData) {
+                readingOptions |= NSDataReadingMappedAlways;
+            }
+            data = [NSData dataWithContentsOfFile:filePath options:readingOptions error:nil];
         }
     }
 
@@ -518,8 +586,23 @@ static NSString * _defaultDiskCacheDirectory;
     if (!data) {
         return nil;
     }
+    __block NSData *extendedData;
+    if (key) {
+        dispatch_sync(self.ioQueue, ^{
+            extendedData = [self.diskCache extendedDataForKey:key];
+        });
+    }
+    return [self diskImageForKey:key data:data extendedData:extendedData options:options context:context];
+}
+
+// Decode the disk data, the extended data should be read on ioQueue by caller, so this does not touch the disk cache and can be called on any queue
+- (nullable UIImage *)diskImageForKey:(nullable NSString *)key data:(nullable NSData *)data extendedData:(nullable NSData *)extendedData options:(SDImageCacheOptions)options context:(SDWebImageContext *)context {
+    if (!data) {
+        return nil;
+    }
+    [self recordImageSourceKey:key];
     UIImage *image = SDImageCacheDecodeImageData(data, key, [[self class] imageOptionsFromCacheOptions:options], context);
-    [self _unarchiveObjectWithImage:image forKey:key];
+    [self _unarchiveObjectWithImage:image extendedData:extendedData];
     return image;
 }
 
@@ -559,12 +642,11 @@ static NSString * _defaultDiskCacheDirectory;
     [self.memoryCache setObject:diskImage forKey:key cost:cost];
 }
 
-- (void)_unarchiveObjectWithImage:(UIImage *)image forKey:(NSString *)key {
-    if (!image || !key) {
+- (void)_unarchiveObjectWithImage:(UIImage *)image extendedData:(NSData *)extendedData {
+    if (!image) {
         return;
     }
     // Check extended data
-    NSData *extendedData = [self.diskCache extendedDataForKey:key];
     if (!extendedData) {
         return;
     }
@@ -621,29 +703,9 @@ static NSString * _defaultDiskCacheDirectory;
     UIImage *image;
     BOOL shouldQueryDiskOnly = (queryCacheType == SDImageCacheTypeDisk);
     if (!shouldQueryDiskOnly) {
-        image = [self imageFromMemoryCacheForKey:key];
+        image = [self queryMemoryImageForKey:key options:options context:context];
     }
     
-    if (image) {
-        if (options & SDImageCacheDecodeFirstFrameOnly) {
-            // Ensure static image
-            if (image.sd_imageFrameCount > 1) {
-#if SD_MAC
-                image = [[NSImage alloc] initWithCGImage:image.CGImage scale:image.scale orientation:kCGImagePropertyOrientationUp];
-#else
-                image = [[UIImage alloc] initWithCGImage:image.CGImage scale:image.scale orientation:image.imageOrientation];
-#endif
-            }
-        } else if (options & SDImageCacheMatchAnimatedImageClass) {
-            // Check image class matching
-            Class animatedImageClass = image.class;
-            Class desiredImageClass = context[SDWebImageContextAnimatedImageClass];
-            if (desiredImageClass && ![animatedImageClass isSubclassOfClass:desiredImageClass]) {
-                image = nil;
-            }
-        }
-    }
-
     BOOL shouldQueryMemoryOnly = (queryCacheType == SDImageCacheTypeMemory) || (image && !(options & SDImageCacheQueryMemoryData));
     if (shouldQueryMemoryOnly) {
         if (doneBlock) {
@@ -672,7 +734,15 @@ static NSString * _defaultDiskCacheDirectory;
         return [self diskImageDataBySearchingAllPathsForKey:key];
     };
     
-    UIImage* (^queryDiskImageBlock)(NSData*) = ^UIImage*(NSData* diskData) {
+    // Read the extended data together with disk data in ioQueue, only needed when decoding
+    NSData* (^queryDiskExtendedDataBlock)(NSData*) = ^NSData*(NSData* diskData) {
+        if (image || !diskData) {
+            return nil;
+        }
+        return [self.diskCache extendedDataForKey:key];
+    };
+    
+    UIImage* (^queryDiskImageBlock)(NSData*, NSData*) = ^UIImage*(NSData* diskData, NSData* extendedData) {
         @synchronized (operation) {
             if (operation.isCancelled) {
                 return nil;
@@ -685,46 +755,25 @@ static NSString * _defaultDiskCacheDirectory;
             diskImage = image;
         } else if (diskData) {
             // the image memory cache miss, need image data and image
-            BOOL shouldCacheToMemory = YES;
-            if (context[SDWebImageContextStoreCacheType]) {
-                SDImageCacheType cacheType = [context[SDWebImageContextStoreCacheType] integerValue];
-                shouldCacheToMemory = (cacheType == SDImageCacheTypeAll || cacheType == SDImageCacheTypeMemory);
-            }
-            // Special case: If user query image in list for the same URL, to avoid decode and write **same** image object into disk cache multiple times, we query and check memory cache here again. See: #3523
-            // This because disk operation can be async, previous sync check of `memory cache miss`, does not gurantee current check of `memory cache miss`
-            if (!shouldQueryDiskSync) {
-                // First check the in-memory cache...
-                if (!shouldQueryDiskOnly) {
-                    diskImage = [self imageFromMemoryCacheForKey:key];
-                }
-            }
-            // decode image data only if in-memory cache missed
-            if (!diskImage) {
-                diskImage = [self diskImageForKey:key data:diskData options:options context:context];
-                // check if we need sync logic
-                if (shouldCacheToMemory) {
-                    [self _syncDiskToMemoryWithImage:diskImage forKey:key];
-                }
-            }
+            diskImage = [self queryDiskImageForKey:key data:diskData extendedData:extendedData options:options context:context shouldCheckMemory:(!shouldQueryDiskSync && !shouldQueryDiskOnly)];
         }
         return diskImage;
     };
     
-    // Query in ioQueue to keep IO-safe
+    // Query in ioQueue to keep IO-safe, decode outside of ioQueue to not block other disk read/write
     if (shouldQueryDiskSync) {
         __block NSData* diskData;
-        __block UIImage* diskImage;
+        __block NSData* extendedData;
         dispatch_sync(self.ioQueue, ^{
             diskData = queryDiskDataBlock();
-            diskImage = queryDiskImageBlock(diskData);
+            extendedData = queryDiskExtendedDataBlock(diskData);
         });
+        UIImage* diskImage = queryDiskImageBlock(diskData, extendedData);
         if (doneBlock) {
             doneBlock(diskImage, diskData, SDImageCacheTypeDisk);
         }
     } else {
-        dispatch_async(self.ioQueue, ^{
-            NSData* diskData = queryDiskDataBlock();
-            UIImage* diskImage = queryDiskImageBlock(diskData);
+        void(^completionBlock)(UIImage *, NSData *) = ^(UIImage *diskImage, NSData *diskData) {
             @synchronized (operation) {
                 if (operation.isCancelled) {
                     return;
@@ -742,12 +791,226 @@ static NSString * _defaultDiskCacheDirectory;
                     doneBlock(diskImage, diskData, SDImageCacheTypeDisk);
                 }];
             }
+        };
+        atomic_fetch_add_explicit(&_pendingDiskReadCount, 1, memory_order_relaxed);
+        dispatch_async(self.ioQueue, ^{
+            NSData* diskData = queryDiskDataBlock();
+            NSData* extendedData = queryDiskExtendedDataBlock(diskData);
+            atomic_fetch_sub_explicit(&self->_pendingDiskReadCount, 1, memory_order_relaxed);
+            if (image || !diskData) {
+                // No need to decode, callback directly
+                completionBlock(image, diskData);
+                return;
+            }
+            @synchronized (operation) {
+                if (operation.isCancelled) {
+                    return;
+                }
+            }
+            // Decode in concurrent decode queue, so the serial ioQueue can process next disk read
+            atomic_fetch_add_explicit(&self->_pendingDecodeCount, 1, memory_order_relaxed);
+            [self.decodeQueue addOperationWithBlock:^{
+                UIImage* diskImage = queryDiskImageBlock(diskData, extendedData);
+                atomic_fetch_sub_explicit(&self->_pendingDecodeCount, 1, memory_order_relaxed);
+                completionBlock(diskImage, diskData);
+            }];
         });
     }
     
     return operation;
 }
 
+// Query the in-memory cache, and filter the result with the query options
+- (nullable UIImage *)queryMemoryImageForKey:(nonnull NSString *)key options:(SDImageCacheOptions)options context:(nullable SDWebImageContext *)context {
+    UIImage *image = [self imageFromMemoryCacheForKey:key];
+    if (image) {
+        if (options & SDImageCacheDecodeFirstFrameOnly) {
+            // Ensure static image
+            if (image.sd_imageFrameCount > 1) {
+#if SD_MAC
+                image = [[NSImage alloc] initWithCGImage:image.CGImage scale:image.scale orientation:kCGImagePropertyOrientationUp];
+#else
+                image = [[UIImage alloc] initWithCGImage:image.CGImage scale:image.scale orientation:image.imageOrientation];
+#endif
+            }
+        } else if (options & SDImageCacheMatchAnimatedImageClass) {
+            // Check image class matching
+            Class animatedImageClass = image.class;
+            Class desiredImageClass = context[SDWebImageContextAnimatedImageClass];
+            if (desiredImageClass && ![animatedImageClass isSubclassOfClass:desiredImageClass]) {
+                image = nil;
+            }
+        }
+    }
+    return image;
+}
+
+// Decode the disk data for memory cache miss, and sync the result to memory cache. The extended data should be read on ioQueue by caller
+- (nullable UIImage *)queryDiskImageForKey:(nonnull NSString *)key data:(nonnull NSData *)diskData extendedData:(nullable NSData *)extendedData options:(SDImageCacheOptions)options context:(nullable SDWebImageContext *)context shouldCheckMemory:(BOOL)shouldCheckMemory {
+    UIImage *diskImage;
+    BOOL shouldCacheToMemory = YES;
+    if (context[SDWebImageContextStoreCacheType]) {
+        SDImageCacheType cacheType = [context[SDWebImageContextStoreCacheType] integerValue];
+        shouldCacheToMemory = (cacheType == SDImageCacheTypeAll || cacheType == SDImageCacheTypeMemory);
+    }
+    // Special case: If user query image in list for the same URL, to avoid decode and write **same** image object into disk cache multiple times, we query and check memory cache here again. See: #3523
+    // This because disk operation can be async, previous sync check of `memory cache miss`, does not gurantee current check of `memory cache miss`
+    if (shouldCheckMemory) {
+        diskImage = [self imageFromMemoryCacheForKey:key];
+    }
+    // decode image data only if in-memory cache missed
+    if (!diskImage) {
+        diskImage = [self diskImageForKey:key data:diskData extendedData:extendedData options:options context:context];
+        // check if we need sync logic
+        if (shouldCacheToMemory) {
+            [self _syncDiskToMemoryWithImage:diskImage forKey:key];
+        }
+    }
+    return diskImage;
+}
+
+- (nullable SDImageCacheToken *)queryCacheOperationForKeys:(NSArray<NSString *> *)keys options:(SDImageCacheOptions)options context:(nullable SDWebImageContext *)context cacheType:(SDImageCacheType)queryCacheType done:(nullable SDImageCacheBatchQueryCompletionBlock)doneBlock {
+    if (keys.count == 0) {
+        return nil;
+    }
+    // Invalid cache type
+    if (queryCacheType == SDImageCacheTypeNone) {
+        if (doneBlock) {
+            for (NSString *key in keys) {
+                doneBlock(key, nil, nil, SDImageCacheTypeNone);
+            }
+        }
+        return nil;
+    }
+    
+    // First check the in-memory cache for all keys, answer the hits synchronously
+    BOOL shouldQueryDiskOnly = (queryCacheType == SDImageCacheTypeDisk);
+    BOOL shouldQueryMemoryOnly = (queryCacheType == SDImageCacheTypeMemory);
+    // Same as the single key query, decide whether to query disk synchronously for each key
+    // 1. in-memory cache hit & memoryDataSync
+    // 2. in-memory cache miss & diskDataSync
+    NSMutableArray<NSString *> *syncDiskKeys = [NSMutableArray array];
+    NSMutableArray<NSString *> *diskKeys = [NSMutableArray arrayWithCapacity:keys.count];
+    NSMutableDictionary<NSString *, UIImage *> *memoryImages = [NSMutableDictionary dictionary];
+    for (NSString *key in keys) {
+        UIImage *image;
+        if (!shouldQueryDiskOnly) {
+            image = [self queryMemoryImageForKey:key options:options context:context];
+        }
+        if (shouldQueryMemoryOnly || (image && !(options & SDImageCacheQueryMemoryData))) {
+            if (doneBlock) {
+                // Same as the single key query, the memory-only query always report memory cache type
+                doneBlock(key, image, nil, SDImageCacheTypeMemory);
+            }
+            continue;
+        }
+        if (image) {
+            memoryImages[key] = image;
+        }
+        BOOL shouldQueryDiskSync = ((image && options & SDImageCacheQueryMemoryDataSync) ||
+                                    (!image && options & SDImageCacheQueryDiskDataSync));
+        if (shouldQueryDiskSync) {
+            [syncDiskKeys addObject:key];
+        } else {
+            [diskKeys addObject:key];
+        }
+    }
+    if (syncDiskKeys.count == 0 && diskKeys.count == 0) {
+        return nil;
+    }
+    
+    // Then read all the disk data in one pass on ioQueue, in the order of keys (the caller's priority)
+    SDCallbackQueue *queue = context[SDWebImageContextCallbackQueue];
+    // The token is shared by all keys, cancel it does not callback
+    SDImageCacheToken *operation = [[SDImageCacheToken alloc] initWithDoneBlock:nil];
+    operation.callbackQueue = queue;
+    BOOL (^isCancelled)(void) = ^BOOL {
+        @synchronized (operation) {
+            return operation.isCancelled;
+        }
+    };
+    void(^completionBlock)(NSString *, UIImage *, NSData *, BOOL) = ^(NSString *key, UIImage *diskImage, NSData *diskData, BOOL sync) {
+        if (!doneBlock || isCancelled()) {
+            return;
+        }
+        // Same as the single key query, the disk query always report disk cache type
+        if (sync) {
+            doneBlock(key, diskImage, diskData, SDImageCacheTypeDisk);
+            return;
+        }
+        [(queue ?: SDCallbackQueue.mainQueue) async:^{
+            if (isCancelled()) {
+                return;
+            }
+            doneBlock(key, diskImage, diskData, SDImageCacheTypeDisk);
+        }];
+    };
+    
+    if (syncDiskKeys.count > 0) {
+        NSMutableDictionary<NSString *, NSData *> *diskDatas = [NSMutableDictionary dictionaryWithCapacity:syncDiskKeys.count];
+        NSMutableDictionary<NSString *, NSData *> *extendedDatas = [NSMutableDictionary dictionary];
+        dispatch_sync(self.ioQueue, ^{
+            for (NSString *key in syncDiskKeys) {
+                if (isCancelled()) {
+                    break;
+                }
+                @autoreleasepool {
+                    NSData *diskData = [self diskImageDataBySearchingAllPathsForKey:key];
+                    diskDatas[key] = diskData;
+                    if (diskData && !memoryImages[key]) {
+                        extendedDatas[key] = [self.diskCache extendedDataForKey:key];
+                    }
+                }
+            }
+        });
+        for (NSString *key in syncDiskKeys) {
+            NSData *diskData = diskDatas[key];
+            UIImage *diskImage = memoryImages[key];
+            if (!diskImage && diskData) {
+                diskImage = [self queryDiskImageForKey:key data:diskData extendedData:extendedDatas[key] options:options context:context shouldCheckMemory:NO];
+            }
+            completionBlock(key, diskImage, diskData, YES);
+        }
+    }
+    if (diskKeys.count == 0) {
+        return operation;
+    }
+    
+    atomic_fetch_add_explicit(&_pendingDiskReadCount, diskKeys.count, memory_order_relaxed);
+    dispatch_async(self.ioQueue, ^{
+        for (NSString *key in diskKeys) {
+            @autoreleasepool {
+                if (isCancelled()) {
+                    atomic_fetch_sub_explicit(&self->_pendingDiskReadCount, 1, memory_order_relaxed);
+                    continue;
+                }
+                NSData *diskData = [self diskImageDataBySearchingAllPathsForKey:key];
+                atomic_fetch_sub_explicit(&self->_pendingDiskReadCount, 1, memory_order_relaxed);
+                UIImage *image = memoryImages[key];
+                if (image || !diskData) {
+                    // No need to decode, stream back directly
+                    completionBlock(key, image, diskData, NO);
+                    continue;
+                }
+                // The extended data is read here as well, nothing on decodeQueue touch the disk cache
+                NSData *extendedData = [self.diskCache extendedDataForKey:key];
+                // Decode in concurrent decode queue, so the next disk read does not wait
+                atomic_fetch_add_explicit(&self->_pendingDecodeCount, 1, memory_order_relaxed);
+                [self.decodeQueue addOperationWithBlock:^{
+                    UIImage *diskImage;
+                    if (!isCancelled()) {
+                        diskImage = [self queryDiskImageForKey:key data:diskData extendedData:extendedData options:options context:context shouldCheckMemory:!shouldQueryDiskOnly];
+                    }
+                    atomic_fetch_sub_explicit(&self->_pendingDecodeCount, 1, memory_order_relaxed);
+                    completionBlock(key, diskImage, diskData, NO);
+                }];
+            }
+        }
+    });
+    
+    return operation;
+}
+
 #pragma mark - Remove Ops
 
 - (void)removeImageForKey:(nullable NSString *)key withCompletion:(nullable SDWebImageNoParamsBlock)completion {
@@ -768,6 +1031,7 @@ static NSString * _defaultDiskCacheDirectory;
     }
 
     if (fromDisk) {
+        [self invalidateRegionImagesForKey:key];
         dispatch_async(self.ioQueue, ^{
             [self.diskCache removeDataForKey:key];
             
@@ -806,17 +1070,39 @@ static NSString * _defaultDiskCacheDirectory;
     }
     
     [self.diskCache removeDataForKey:key];
+    [self invalidateRegionImagesForKey:key];
 }
 
 #pragma mark - Cache clean Ops
 
 - (void)clearMemory {
     [self.memoryCache removeAllObjects];
+    [self.regionImageDataCache removeAllObjects];
+    // No region image left in memory cache, start over
+    @synchronized (self.regionImageGenerations) {
+        [self.regionImageGenerations removeAllObjects];
+    }
 }
 
 - (void)clearDiskOnCompletion:(nullable SDWebImageNoParamsBlock)completion {
     dispatch_async(self.ioQueue, ^{
         [self.diskCache removeAllData];
+        [self.regionImageDataCache removeAllObjects];
+        // The shared image source cache is used by other caches as well, only remove the image sources decoded by this cache
+        NSArray<NSString *> *imageSourceKeys;
+        @synchronized (self.imageSourceKeys) {
+            imageSourceKeys = self.imageSourceKeys.allObjects;
+            [self.imageSourceKeys removeAllObjects];
+        }
+        for (NSString *imageSourceKey in imageSourceKeys) {
+            [SDImageSourceCache.sharedCache removeImageSourceForKey:imageSourceKey];
+        }
+        // The region images in memory cache belong to the removed data
+        @synchronized (self.regionImageGenerations) {
+            for (NSString *key in self.regionImageGenerations.allKeys) {
+                self.regionImageGenerations[key] = @(++self.lastRegionImageGeneration);
+            }
+        }
         if (completion) {
             dispatch_async(dispatch_get_main_queue(), ^{
                 completion();
@@ -896,6 +1182,14 @@ static NSString * _defaultDiskCacheDirectory;
     return count;
 }
 
+- (NSUInteger)pendingDiskReadCount {
+    return atomic_load_explicit(&_pendingDiskReadCount, memory_order_relaxed);
+}
+
+- (NSUInteger)pendingDecodeCount {
+    return atomic_load_explicit(&_pendingDecodeCount, memory_order_relaxed);
+}
+
 - (void)calculateSizeWithCompletionBlock:(nullable SDImageCacheCalculateSizeBlock)completionBlock {
     dispatch_async(self.ioQueue, ^{
         NSUInteger fileCount = [self.diskCache totalCount];
@@ -909,6 +1203,55 @@ static NSString * _defaultDiskCacheDirectory;
 }
 
 #pragma mark - Helper
+
+// The memory cache key of the region image, which contains the generation of the image data
+- (NSString *)regionedKeyForKey:(NSString *)key region:(CGRect)region pixelSize:(CGSize)pixelSize {
+    NSString *regionKey = SDRegionedKeyForKey(key, region, pixelSize);
+    NSUInteger generation;
+    @synchronized (self.regionImageGenerations) {
+        NSNumber *generationValue = self.regionImageGenerations[key];
+        if (generationValue == nil) {
+            // Record the key, so the generation is bumped when the data changed
+            generationValue = @(0);
+            self.regionImageGenerations[key] = generationValue;
+        }
+        generation = generationValue.unsignedIntegerValue;
+    }
+    if (generation == 0) {
+        return regionKey;
+    }
+    return SDTransformedKeyForKey(regionKey, [NSString stringWithFormat:@"Generation(%lu)", (unsigned long)generation]);
+}
+
+- (void)invalidateRegionImagesForKey:(NSString *)key {
+    [self.regionImageDataCache removeObjectForKey:key];
+    [SDImageSourceCache.sharedCache removeImageSourceForKey:key];
+    @synchronized (self.imageSourceKeys) {
+        [self.imageSourceKeys removeObject:key];
+    }
+    @synchronized (self.regionImageGenerations) {
+        if (self.regionImageGenerations[key] != nil) {
+            self.regionImageGenerations[key] = @(++self.lastRegionImageGeneration);
+        }
+    }
+}
+
+// Record the key which the decoding may cache the image source for
+- (void)recordImageSourceKey:(NSString *)key {
+    if (!key || SDImageSourceCache.sharedCache.totalCostLimit == 0) {
+        return;
+    }
+    @synchronized (self.imageSourceKeys) {
+        if (self.imageSourceKeys.count >= kSDImageCacheImageSourceKeysPruneCount) {
+            NSSet<NSString *> *evictedKeys = [self.imageSourceKeys objectsPassingTest:^BOOL(NSString *imageSourceKey, BOOL *stop) {
+                return ![SDImageSourceCache.sharedCache containsImageSourceForKey:imageSourceKey];
+            }];
+            [self.imageSourceKeys minusSet:evictedKeys];
+        }
+        [self.imageSourceKeys addObject:key];
+    }
+}
+
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wdeprecated-declarations"
 + (SDWebImageOptions)imageOptionsFromCacheOptions:(SDImageCacheOptions)cacheOptions {
@@ -929,13 +1272,7 @@ static NSString * _defaultDiskCacheDirectory;
 
 #pragma mark - SDImageCache
 
-- (id<SDWebImageOperation>)queryImageForKey:(NSString *)key options:(SDWebImageOptions)options context:(nullable SDWebImageContext *)context completion:(nullable SDImageCacheQueryCompletionBlock)completionBlock {
-    return [self queryImageForKey:key options:options context:context cacheType:SDImageCacheTypeAll completion:completionBlock];
-}
-
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wdeprecated-declarations"
-- (id<SDWebImageOperation>)queryImageForKey:(NSString *)key options:(SDWebImageOptions)options context:(nullable SDWebImageContext *)context cacheType:(SDImageCacheType)cacheType completion:(nullable SDImageCacheQueryCompletionBlock)completionBlock {
+static inline SDImageCacheOptions SDImageCacheOptionsFromWebImageOptions(SDWebImageOptions options) {
     SDImageCacheOptions cacheOptions = 0;
     if (options & SDWebImageQueryMemoryData) cacheOptions |= SDImageCacheQueryMemoryData;
     if (options & SDWebImageQueryMemoryDataSync) cacheOptions |= SDImageCacheQueryMemoryDataSync;
@@ -945,11 +1282,26 @@ static NSString * _defaultDiskCacheDirectory;
     if (options & SDWebImageDecodeFirstFrameOnly) cacheOptions |= SDImageCacheDecodeFirstFrameOnly;
     if (options & SDWebImagePreloadAllFrames) cacheOptions |= SDImageCachePreloadAllFrames;
     if (options & SDWebImageMatchAnimatedImageClass) cacheOptions |= SDImageCacheMatchAnimatedImageClass;
-    
+    return cacheOptions;
+}
+
+- (id<SDWebImageOperation>)queryImageForKey:(NSString *)key options:(SDWebImageOptions)options context:(nullable SDWebImageContext *)context completion:(nullable SDImageCacheQueryCompletionBlock)completionBlock {
+    return [self queryImageForKey:key options:options context:context cacheType:SDImageCacheTypeAll completion:completionBlock];
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+- (id<SDWebImageOperation>)queryImageForKey:(NSString *)key options:(SDWebImageOptions)options context:(nullable SDWebImageContext *)context cacheType:(SDImageCacheType)cacheType completion:(nullable SDImageCacheQueryCompletionBlock)completionBlock {
+    SDImageCacheOptions cacheOptions = SDImageCacheOptionsFromWebImageOptions(options);
     return [self queryCacheOperationForKey:key options:cacheOptions context:context cacheType:cacheType done:completionBlock];
 }
 #pragma clang diagnostic pop
 
+- (id<SDWebImageOperation>)queryImagesForKeys:(NSArray<NSString *> *)keys options:(SDWebImageOptions)options context:(nullable SDWebImageContext *)context cacheType:(SDImageCacheType)cacheType completion:(nullable SDImageCacheBatchQueryCompletionBlock)completionBlock {
+    SDImageCacheOptions cacheOptions = SDImageCacheOptionsFromWebImageOptions(options);
+    return [self queryCacheOperationForKeys:keys options:cacheOptions context:context cacheType:cacheType done:completionBlock];
+}
+
 - (void)storeImage:(UIImage *)image imageData:(NSData *)imageData forKey:(nullable NSString *)key cacheType:(SDImageCacheType)cacheType completion:(nullable SDWebImageNoParamsBlock)completionBlock {
     [self storeImage:image imageData:imageData forKey:key options:0 context:nil cacheType:cacheType completion:completionBlock];
 }
@@ -74,12 +74,32 @@ typedef NS_ENUM(NSUInteger, SDImageCacheConfigExpireType) {
  */
 @property (assign, nonatomic) BOOL shouldRemoveExpiredDataWhenTerminate;
 
+/**
+ * Whether or not to keep an in-memory index of the disk cache files, persisted with a journal file in disk cache directory.
+ * When enabled, the built-in `SDDiskCache` answers the existence check, total size and total count queries from memory, and record the access date in the index instead of updating the file attribute. Which avoid the filesystem syscalls on the hot read path.
+ * The index is loaded from journal on the first disk cache access. If the journal does not exist, we scan the directory once to build the index.
+ * @note When enabled, the `SDImageCacheConfigExpireTypeAccessDate` expire type use the access date recorded in index, other expire types use the write date recorded in index.
+ * @warning When enabled, do not modify the files in disk cache directory outside of the disk cache, or the index may be out of sync.
+ * @note This value does not support dynamic changes. Which means further modification on this value after cache initialized has no effect.
+ * Defaults to NO.
+ */
+@property (assign, nonatomic) BOOL shouldUseDiskCacheIndex;
+
 /**
  * The reading options while reading cache from disk.
  * Defaults to 0. You can set this to `NSDataReadingMappedIfSafe` to improve performance.
  */
 @property (assign, nonatomic) NSDataReadingOptions diskCacheReadingOptions;
 
+/**
+ * Whether or not to always read the disk cache file with memory mapping (`NSDataReadingMappedAlways`), regardless of `diskCacheReadingOptions`.
+ * When enabled, the disk cache hit data is backed by the file mapping and passed to the coders and ImageIO without copy. The compressed bytes are paged in on demand during decoding (outside of the ioQueue), and the mapping is unmapped once the data is released, so the peak memory does not include a second copy of the compressed bytes.
+ * The built-in `SDDiskCache` always write the file atomically when enabled, because overwriting a mapped file in place is not safe.
+ * @note If the mapping failed (for example, empty file), we fallback to read the file normally.
+ * Defaults to NO.
+ */
+@property (assign, nonatomic) BOOL shouldMapDiskCacheData;
+
 /**
  * The writing options while writing cache to disk.
  * Defaults to `NSDataWritingAtomic`. You can set this to `NSDataWritingWithoutOverwriting` to prevent overwriting an existing file.
@@ -100,6 +120,15 @@ typedef NS_ENUM(NSUInteger, SDImageCacheConfigExpireType) {
  */
 @property (assign, nonatomic) NSUInteger maxDiskSize;
 
+/**
+ * The maximum number of files to remove in one disk cache eviction pass. This enable the incremental eviction, which only works when `shouldUseDiskCacheIndex` is enabled.
+ * When enabled, the eviction walks the disk cache index from the oldest entry, so it does not need to scan and sort the whole directory. Each pass remove at most this number of files, to keep each pass in bounded time and IO:
+ * 1. After storing data, if the total size exceed `maxDiskSize` (the high-water mark), one pass is performed to remove the oldest files until the total size fall below 90% of `maxDiskSize`. So the disk cache is continuously kept under the limit.
+ * 2. `removeExpiredData` (including the one triggered by application entering background or terminating) only perform one pass to remove the expired and oldest files, instead of a full directory scan.
+ * Defaults to 0, which means no limit, and use the full pass eviction.
+ */
+@property (assign, nonatomic) NSUInteger maxDiskEvictionCount;
+
 /**
  * The maximum "total cost" of the in-memory image cache. The cost function is the bytes size held in memory.
  * @note The memory cost is bytes size in memory, but not simple pixels count. For common ARGB8888 image, one pixel is 4 bytes (32 bits).
@@ -136,6 +165,13 @@ typedef NS_ENUM(NSUInteger, SDImageCacheConfigExpireType) {
  */
 @property (strong, nonatomic, nullable) dispatch_queue_attr_t ioQueueAttributes;
 
+/**
+ * The maximum number of concurrent image decoding during disk cache query. The disk data is read in ioQueue, then the image decoding happens in a separate concurrent decode queue, so that one large image decoding does not block other disk read/write in ioQueue.
+ * Defaults to the active processor count. Pass 0 to use the default value.
+ * @note This value does not support dynamic changes. Which means further modification on this value after cache initialized has no effect.
+ */
+@property (assign, nonatomic) NSUInteger maxConcurrentDecodeCount;
+
 /**
  * The custom memory cache class. Provided class instance must conform to `SDMemoryCache` protocol to allow usage.
  * Defaults to built-in `SDMemoryCache` class.
@@ -30,10 +30,13 @@ static const NSInteger kDefaultCacheMaxDiskAge = 60 * 60 * 24 * 7; // 1 week
         _shouldUseWeakMemoryCache = NO;
         _shouldRemoveExpiredDataWhenEnterBackground = YES;
         _shouldRemoveExpiredDataWhenTerminate = YES;
+        _shouldUseDiskCacheIndex = NO;
         _diskCacheReadingOptions = 0;
+        _shouldMapDiskCacheData = NO;
         _diskCacheWritingOptions = NSDataWritingAtomic;
         _maxDiskAge = kDefaultCacheMaxDiskAge;
         _maxDiskSize = 0;
+        _maxDiskEvictionCount = 0;
         _diskCacheExpireType = SDImageCacheConfigExpireTypeAccessDate;
         _fileManager = nil;
         if (@available(iOS 10.0, tvOS 10.0, macOS 10.12, watchOS 3.0, *)) {
@@ -41,6 +44,7 @@ static const NSInteger kDefaultCacheMaxDiskAge = 60 * 60 * 24 * 7; // 1 week
         } else {
             _ioQueueAttributes = DISPATCH_QUEUE_SERIAL; // NULL
         }
+        _maxConcurrentDecodeCount = NSProcessInfo.processInfo.activeProcessorCount;
         _memoryCacheClass = [SDMemoryCache class];
         _diskCacheClass = [SDDiskCache class];
     }
@@ -54,15 +58,19 @@ static const NSInteger kDefaultCacheMaxDiskAge = 60 * 60 * 24 * 7; // 1 week
     config.shouldUseWeakMemoryCache = self.shouldUseWeakMemoryCache;
     config.shouldRemoveExpiredDataWhenEnterBackground = self.shouldRemoveExpiredDataWhenEnterBackground;
     config.shouldRemoveExpiredDataWhenTerminate = self.shouldRemoveExpiredDataWhenTerminate;
+    config.shouldUseDiskCacheIndex = self.shouldUseDiskCacheIndex;
     config.diskCacheReadingOptions = self.diskCacheReadingOptions;
+    config.shouldMapDiskCacheData = self.shouldMapDiskCacheData;
     config.diskCacheWritingOptions = self.diskCacheWritingOptions;
     config.maxDiskAge = self.maxDiskAge;
     config.maxDiskSize = self.maxDiskSize;
+    config.maxDiskEvictionCount = self.maxDiskEvictionCount;
     config.maxMemoryCost = self.maxMemoryCost;
     config.maxMemoryCount = self.maxMemoryCount;
     config.diskCacheExpireType = self.diskCacheExpireType;
     config.fileManager = self.fileManager; // NSFileManager does not conform to NSCopying, just pass the reference
     config.ioQueueAttributes = self.ioQueueAttributes; // Pass the reference
+    config.maxConcurrentDecodeCount = self.maxConcurrentDecodeCount;
     config.memoryCacheClass = self.memoryCacheClass;
     config.diskCacheClass = self.diskCacheClass;
     
@@ -41,6 +41,7 @@ typedef void(^SDImageCacheQueryDataCompletionBlock)(NSData * _Nullable data);
 typedef void(^SDImageCacheCalculateSizeBlock)(NSUInteger fileCount, NSUInteger totalSize);
 typedef NSString * _Nullable (^SDImageCacheAdditionalCachePathBlock)(NSString * _Nonnull key);
 typedef void(^SDImageCacheQueryCompletionBlock)(UIImage * _Nullable image, NSData * _Nullable data, SDImageCacheType cacheType);
+typedef void(^SDImageCacheBatchQueryCompletionBlock)(NSString * _Nonnull key, UIImage * _Nullable image, NSData * _Nullable data, SDImageCacheType cacheType);
 typedef void(^SDImageCacheContainsCompletionBlock)(SDImageCacheType containsCacheType);
 
 /**
@@ -108,6 +109,23 @@ FOUNDATION_EXPORT void SDSetDecodeOptionsToContext(SDWebImageMutableContext * _N
                                            cacheType:(SDImageCacheType)cacheType
                                           completion:(nullable SDImageCacheQueryCompletionBlock)completionBlock;
 
+/**
+ Query the cached images from image cache for multiple keys at once, which is useful for list or grid prefetching. The operation can be used to cancel the remaining queries.
+ Compared to query each key separately, the cache can answer all the memory hits at once, and read all the disk hits in one pass.
+
+ @param keys The image cache keys
+ @param options A mask to specify options to use for this query
+ @param context A context contains different options to perform specify changes or processes, see `SDWebImageContextOption`. This hold the extra objects which `options` enum can not hold. Pass `.callbackQueue` to control callback queue
+ @param cacheType Specify where to query the cache from. By default we use `.all`, which means both memory cache and disk cache. You can choose to query memory only or disk only as well. Pass `.none` is invalid and callback with nil immediately.
+ @param completionBlock The completion block, called once for each key as soon as its result is available (the order is not guaranteed). The cache type is the same as `queryImageForKey:options:context:cacheType:completion:` report for that key, check the image or data for miss. Will not get called for the remaining keys if the operation is cancelled
+ @return The operation for this query
+ */
+- (nullable id<SDWebImageOperation>)queryImagesForKeys:(nonnull NSArray<NSString *> *)keys
+                                               options:(SDWebImageOptions)options
+                                               context:(nullable SDWebImageContext *)context
+                                             cacheType:(SDImageCacheType)cacheType
+                                            completion:(nullable SDImageCacheBatchQueryCompletionBlock)completionBlock;
+
 @required
 /**
  Store the image into image cache for the given key. If cache type is memory only, completion is called synchronously, else asynchronously.
@@ -65,6 +65,7 @@ SDImageCoderOptions * _Nonnull SDGetDecodeOptionsFromContext(SDWebImageContext *
     mutableCoderOptions[SDImageCoderDecodeFileExtensionHint] = fileExtensionHint;
     mutableCoderOptions[SDImageCoderDecodeScaleDownLimitBytes] = scaleDownLimitBytesValue;
     mutableCoderOptions[SDImageCoderDecodeToHDR] = decodeToHDR;
+    mutableCoderOptions[SDImageCoderDecodeImageSourceCacheKey] = cacheKey;
     
     return [mutableCoderOptions copy];
 }
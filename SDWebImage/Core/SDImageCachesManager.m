@@ -129,6 +129,50 @@
     }
 }
 
+- (id<SDWebImageOperation>)queryImagesForKeys:(NSArray<NSString *> *)keys options:(SDWebImageOptions)options context:(SDWebImageContext *)context cacheType:(SDImageCacheType)cacheType completion:(SDImageCacheBatchQueryCompletionBlock)completionBlock {
+    if (keys.count == 0) {
+        return nil;
+    }
+    // The duplicated keys are queried once
+    keys = [NSOrderedSet orderedSetWithArray:keys].array;
+    NSArray<id<SDImageCache>> *caches = self.caches;
+    NSUInteger count = caches.count;
+    if (count == 0) {
+        return nil;
+    } else if (count == 1) {
+        return [self queryImagesForKeys:keys options:options context:context cacheType:cacheType completion:completionBlock cache:caches.firstObject];
+    }
+    switch (self.queryOperationPolicy) {
+        case SDImageCachesManagerOperationPolicyHighestOnly: {
+            id<SDImageCache> cache = caches.lastObject;
+            return [self queryImagesForKeys:keys options:options context:context cacheType:cacheType completion:completionBlock cache:cache];
+        }
+            break;
+        case SDImageCachesManagerOperationPolicyLowestOnly: {
+            id<SDImageCache> cache = caches.firstObject;
+            return [self queryImagesForKeys:keys options:options context:context cacheType:cacheType completion:completionBlock cache:cache];
+        }
+            break;
+        case SDImageCachesManagerOperationPolicyConcurrent: {
+            SDImageCachesManagerOperation *operation = [SDImageCachesManagerOperation new];
+            [operation beginWithTotalCount:caches.count];
+            [self concurrentQueryImagesForKeys:keys options:options context:context cacheType:cacheType completion:completionBlock enumerator:caches.reverseObjectEnumerator operation:operation];
+            return operation;
+        }
+            break;
+        case SDImageCachesManagerOperationPolicySerial: {
+            SDImageCachesManagerOperation *operation = [SDImageCachesManagerOperation new];
+            [operation beginWithTotalCount:caches.count];
+            [self serialQueryImagesForKeys:keys options:options context:context cacheType:cacheType completion:completionBlock enumerator:caches.reverseObjectEnumerator operation:operation];
+            return operation;
+        }
+            break;
+        default:
+            return nil;
+            break;
+    }
+}
+
 - (void)storeImage:(UIImage *)image imageData:(NSData *)imageData forKey:(NSString *)key cacheType:(SDImageCacheType)cacheType completion:(SDWebImageNoParamsBlock)completionBlock {
     [self storeImage:image imageData:imageData forKey:key options:0 context:nil cacheType:cacheType completion:completionBlock];
 }
@@ -284,6 +328,128 @@
     }
 }
 
+#pragma mark - Batch Query
+
+- (id<SDWebImageOperation>)queryImagesForKeys:(NSArray<NSString *> *)keys options:(SDWebImageOptions)options context:(SDWebImageContext *)context cacheType:(SDImageCacheType)queryCacheType completion:(SDImageCacheBatchQueryCompletionBlock)completionBlock cache:(id<SDImageCache>)cache {
+    if ([cache respondsToSelector:@selector(queryImagesForKeys:options:context:cacheType:completion:)]) {
+        return [cache queryImagesForKeys:keys options:options context:context cacheType:queryCacheType completion:completionBlock];
+    }
+    // The cache does not support batch query, query each key
+    SDImageCachesManagerOperation *operation = [SDImageCachesManagerOperation new];
+    [operation beginWithTotalCount:keys.count];
+    for (NSString *key in keys) {
+        [cache queryImageForKey:key options:options context:context cacheType:queryCacheType completion:^(UIImage * _Nullable image, NSData * _Nullable data, SDImageCacheType cacheType) {
+            if (operation.isCancelled) {
+                // Cancelled
+                return;
+            }
+            [operation completeOne];
+            if (operation.pendingCount == 0) {
+                [operation done];
+            }
+            if (completionBlock) {
+                completionBlock(key, image, data, cacheType);
+            }
+        }];
+    }
+    return operation;
+}
+
+- (void)concurrentQueryImagesForKeys:(NSArray<NSString *> *)keys options:(SDWebImageOptions)options context:(SDWebImageContext *)context cacheType:(SDImageCacheType)queryCacheType completion:(SDImageCacheBatchQueryCompletionBlock)completionBlock enumerator:(NSEnumerator<id<SDImageCache>> *)enumerator operation:(SDImageCachesManagerOperation *)operation {
+    NSParameterAssert(enumerator);
+    NSParameterAssert(operation);
+    // The number of caches which have not answered each key
+    NSMutableDictionary<NSString *, NSNumber *> *pendingCounts = [NSMutableDictionary dictionaryWithCapacity:keys.count];
+    for (NSString *key in keys) {
+        pendingCounts[key] = @(operation.pendingCount);
+    }
+    NSMutableSet<NSString *> *finishedKeys = [NSMutableSet setWithCapacity:keys.count];
+    NSUInteger totalCount = keys.count;
+    for (id<SDImageCache> cache in enumerator) {
+        [self queryImagesForKeys:keys options:options context:context cacheType:queryCacheType completion:^(NSString * _Nonnull key, UIImage * _Nullable image, NSData * _Nullable data, SDImageCacheType cacheType) {
+            if (operation.isCancelled) {
+                // Cancelled
+                return;
+            }
+            BOOL shouldCallback = NO;
+            BOOL isFinished = NO;
+            @synchronized (finishedKeys) {
+                if (![finishedKeys containsObject:key]) {
+                    NSUInteger pendingCount = pendingCounts[key].unsignedIntegerValue - 1;
+                    pendingCounts[key] = @(pendingCount);
+                    if (image || pendingCount == 0) {
+                        // First hit, or all caches missed
+                        [finishedKeys addObject:key];
+                        shouldCallback = YES;
+                        isFinished = finishedKeys.count == totalCount;
+                    }
+                }
+            }
+            if (isFinished) {
+                // Complete
+                [operation done];
+            }
+            if (shouldCallback && completionBlock) {
+                if (image) {
+                    completionBlock(key, image, data, cacheType);
+                } else {
+                    completionBlock(key, nil, nil, SDImageCacheTypeNone);
+                }
+            }
+        } cache:cache];
+    }
+}
+
+- (void)serialQueryImagesForKeys:(NSArray<NSString *> *)keys options:(SDWebImageOptions)options context:(SDWebImageContext *)context cacheType:(SDImageCacheType)queryCacheType completion:(SDImageCacheBatchQueryCompletionBlock)completionBlock enumerator:(NSEnumerator<id<SDImageCache>> *)enumerator operation:(SDImageCachesManagerOperation *)operation {
+    NSParameterAssert(enumerator);
+    NSParameterAssert(operation);
+    id<SDImageCache> cache = enumerator.nextObject;
+    if (!cache) {
+        // Complete, the remaining keys are missed in all caches
+        [operation done];
+        if (completionBlock) {
+            for (NSString *key in keys) {
+                completionBlock(key, nil, nil, SDImageCacheTypeNone);
+            }
+        }
+        return;
+    }
+    // Only the missed keys are queried in next cache
+    NSMutableArray<NSString *> *missedKeys = [NSMutableArray array];
+    __block NSUInteger pendingCount = keys.count;
+    @weakify(self);
+    [self queryImagesForKeys:keys options:options context:context cacheType:queryCacheType completion:^(NSString * _Nonnull key, UIImage * _Nullable image, NSData * _Nullable data, SDImageCacheType cacheType) {
+        @strongify(self);
+        if (operation.isCancelled) {
+            // Cancelled
+            return;
+        }
+        BOOL isLast;
+        @synchronized (missedKeys) {
+            if (!image) {
+                [missedKeys addObject:key];
+            }
+            pendingCount--;
+            isLast = pendingCount == 0;
+        }
+        if (image && completionBlock) {
+            // Success
+            completionBlock(key, image, data, cacheType);
+        }
+        if (!isLast) {
+            return;
+        }
+        [operation completeOne];
+        if (missedKeys.count == 0) {
+            // Complete
+            [operation done];
+            return;
+        }
+        // Next
+        [self serialQueryImagesForKeys:[missedKeys copy] options:options context:context cacheType:queryCacheType completion:completionBlock enumerator:enumerator operation:operation];
+    } cache:cache];
+}
+
 #pragma mark - Concurrent Operation
 
 - (void)concurrentQueryImageForKey:(NSString *)key options:(SDWebImageOptions)options context:(SDWebImageContext *)context cacheType:(SDImageCacheType)queryCacheType completion:(SDImageCacheQueryCompletionBlock)completionBlock enumerator:(NSEnumerator<id<SDImageCache>> *)enumerator operation:(SDImageCachesManagerOperation *)operation {
@@ -97,6 +97,13 @@ FOUNDATION_EXPORT SDImageCoderOption _Nonnull const SDImageCoderDecodeScaleDownL
  */
 FOUNDATION_EXPORT SDImageCoderOption _Nonnull const SDImageCoderDecodeToHDR;
 
+/**
+ A NSString value to provide the image cache key of the data, used to reuse the parsed image source from `SDImageSourceCache` for the same image.
+ @note The built-in cache and loader provide this option automatically. It takes effect only when `SDImageSourceCache.sharedCache.totalCostLimit` is not 0.
+ @note works for `SDImageCoder`, `SDAnimatedImageCoder`
+ */
+FOUNDATION_EXPORT SDImageCoderOption _Nonnull const SDImageCoderDecodeImageSourceCacheKey;
+
 #pragma mark - Image Encoding Options
 /**
  A NSUInteger (`SDImageHDRType.rawValue`) value (stored inside NSNumber) to provide converting to HDR during encoding. Read the below carefully to choose the value.
@@ -277,6 +284,17 @@ FOUNDATION_EXPORT SDImageCoderOption _Nonnull const SDImageCoderWebImageContext
  */
 - (nullable UIImage *)incrementalDecodedImageWithOptions:(nullable SDImageCoderOptions *)options;
 
+@optional
+/**
+ Update the incremental decoding with only the image data received since last update. The coder which keep its own parsing state can implement this to avoid processing the previous bytes again.
+ If implemented, this is called instead of `updateIncrementalData:finished:`. The first call contains all the bytes downloaded so far.
+ @note The data may be non-contiguous in memory, use `-[NSData enumerateByteRangesUsingBlock:]` to avoid joining the bytes.
+
+ @param data The image data downloaded since last update
+ @param finished Whether the download has finished
+ */
+- (void)appendIncrementalData:(nullable NSData *)data finished:(BOOL)finished;
+
 @end
 
 #pragma mark - Animated Image Provider
@@ -324,6 +342,41 @@ FOUNDATION_EXPORT SDImageCoderOption _Nonnull const SDImageCoderWebImageContext
  */
 - (NSTimeInterval)animatedImageDurationAtIndex:(NSUInteger)index;
 
+@optional
+/**
+ Returns the frame image from a specified index, decoded with a limited pixel size, which is cheaper to decode for large animated image. The player use this to lower the decoding cost when decoding falls behind.
+ @note The index maybe randomly if one image was set to different imageViews, keep it re-entrant.
+ 
+ @param index Frame index (zero based).
+ @param thumbnailSize The max pixel size to decode, keep aspect ratio. If the size is zero, it's the same as `animatedImageFrameAtIndex:`
+ @return Frame's image
+ */
+- (nullable UIImage *)animatedImageFrameAtIndex:(NSUInteger)index thumbnailSize:(CGSize)thumbnailSize;
+
+@end
+
+#pragma mark - Region Coder
+/**
+ This is the image coder protocol to decode only a region of image, at the needed level of detail. This is useful for zoomable huge image like map or photo viewer, where pan/zoom should only touch the bytes and pixels on screen.
+ @note Pay attention that these methods are not called from main queue.
+ */
+@protocol SDRegionImageCoder <SDImageCoder>
+
+@required
+/**
+ Decode the region of image data to image. The coder can reuse the intermediate decoding result (such as the subsampled level image) for the same data object, so pass the same data instance for the tiles of one image.
+
+ @param data The image data to be decoded
+ @param region The source rect in pixels of the image, before applying the EXIF orientation. This will be clipped to the image bounds.
+ @param pixelSize The target pixel size of the decoded image. Pass `CGSizeZero` to use the region size (full level of detail).
+ @param options A dictionary containing any decoding options. Pass @{SDImageCoderDecodeScaleFactor: @(1.0)} to specify scale factor for image.
+ @return The decoded region image, which keep the EXIF orientation
+ */
+- (nullable UIImage *)decodedImageWithData:(nullable NSData *)data
+                                    region:(CGRect)region
+                                 pixelSize:(CGSize)pixelSize
+                                   options:(nullable SDImageCoderOptions *)options;
+
 @end
 
 #pragma mark - Animated Coder
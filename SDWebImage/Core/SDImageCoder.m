@@ -17,6 +17,7 @@ SDImageCoderOption const SDImageCoderDecodeTypeIdentifierHint = @"decodeTypeIden
 SDImageCoderOption const SDImageCoderDecodeUseLazyDecoding = @"decodeUseLazyDecoding";
 SDImageCoderOption const SDImageCoderDecodeScaleDownLimitBytes = @"decodeScaleDownLimitBytes";
 SDImageCoderOption const SDImageCoderDecodeToHDR = @"decodeToHDR";
+SDImageCoderOption const SDImageCoderDecodeImageSourceCacheKey = @"decodeImageSourceCacheKey";
 
 SDImageCoderOption const SDImageCoderEncodeToHDR = @"encodeToHDR";
 SDImageCoderOption const SDImageCoderEncodeFirstFrameOnly = @"encodeFirstFrameOnly";
@@ -67,7 +67,7 @@ typedef struct SDImagePixelFormat {
 
 /**
  Return an animated image with frames array.
- For UIKit, this will apply the patch and then create animated UIImage. The patch is because that `+[UIImage animatedImageWithImages:duration:]` just use the average of duration for each image. So it will not work if different frame has different duration. Therefore we repeat the specify frame for specify times to let it work.
+ For UIKit, `+[UIImage animatedImageWithImages:duration:]` just use the average of duration for each image, so it will not work if different frame has different duration. This will create an animated UIImage which store each frame only once with its duration, and the `images` property repeat the specify frame for specify times (by the GCD of durations) lazily to let UIKit animation work.
  For AppKit, NSImage does not support animates other than GIF. This will try to encode the frames to GIF format and then create an animated NSImage for rendering. Attention the animated image may loss some detail if the input frames contain full alpha channel because GIF only supports 1 bit alpha channel. (For 1 pixel, either transparent or not)
 
  @param frames The frames array. If no frames or frames is empty, return nil
@@ -229,6 +229,13 @@ typedef struct SDImagePixelFormat {
  */
 @property (class, readwrite) NSUInteger defaultScaleDownLimitBytes;
 
+/**
+ Control the max concurrent count to render the tiles when scale down largest images using CoreGraphics, see `decodedAndScaledDownImageWithImage:limitBytes:policy:`.
+ If larger than 1, the output image is split into independent row bands, which are rendered on several cores into the disjoint regions of the destination buffer. The tile size is divided by this count, so the peak memory keep the same as serial rendering.
+ Defaults to 1, which render the tiles serially.
+ */
+@property (class, readwrite) NSUInteger defaultScaleDownConcurrentCount;
+
 #if SD_UIKIT || SD_WATCH
 /**
  Convert an EXIF image orientation to an iOS one.
@@ -19,6 +19,7 @@
 #import "SDInternalMacros.h"
 #import "SDDeviceHelper.h"
 #import "SDImageIOAnimatedCoderInternal.h"
+#import "SDFrameSequenceImage.h"
 #import <Accelerate/Accelerate.h>
 
 #define kCGColorSpaceDeviceRGB CFSTR("kCGColorSpaceDeviceRGB")
@@ -130,6 +131,56 @@ static CGFloat kDestImageLimitBytes = 30.f * kBytesPerMB;
 
 static const CGFloat kDestSeemOverlap = 2.0f;   // the numbers of pixels to overlap the seems where tiles meet.
 
+static NSUInteger kDefaultScaleDownConcurrentCount = 1;
+
+// Split the destination into independent row bands, each band has its own bitmap context which share the disjoint rows of destination buffer. The bands are rendered concurrently, each worker hold at most one source tile at the same time.
+static void SDCGContextDrawScaledDownBandsConcurrently(CGContextRef destContext, CGImageRef sourceImageRef, CGSize destResolution, CGFloat tileTotalPixels, NSUInteger concurrentCount) {
+    size_t destWidth = destResolution.width;
+    size_t destHeight = destResolution.height;
+    size_t sourceWidth = CGImageGetWidth(sourceImageRef);
+    size_t sourceHeight = CGImageGetHeight(sourceImageRef);
+    uint8_t *destData = CGBitmapContextGetData(destContext);
+    size_t bytesPerRow = CGBitmapContextGetBytesPerRow(destContext);
+    CGColorSpaceRef colorspaceRef = CGBitmapContextGetColorSpace(destContext);
+    CGBitmapInfo bitmapInfo = CGBitmapContextGetBitmapInfo(destContext);
+    CGFloat scaleY = (CGFloat)destHeight / sourceHeight;
+    // Use full width source tile, see the serial implementation
+    size_t sourceTileHeight = MAX(1, (size_t)(tileTotalPixels / sourceWidth));
+    size_t bandHeight = MAX(1, (size_t)(sourceTileHeight * scaleY));
+    size_t bandCount = (destHeight + bandHeight - 1) / bandHeight;
+    // The source seem overlap is proportionate to the destination seem overlap.
+    size_t sourceSeemOverlap = (size_t)ceil(kDestSeemOverlap / scaleY);
+    concurrentCount = MIN(concurrentCount, bandCount);
+    
+    dispatch_apply(concurrentCount, DISPATCH_APPLY_AUTO, ^(size_t worker) {
+        for (size_t band = worker; band < bandCount; band += concurrentCount) {
+            @autoreleasepool {
+                size_t rowStart = band * bandHeight;
+                size_t rowCount = MIN(bandHeight, destHeight - rowStart);
+                CGContextRef bandContext = CGBitmapContextCreate(destData + rowStart * bytesPerRow, destWidth, rowCount, kBitsPerComponent, bytesPerRow, colorspaceRef, bitmapInfo);
+                if (!bandContext) {
+                    continue;
+                }
+                CGContextSetInterpolationQuality(bandContext, kCGInterpolationHigh);
+                // Move to the destination coordinate, the band context clip the drawing outside its rows
+                CGContextTranslateCTM(bandContext, 0, -(CGFloat)(destHeight - rowStart - rowCount));
+                // Draw the source rows cover this band, with seem overlap on both sides
+                size_t sourceStart = (size_t)floor(rowStart / scaleY);
+                size_t sourceEnd = MIN(sourceHeight, (size_t)ceil((rowStart + rowCount) / scaleY) + sourceSeemOverlap);
+                sourceStart = sourceStart > sourceSeemOverlap ? sourceStart - sourceSeemOverlap : 0;
+                CGRect sourceTile = CGRectMake(0, sourceStart, sourceWidth, sourceEnd - sourceStart);
+                CGRect destTile = CGRectMake(0, destHeight - sourceEnd * scaleY, destWidth, (sourceEnd - sourceStart) * scaleY);
+                CGImageRef sourceTileImageRef = CGImageCreateWithImageInRect(sourceImageRef, sourceTile);
+                if (sourceTileImageRef) {
+                    CGContextDrawImage(bandContext, destTile, sourceTileImageRef);
+                    CGImageRelease(sourceTileImageRef);
+                }
+                CGContextRelease(bandContext);
+            }
+        }
+    });
+}
+
 #if SD_MAC
 @interface SDAnimatedImageRep (Private)
 /// This wrap the animated image frames for legacy animated image coder API (`encodedDataWithImage:`).
@@ -148,61 +199,26 @@ static const CGFloat kDestSeemOverlap = 2.0f;   // the numbers of pixels to over
     UIImage *animatedImage;
     
 #if SD_UIKIT || SD_WATCH
-    NSUInteger durations[frameCount];
-    for (size_t i = 0; i < frameCount; i++) {
-        durations[i] = frames[i].duration * 1000;
-    }
-    NSUInteger const gcd = gcdArray(frameCount, durations);
-    __block NSTimeInterval totalDuration = 0;
-    NSMutableArray<UIImage *> *animatedImages = [NSMutableArray arrayWithCapacity:frameCount];
-    [frames enumerateObjectsUsingBlock:^(SDImageFrame * _Nonnull frame, NSUInteger idx, BOOL * _Nonnull stop) {
-        UIImage *image = frame.image;
-        NSUInteger duration = frame.duration * 1000;
-        totalDuration += frame.duration;
-        NSUInteger repeatCount;
-        if (gcd) {
-            repeatCount = duration / gcd;
-        } else {
-            repeatCount = 1;
-        }
-        for (size_t i = 0; i < repeatCount; ++i) {
-            [animatedImages addObject:image];
+    // Store each distinct frame only once, the repeated frames for UIKit are built lazily
+    animatedImage = [[SDFrameSequenceImage alloc] initWithFrames:frames];
+    if (!animatedImage) {
+        NSTimeInterval totalDuration = 0;
+        for (SDImageFrame *frame in frames) {
+            totalDuration += frame.duration;
         }
-    }];
-    
-    animatedImage = [UIImage animatedImageWithImages:animatedImages duration:totalDuration];
+        animatedImage = [UIImage animatedImageWithImages:[SDFrameSequenceImage imagesWithFrames:frames] duration:totalDuration];
+    }
     
 #else
     
-    NSMutableData *imageData = [NSMutableData data];
-    CFStringRef imageUTType = [NSData sd_UTTypeFromImageFormat:SDImageFormatGIF];
-    // Create an image destination. GIF does not support EXIF image orientation
-    CGImageDestinationRef imageDestination = CGImageDestinationCreateWithData((__bridge CFMutableDataRef)imageData, imageUTType, frameCount, NULL);
-    if (!imageDestination) {
-        // Handle failure.
-        return nil;
-    }
-    
-    for (size_t i = 0; i < frameCount; i++) {
-        SDImageFrame *frame = frames[i];
-        NSTimeInterval frameDuration = frame.duration;
-        CGImageRef frameImageRef = frame.image.CGImage;
-        NSDictionary *frameProperties = @{(__bridge NSString *)kCGImagePropertyGIFDictionary : @{(__bridge NSString *)kCGImagePropertyGIFDelayTime : @(frameDuration)}};
-        CGImageDestinationAddImage(imageDestination, frameImageRef, (__bridge CFDictionaryRef)frameProperties);
-    }
-    // Finalize the destination.
-    if (CGImageDestinationFinalize(imageDestination) == NO) {
-        // Handle failure.
-        CFRelease(imageDestination);
+    // Serve the frames directly, GIF encoding happen only if someone ask for `sd_imageData`
+    SDAnimatedImageRep *imageRep = [[SDAnimatedImageRep alloc] initWithFrames:frames];
+    if (!imageRep) {
         return nil;
     }
-    CFRelease(imageDestination);
     CGFloat scale = MAX(frames.firstObject.image.scale, 1);
-    
-    SDAnimatedImageRep *imageRep = [[SDAnimatedImageRep alloc] initWithData:imageData];
     NSSize size = NSMakeSize(imageRep.pixelsWide / scale, imageRep.pixelsHigh / scale);
     imageRep.size = size;
-    imageRep.frames = frames; // Weak assign to avoid effect lazy semantic of NSBitmapImageRep
     animatedImage = [[NSImage alloc] initWithSize:size];
     [animatedImage addRepresentation:imageRep];
 #endif
@@ -219,6 +235,13 @@ static const CGFloat kDestSeemOverlap = 2.0f;   // the numbers of pixels to over
     NSUInteger frameCount = 0;
     
 #if SD_UIKIT || SD_WATCH
+    // Check the distinct frames firstly
+    if ([animatedImage isKindOfClass:[SDFrameSequenceImage class]]) {
+        NSArray<SDImageFrame *> *sequenceFrames = ((SDFrameSequenceImage *)animatedImage).frames;
+        if (sequenceFrames.count > 0) {
+            return sequenceFrames;
+        }
+    }
     NSArray<UIImage *> *animatedImages = animatedImage.images;
     frameCount = animatedImages.count;
     if (frameCount == 0) {
@@ -804,57 +827,63 @@ static const CGFloat kDestSeemOverlap = 2.0f;   // the numbers of pixels to over
         }
         CGContextSetInterpolationQuality(destContext, kCGInterpolationHigh);
         
-        // Now define the size of the rectangle to be used for the
-        // incremental bits from the input image to the output image.
-        // we use a source tile width equal to the width of the source
-        // image due to the way that iOS retrieves image data from disk.
-        // iOS must decode an image from disk in full width 'bands', even
-        // if current graphics context is clipped to a subrect within that
-        // band. Therefore we fully utilize all of the pixel data that results
-        // from a decoding operation by anchoring our tile size to the full
-        // width of the input image.
-        CGRect sourceTile = CGRectZero;
-        sourceTile.size.width = sourceResolution.width;
-        // The source tile height is dynamic. Since we specified the size
-        // of the source tile in MB, see how many rows of pixels high it
-        // can be given the input image width.
-        sourceTile.size.height = MAX(1, (int)(tileTotalPixels / sourceTile.size.width));
-        sourceTile.origin.x = 0.0f;
-        // The output tile is the same proportions as the input tile, but
-        // scaled to image scale.
-        CGRect destTile;
-        destTile.size.width = destResolution.width;
-        destTile.size.height = sourceTile.size.height * imageScale;
-        destTile.origin.x = 0.0f;
-        // The source seem overlap is proportionate to the destination seem overlap.
-        // this is the amount of pixels to overlap each tile as we assemble the output image.
-        float sourceSeemOverlap = (int)((kDestSeemOverlap/destResolution.height)*sourceResolution.height);
-        CGImageRef sourceTileImageRef;
-        // calculate the number of read/write operations required to assemble the
-        // output image.
-        int iterations = (int)( sourceResolution.height / sourceTile.size.height );
-        // If tile height doesn't divide the image height evenly, add another iteration
-        // to account for the remaining pixels.
-        int remainder = (int)sourceResolution.height % (int)sourceTile.size.height;
-        if(remainder) {
-            iterations++;
-        }
-        // Add seem overlaps to the tiles, but save the original tile height for y coordinate calculations.
-        float sourceTileHeightMinusOverlap = sourceTile.size.height;
-        sourceTile.size.height += sourceSeemOverlap;
-        destTile.size.height += kDestSeemOverlap;
-        for( int y = 0; y < iterations; ++y ) {
-            sourceTile.origin.y = y * sourceTileHeightMinusOverlap + sourceSeemOverlap;
-            destTile.origin.y = destResolution.height - (( y + 1 ) * sourceTileHeightMinusOverlap * imageScale + kDestSeemOverlap);
-            sourceTileImageRef = CGImageCreateWithImageInRect( sourceImageRef, sourceTile );
-            if( y == iterations - 1 && remainder ) {
-                float dify = destTile.size.height;
-                destTile.size.height = CGImageGetHeight( sourceTileImageRef ) * imageScale + kDestSeemOverlap;
-                dify -= destTile.size.height;
-                destTile.origin.y = MIN(0, destTile.origin.y + dify);
+        NSUInteger concurrentCount = self.defaultScaleDownConcurrentCount;
+        if (concurrentCount > 1) {
+            // Each worker hold one source tile, keep the peak memory same as serial
+            SDCGContextDrawScaledDownBandsConcurrently(destContext, sourceImageRef, destResolution, tileTotalPixels / concurrentCount, concurrentCount);
+        } else {
+            // Now define the size of the rectangle to be used for the
+            // incremental bits from the input image to the output image.
+            // we use a source tile width equal to the width of the source
+            // image due to the way that iOS retrieves image data from disk.
+            // iOS must decode an image from disk in full width 'bands', even
+            // if current graphics context is clipped to a subrect within that
+            // band. Therefore we fully utilize all of the pixel data that results
+            // from a decoding operation by anchoring our tile size to the full
+            // width of the input image.
+            CGRect sourceTile = CGRectZero;
+            sourceTile.size.width = sourceResolution.width;
+            // The source tile height is dynamic. Since we specified the size
+            // of the source tile in MB, see how many rows of pixels high it
+            // can be given the input image width.
+            sourceTile.size.height = MAX(1, (int)(tileTotalPixels / sourceTile.size.width));
+            sourceTile.origin.x = 0.0f;
+            // The output tile is the same proportions as the input tile, but
+            // scaled to image scale.
+            CGRect destTile;
+            destTile.size.width = destResolution.width;
+            destTile.size.height = sourceTile.size.height * imageScale;
+            destTile.origin.x = 0.0f;
+            // The source seem overlap is proportionate to the destination seem overlap.
+            // this is the amount of pixels to overlap each tile as we assemble the output image.
+            float sourceSeemOverlap = (int)((kDestSeemOverlap/destResolution.height)*sourceResolution.height);
+            CGImageRef sourceTileImageRef;
+            // calculate the number of read/write operations required to assemble the
+            // output image.
+            int iterations = (int)( sourceResolution.height / sourceTile.size.height );
+            // If tile height doesn't divide the image height evenly, add another iteration
+            // to account for the remaining pixels.
+            int remainder = (int)sourceResolution.height % (int)sourceTile.size.height;
+            if(remainder) {
+                iterations++;
+            }
+            // Add seem overlaps to the tiles, but save the original tile height for y coordinate calculations.
+            float sourceTileHeightMinusOverlap = sourceTile.size.height;
+            sourceTile.size.height += sourceSeemOverlap;
+            destTile.size.height += kDestSeemOverlap;
+            for( int y = 0; y < iterations; ++y ) {
+                sourceTile.origin.y = y * sourceTileHeightMinusOverlap + sourceSeemOverlap;
+                destTile.origin.y = destResolution.height - (( y + 1 ) * sourceTileHeightMinusOverlap * imageScale + kDestSeemOverlap);
+                sourceTileImageRef = CGImageCreateWithImageInRect( sourceImageRef, sourceTile );
+                if( y == iterations - 1 && remainder ) {
+                    float dify = destTile.size.height;
+                    destTile.size.height = CGImageGetHeight( sourceTileImageRef ) * imageScale + kDestSeemOverlap;
+                    dify -= destTile.size.height;
+                    destTile.origin.y = MIN(0, destTile.origin.y + dify);
+                }
+                CGContextDrawImage( destContext, destTile, sourceTileImageRef );
+                CGImageRelease( sourceTileImageRef );
             }
-            CGContextDrawImage( destContext, destTile, sourceTileImageRef );
-            CGImageRelease( sourceTileImageRef );
         }
         
         CGImageRef destImageRef = CGBitmapContextCreateImage(destContext);
@@ -882,6 +911,14 @@ static const CGFloat kDestSeemOverlap = 2.0f;   // the numbers of pixels to over
     kDefaultDecodeSolution = defaultDecodeSolution;
 }
 
++ (NSUInteger)defaultScaleDownConcurrentCount {
+    return kDefaultScaleDownConcurrentCount;
+}
+
++ (void)setDefaultScaleDownConcurrentCount:(NSUInteger)defaultScaleDownConcurrentCount {
+    kDefaultScaleDownConcurrentCount = MAX(defaultScaleDownConcurrentCount, 1);
+}
+
 + (NSUInteger)defaultScaleDownLimitBytes {
     return kDestImageLimitBytes;
 }
@@ -1086,27 +1123,4 @@ static inline CGAffineTransform SDCGContextTransformFromOrientation(CGImagePrope
     return transform;
 }
 
-#if SD_UIKIT || SD_WATCH
-static NSUInteger gcd(NSUInteger a, NSUInteger b) {
-    NSUInteger c;
-    while (a != 0) {
-        c = a;
-        a = b % a;
-        b = c;
-    }
-    return b;
-}
-
-static NSUInteger gcdArray(size_t const count, NSUInteger const * const values) {
-    if (count == 0) {
-        return 0;
-    }
-    NSUInteger result = values[0];
-    for (size_t i = 1; i < count; ++i) {
-        result = gcd(values[i], result);
-    }
-    return result;
-}
-#endif
-
 @end
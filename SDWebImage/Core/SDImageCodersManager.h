@@ -28,8 +28,9 @@
  Conformance is important because that way, they will implement `canDecodeFromData` or `canEncodeToFormat`
  Those methods are called on each coder in the array (using the priority order) until one of them returns YES.
  That means that coder can decode that data / encode to that format
+ For region decoding, only the coders conform to `SDRegionImageCoder` are asked.
  */
-@interface SDImageCodersManager : NSObject <SDImageCoder>
+@interface SDImageCodersManager : NSObject <SDImageCoder, SDRegionImageCoder>
 
 /**
  Returns the global shared coders manager instance.
@@ -114,6 +114,22 @@
     return image;
 }
 
+- (UIImage *)decodedImageWithData:(NSData *)data region:(CGRect)region pixelSize:(CGSize)pixelSize options:(nullable SDImageCoderOptions *)options {
+    if (!data) {
+        return nil;
+    }
+    UIImage *image;
+    NSArray<id<SDImageCoder>> *coders = self.coders;
+    for (id<SDImageCoder> coder in coders.reverseObjectEnumerator) {
+        if ([coder conformsToProtocol:@protocol(SDRegionImageCoder)] && [coder canDecodeFromData:data]) {
+            image = [(id<SDRegionImageCoder>)coder decodedImageWithData:data region:region pixelSize:pixelSize options:options];
+            break;
+        }
+    }
+    
+    return image;
+}
+
 - (NSData *)encodedDataWithImage:(UIImage *)image format:(SDImageFormat)format options:(nullable SDImageCoderOptions *)options {
     if (!image) {
         return nil;
@@ -13,6 +13,7 @@
 #import "NSData+ImageContentType.h"
 #import "SDImageCoderHelper.h"
 #import "SDAnimatedImageRep.h"
+#import "SDImageSourceCache.h"
 #import "UIImage+ForceDecode.h"
 #import "SDInternalMacros.h"
 
@@ -263,7 +264,7 @@ static BOOL SDImageIOPNGPluginBuggyNeedWorkaround(void) {
 @interface SDImageIOCoderFrame : NSObject
 
 @property (nonatomic, assign) NSUInteger index; // Frame index (zero based)
-@property (nonatomic, assign) NSTimeInterval duration; // Frame duration in seconds
+@property (nonatomic, assign) NSTimeInterval duration; // Frame duration in seconds, negative means not scanned yet
 
 @end
 
@@ -273,8 +274,10 @@ static BOOL SDImageIOPNGPluginBuggyNeedWorkaround(void) {
 @implementation SDImageIOAnimatedCoder {
     size_t _width, _height;
     CGImageSourceRef _imageSource;
+    BOOL _sharedSource; // The image source is shared by `SDImageSourceCache`
     BOOL _incremental;
     SD_LOCK_DECLARE(_lock); // Lock only apply for incremental animation decoding
+    SD_LOCK_DECLARE(_durationLock); // Lock for the frame duration which is scanned lazily
     NSData *_imageData;
     CGFloat _scale;
     NSUInteger _loopCount;
@@ -446,6 +449,10 @@ static BOOL SDImageIOPNGPluginBuggyNeedWorkaround(void) {
 }
 
 + (UIImage *)createFrameAtIndex:(NSUInteger)index source:(CGImageSourceRef)source scale:(CGFloat)scale preserveAspectRatio:(BOOL)preserveAspectRatio thumbnailSize:(CGSize)thumbnailSize lazyDecode:(BOOL)lazyDecode animatedImage:(BOOL)animatedImage decodeToHDR:(BOOL)decodeToHDR {
+    return [self createFrameAtIndex:index source:source scale:scale preserveAspectRatio:preserveAspectRatio thumbnailSize:thumbnailSize lazyDecode:lazyDecode animatedImage:animatedImage decodeToHDR:decodeToHDR sharedSource:NO];
+}
+
++ (UIImage *)createFrameAtIndex:(NSUInteger)index source:(CGImageSourceRef)source scale:(CGFloat)scale preserveAspectRatio:(BOOL)preserveAspectRatio thumbnailSize:(CGSize)thumbnailSize lazyDecode:(BOOL)lazyDecode animatedImage:(BOOL)animatedImage decodeToHDR:(BOOL)decodeToHDR sharedSource:(BOOL)sharedSource {
     // `animatedImage` means called from `SDAnimatedImageProvider.animatedImageFrameAtIndex`
     NSDictionary *options;
     if (animatedImage) {
@@ -484,6 +491,10 @@ static BOOL SDImageIOPNGPluginBuggyNeedWorkaround(void) {
             decodingOptions[(__bridge NSString *)kCGImageSourceDecodeRequest] = (__bridge NSString *)kCGImageSourceDecodeToSDR;
         }
     }
+    if (sharedSource) {
+        // The shared source outlive this image, don't let ImageIO keep the decoded pixels on it
+        decodingOptions[(__bridge NSString *)kCGImageSourceShouldCache] = @(NO);
+    }
   
     CGImageRef imageRef;
     BOOL createFullImage = thumbnailSize.width == 0 || thumbnailSize.height == 0 || pixelWidth == 0 || pixelHeight == 0 || (pixelWidth <= thumbnailSize.width && pixelHeight <= thumbnailSize.height);
@@ -660,15 +671,9 @@ static BOOL SDImageIOPNGPluginBuggyNeedWorkaround(void) {
         typeIdentifierHint = nil;
     }
     
-    NSDictionary *creatingOptions = nil;
-    if (typeIdentifierHint) {
-        creatingOptions = @{(__bridge NSString *)kCGImageSourceTypeIdentifierHint : typeIdentifierHint};
-    }
-    CGImageSourceRef source = CGImageSourceCreateWithData((__bridge CFDataRef)data, (__bridge CFDictionaryRef)creatingOptions);
-    if (!source) {
-        // Try again without UTType hint, the call site from user may provide the wrong UTType
-        source = CGImageSourceCreateWithData((__bridge CFDataRef)data, nil);
-    }
+    // Reuse the parsed image source for the same image, like decoding different thumbnail sizes
+    BOOL sharedSource = NO;
+    CGImageSourceRef source = [SDImageSourceCache.sharedCache copyImageSourceWithData:data forKey:options[SDImageCoderDecodeImageSourceCacheKey] typeIdentifierHint:typeIdentifierHint cached:&sharedSource];
     if (!source) {
         return nil;
     }
@@ -692,12 +697,12 @@ static BOOL SDImageIOPNGPluginBuggyNeedWorkaround(void) {
     
     BOOL decodeFirstFrame = [options[SDImageCoderDecodeFirstFrameOnly] boolValue];
     if (decodeFirstFrame || frameCount <= 1) {
-        animatedImage = [self.class createFrameAtIndex:0 source:source scale:scale preserveAspectRatio:preserveAspectRatio thumbnailSize:thumbnailSize lazyDecode:lazyDecode animatedImage:NO decodeToHDR:decodeToHDR];
+        animatedImage = [self.class createFrameAtIndex:0 source:source scale:scale preserveAspectRatio:preserveAspectRatio thumbnailSize:thumbnailSize lazyDecode:lazyDecode animatedImage:NO decodeToHDR:decodeToHDR sharedSource:sharedSource];
     } else {
         NSMutableArray<SDImageFrame *> *frames = [NSMutableArray arrayWithCapacity:frameCount];
         
         for (size_t i = 0; i < frameCount; i++) {
-            UIImage *image = [self.class createFrameAtIndex:i source:source scale:scale preserveAspectRatio:preserveAspectRatio thumbnailSize:thumbnailSize lazyDecode:lazyDecode animatedImage:NO decodeToHDR:decodeToHDR];
+            UIImage *image = [self.class createFrameAtIndex:i source:source scale:scale preserveAspectRatio:preserveAspectRatio thumbnailSize:thumbnailSize lazyDecode:lazyDecode animatedImage:NO decodeToHDR:decodeToHDR sharedSource:sharedSource];
             if (!image) {
                 continue;
             }
@@ -769,6 +774,7 @@ static BOOL SDImageIOPNGPluginBuggyNeedWorkaround(void) {
         _decodeToHDR = [options[SDImageCoderDecodeToHDR] boolValue];
         
         SD_LOCK_INIT(_lock);
+        SD_LOCK_INIT(_durationLock);
 #if SD_UIKIT
         [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(didReceiveMemoryWarning:) name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
 #endif
@@ -997,7 +1003,8 @@ static BOOL SDImageIOPNGPluginBuggyNeedWorkaround(void) {
     }
     self = [super init];
     if (self) {
-        CGImageSourceRef imageSource = CGImageSourceCreateWithData((__bridge CFDataRef)data, NULL);
+        BOOL sharedSource = NO;
+        CGImageSourceRef imageSource = [SDImageSourceCache.sharedCache copyImageSourceWithData:data forKey:options[SDImageCoderDecodeImageSourceCacheKey] typeIdentifierHint:nil cached:&sharedSource];
         if (!imageSource) {
             return nil;
         }
@@ -1057,7 +1064,11 @@ static BOOL SDImageIOPNGPluginBuggyNeedWorkaround(void) {
         _decodeToHDR = [options[SDImageCoderDecodeToHDR] boolValue];
         
         _imageSource = imageSource;
+        _sharedSource = sharedSource;
         _imageData = data;
+        SD_LOCK_INIT(_durationLock);
+        // The first frame is available now, the rest frame durations are scanned in background
+        [self scanFrameDurationsInBackground];
 #if SD_UIKIT
         [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(didReceiveMemoryWarning:) name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
 #endif
@@ -1077,7 +1088,8 @@ static BOOL SDImageIOPNGPluginBuggyNeedWorkaround(void) {
     for (size_t i = 0; i < frameCount; i++) {
         SDImageIOCoderFrame *frame = [[SDImageIOCoderFrame alloc] init];
         frame.index = i;
-        frame.duration = [self.class frameDurationAtIndex:i source:imageSource];
+        // Reading the duration need to copy the frame properties, which is slow for large frame count, scan it lazily
+        frame.duration = -1;
         [frames addObject:frame];
     }
     if (frames.count != frameCount) {
@@ -1091,6 +1103,38 @@ static BOOL SDImageIOPNGPluginBuggyNeedWorkaround(void) {
     return YES;
 }
 
+- (NSTimeInterval)durationOfFrame:(SDImageIOCoderFrame *)frame {
+    SD_LOCK(_durationLock);
+    NSTimeInterval duration = frame.duration;
+    SD_UNLOCK(_durationLock);
+    if (duration < 0) {
+        // Not scanned yet, the ImageIO image source is thread-safe
+        duration = [self.class frameDurationAtIndex:frame.index source:_imageSource];
+        SD_LOCK(_durationLock);
+        frame.duration = duration;
+        SD_UNLOCK(_durationLock);
+    }
+    return duration;
+}
+
+- (void)scanFrameDurationsInBackground {
+    NSArray<SDImageIOCoderFrame *> *frames = _frames;
+    if (frames.count <= 1) {
+        return;
+    }
+    @weakify(self);
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        for (SDImageIOCoderFrame *frame in frames) {
+            @strongify(self);
+            if (!self) {
+                // Coder is released, stop scanning
+                return;
+            }
+            [self durationOfFrame:frame];
+        }
+    });
+}
+
 - (NSData *)animatedImageData {
     return _imageData;
 }
@@ -1113,13 +1157,13 @@ static BOOL SDImageIOPNGPluginBuggyNeedWorkaround(void) {
             SD_UNLOCK(_lock);
             return 0;
         }
-        duration = _frames[index].duration;
+        duration = [self durationOfFrame:_frames[index]];
         SD_UNLOCK(_lock);
     } else {
         if (index >= _frames.count) {
             return 0;
         }
-        duration = _frames[index].duration;
+        duration = [self durationOfFrame:_frames[index]];
     }
     return duration;
 }
@@ -1145,8 +1189,38 @@ static BOOL SDImageIOPNGPluginBuggyNeedWorkaround(void) {
     return image;
 }
 
+- (UIImage *)animatedImageFrameAtIndex:(NSUInteger)index thumbnailSize:(CGSize)thumbnailSize {
+    if (thumbnailSize.width <= 0 || thumbnailSize.height <= 0) {
+        return [self animatedImageFrameAtIndex:index];
+    }
+    // Use the smaller one if the coder already has a thumbnail size
+    if (_thumbnailSize.width > 0 && _thumbnailSize.height > 0 && _thumbnailSize.width * _thumbnailSize.height < thumbnailSize.width * thumbnailSize.height) {
+        thumbnailSize = _thumbnailSize;
+    }
+    UIImage *image;
+    if (_incremental) {
+        SD_LOCK(_lock);
+        if (index >= _frames.count) {
+            SD_UNLOCK(_lock);
+            return nil;
+        }
+        image = [self safeAnimatedImageFrameAtIndex:index thumbnailSize:thumbnailSize];
+        SD_UNLOCK(_lock);
+    } else {
+        if (index >= _frames.count) {
+            return nil;
+        }
+        image = [self safeAnimatedImageFrameAtIndex:index thumbnailSize:thumbnailSize];
+    }
+    return image;
+}
+
 - (UIImage *)safeAnimatedImageFrameAtIndex:(NSUInteger)index {
-    UIImage *image = [self.class createFrameAtIndex:index source:_imageSource scale:_scale preserveAspectRatio:_preserveAspectRatio thumbnailSize:_thumbnailSize lazyDecode:_lazyDecode animatedImage:YES decodeToHDR:!_incremental || _finished ? _decodeToHDR : NO];
+    return [self safeAnimatedImageFrameAtIndex:index thumbnailSize:_thumbnailSize];
+}
+
+- (UIImage *)safeAnimatedImageFrameAtIndex:(NSUInteger)index thumbnailSize:(CGSize)thumbnailSize {
+    UIImage *image = [self.class createFrameAtIndex:index source:_imageSource scale:_scale preserveAspectRatio:_preserveAspectRatio thumbnailSize:thumbnailSize lazyDecode:_lazyDecode animatedImage:YES decodeToHDR:!_incremental || _finished ? _decodeToHDR : NO sharedSource:_sharedSource];
     if (!image) {
         return nil;
     }
@@ -22,8 +22,11 @@
  Decode(Hardware): !Simulator && ((iOS 11 && A9Chip) || (macOS 10.13 && 6thGenerationIntelCPU))
  Encode(Software): macOS 10.13
  Encode(Hardware): !Simulator && ((iOS 11 && A10FusionChip) || (macOS 10.13 && 6thGenerationIntelCPU))
+ 
+ Region
+ This coder supports region decoding (see `SDRegionImageCoder`). The subsampled level image is reused for the same data instance, while the parsed image source is reused only through `SDImageSourceCache` (which is disabled by default) when the `SDImageCoderDecodeImageSourceCacheKey` option is provided. When the target pixel size is smaller than the region, the image is subsampled at the power of two level of detail first, so the tiles of the same zoom level share the same decoding cost.
  */
-@interface SDImageIOCoder : NSObject <SDProgressiveImageCoder>
+@interface SDImageIOCoder : NSObject <SDProgressiveImageCoder, SDRegionImageCoder>
 
 @property (nonatomic, class, readonly, nonnull) SDImageIOCoder *sharedCoder;
 
@@ -10,7 +10,9 @@
 #import "SDImageCoderHelper.h"
 #import "NSImage+Compatibility.h"
 #import "UIImage+Metadata.h"
+#import "UIImage+ForceDecode.h"
 #import "SDImageGraphics.h"
+#import "SDImageSourceCache.h"
 #import "SDImageIOAnimatedCoderInternal.h"
 
 #import <ImageIO/ImageIO.h>
@@ -24,6 +26,17 @@ static NSString * kSDCGImageDestinationEncodeToSDR = @"kCGImageDestinationEncode
 static NSString * kSDCGImageDestinationEncodeToISOHDR = @"kCGImageDestinationEncodeToISOHDR";
 static NSString * kSDCGImageDestinationEncodeToISOGainmap = @"kCGImageDestinationEncodeToISOGainmap";
 
+// The subsampled level image of the region decoding, shared by the tiles in the same level
+@interface SDImageIORegionLevelImage : NSObject
+
+// Retain the data, so the data pointer in cache key is unique during caching
+@property (nonatomic, strong) NSData *data;
+@property (nonatomic, strong) id image; // CGImageRef
+
+@end
+
+@implementation SDImageIORegionLevelImage
+@end
 
 @implementation SDImageIOCoder {
     size_t _width, _height;
@@ -216,15 +229,9 @@ static NSString * kSDCGImageDestinationEncodeToISOGainmap = @"kCGImageDestinatio
         typeIdentifierHint = nil;
     }
     
-    NSDictionary *creatingOptions = nil;
-    if (typeIdentifierHint) {
-        creatingOptions = @{(__bridge NSString *)kCGImageSourceTypeIdentifierHint : typeIdentifierHint};
-    }
-    CGImageSourceRef source = CGImageSourceCreateWithData((__bridge CFDataRef)data, (__bridge CFDictionaryRef)creatingOptions);
-    if (!source) {
-        // Try again without UTType hint, the call site from user may provide the wrong UTType
-        source = CGImageSourceCreateWithData((__bridge CFDataRef)data, nil);
-    }
+    // Reuse the parsed image source for the same image, like decoding different thumbnail sizes
+    BOOL sharedSource = NO;
+    CGImageSourceRef source = [SDImageSourceCache.sharedCache copyImageSourceWithData:data forKey:options[SDImageCoderDecodeImageSourceCacheKey] typeIdentifierHint:typeIdentifierHint cached:&sharedSource];
     if (!source) {
         return nil;
     }
@@ -232,7 +239,7 @@ static NSString * kSDCGImageDestinationEncodeToISOGainmap = @"kCGImageDestinatio
     CFStringRef uttype = CGImageSourceGetType(source);
     SDImageFormat imageFormat = [NSData sd_imageFormatFromUTType:uttype];
     
-    UIImage *image = [SDImageIOAnimatedCoder createFrameAtIndex:0 source:source scale:scale preserveAspectRatio:preserveAspectRatio thumbnailSize:thumbnailSize lazyDecode:lazyDecode animatedImage:NO decodeToHDR:decodeToHDR];
+    UIImage *image = [SDImageIOAnimatedCoder createFrameAtIndex:0 source:source scale:scale preserveAspectRatio:preserveAspectRatio thumbnailSize:thumbnailSize lazyDecode:lazyDecode animatedImage:NO decodeToHDR:decodeToHDR sharedSource:sharedSource];
     CFRelease(source);
     
     image.sd_imageFormat = imageFormat;
@@ -340,6 +347,128 @@ static NSString * kSDCGImageDestinationEncodeToISOGainmap = @"kCGImageDestinatio
     return image;
 }
 
+#pragma mark - Region Decode
++ (NSCache<NSString *, SDImageIORegionLevelImage *> *)regionLevelImageCache {
+    static NSCache *cache;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        cache = [[NSCache alloc] init];
+        // The level image is decoded, limit the bitmap bytes
+        cache.totalCostLimit = 64 * 1024 * 1024;
+    });
+    return cache;
+}
+
+- (UIImage *)decodedImageWithData:(NSData *)data region:(CGRect)region pixelSize:(CGSize)pixelSize options:(nullable SDImageCoderOptions *)options {
+    if (!data) {
+        return nil;
+    }
+    CGFloat scale = 1;
+    NSNumber *scaleFactor = options[SDImageCoderDecodeScaleFactor];
+    if (scaleFactor != nil) {
+        scale = MAX([scaleFactor doubleValue], 1);
+    }
+    
+    CGImageSourceRef source = [SDImageSourceCache.sharedCache copyImageSourceWithData:data forKey:options[SDImageCoderDecodeImageSourceCacheKey] typeIdentifierHint:nil cached:NULL];
+    if (!source) {
+        return nil;
+    }
+    NSDictionary *properties = (__bridge_transfer NSDictionary *)CGImageSourceCopyPropertiesAtIndex(source, 0, NULL);
+    double pixelWidth = [properties[(__bridge NSString *)kCGImagePropertyPixelWidth] doubleValue];
+    double pixelHeight = [properties[(__bridge NSString *)kCGImagePropertyPixelHeight] doubleValue];
+    CGImagePropertyOrientation exifOrientation = kCGImagePropertyOrientationUp;
+    NSNumber *exifOrientationValue = properties[(__bridge NSString *)kCGImagePropertyOrientation];
+    if (exifOrientationValue != nil) {
+        exifOrientation = [exifOrientationValue unsignedIntValue];
+    }
+    region = CGRectIntegral(CGRectIntersection(region, CGRectMake(0, 0, pixelWidth, pixelHeight)));
+    if (CGRectIsEmpty(region)) {
+        CFRelease(source);
+        return nil;
+    }
+    if (pixelSize.width <= 0 || pixelSize.height <= 0) {
+        pixelSize = region.size;
+    }
+    pixelSize = CGSizeMake(ceil(pixelSize.width), ceil(pixelSize.height));
+    
+    // Pick the power of two level of detail, which is not smaller than the target pixel size
+    CGFloat levelScale = MAX(pixelSize.width / region.size.width, pixelSize.height / region.size.height);
+    CGFloat level = levelScale >= 1 ? 1 : pow(2, ceil(log2(levelScale)));
+    CGImageRef levelImageRef;
+    if (level < 1) {
+        // The tiles in the same level crop from the same subsampled image, decode it only once
+        NSCache<NSString *, SDImageIORegionLevelImage *> *levelImageCache = [self.class regionLevelImageCache];
+        NSString *levelKey = [NSString stringWithFormat:@"%p-%lu-%g", data, (unsigned long)data.length, level];
+        SDImageIORegionLevelImage *levelImage = [levelImageCache objectForKey:levelKey];
+        if (levelImage && levelImage.data == data) {
+            levelImageRef = CGImageRetain((__bridge CGImageRef)levelImage.image);
+        } else {
+            // Subsample the whole image, JPEG and HEIF can decode it much faster than full size
+            NSDictionary *thumbnailOptions = @{(__bridge NSString *)kCGImageSourceCreateThumbnailFromImageAlways : @(YES),
+                                               (__bridge NSString *)kCGImageSourceThumbnailMaxPixelSize : @(ceil(MAX(pixelWidth, pixelHeight) * level)),
+                                               (__bridge NSString *)kCGImageSourceCreateThumbnailWithTransform : @(NO),
+                                               (__bridge NSString *)kCGImageSourceShouldCache : @(NO)};
+            levelImageRef = CGImageSourceCreateThumbnailAtIndex(source, 0, (__bridge CFDictionaryRef)thumbnailOptions);
+            if (levelImageRef) {
+                levelImage = [SDImageIORegionLevelImage new];
+                levelImage.data = data;
+                levelImage.image = (__bridge id)levelImageRef;
+                NSUInteger cost = CGImageGetBytesPerRow(levelImageRef) * CGImageGetHeight(levelImageRef);
+                [levelImageCache setObject:levelImage forKey:levelKey cost:cost];
+            }
+        }
+    } else {
+        // Lazy decoding, cropping only decode the bands which contains the region. Don't let ImageIO keep the full size bitmap on the source.
+        NSDictionary *imageOptions = @{(__bridge NSString *)kCGImageSourceShouldCacheImmediately : @(NO),
+                                       (__bridge NSString *)kCGImageSourceShouldCache : @(NO)};
+        levelImageRef = CGImageSourceCreateImageAtIndex(source, 0, (__bridge CFDictionaryRef)imageOptions);
+    }
+    CFStringRef uttype = CGImageSourceGetType(source);
+    SDImageFormat imageFormat = [NSData sd_imageFormatFromUTType:uttype];
+    CFRelease(source);
+    if (!levelImageRef) {
+        return nil;
+    }
+    
+    // Map the region to level image
+    CGFloat levelScaleX = CGImageGetWidth(levelImageRef) / pixelWidth;
+    CGFloat levelScaleY = CGImageGetHeight(levelImageRef) / pixelHeight;
+    CGRect levelRegion = CGRectIntegral(CGRectMake(region.origin.x * levelScaleX, region.origin.y * levelScaleY, region.size.width * levelScaleX, region.size.height * levelScaleY));
+    CGImageRef tileImageRef = CGImageCreateWithImageInRect(levelImageRef, levelRegion);
+    CGImageRelease(levelImageRef);
+    if (!tileImageRef) {
+        return nil;
+    }
+    
+    // Draw into the target pixel size, which also force decode the tile
+    BOOL hasAlpha = [SDImageCoderHelper CGImageContainsAlpha:tileImageRef];
+    CGBitmapInfo bitmapInfo = [SDImageCoderHelper preferredPixelFormat:hasAlpha].bitmapInfo;
+    CGContextRef context = CGBitmapContextCreate(NULL, pixelSize.width, pixelSize.height, 8, 0, [SDImageCoderHelper colorSpaceGetDeviceRGB], bitmapInfo);
+    if (!context) {
+        CGImageRelease(tileImageRef);
+        return nil;
+    }
+    CGContextSetInterpolationQuality(context, kCGInterpolationHigh);
+    CGContextDrawImage(context, CGRectMake(0, 0, pixelSize.width, pixelSize.height), tileImageRef);
+    CGImageRelease(tileImageRef);
+    CGImageRef imageRef = CGBitmapContextCreateImage(context);
+    CGContextRelease(context);
+    if (!imageRef) {
+        return nil;
+    }
+    
+#if SD_UIKIT || SD_WATCH
+    UIImageOrientation imageOrientation = [SDImageCoderHelper imageOrientationFromEXIFOrientation:exifOrientation];
+    UIImage *image = [[UIImage alloc] initWithCGImage:imageRef scale:scale orientation:imageOrientation];
+#else
+    UIImage *image = [[UIImage alloc] initWithCGImage:imageRef scale:scale orientation:exifOrientation];
+#endif
+    CGImageRelease(imageRef);
+    image.sd_imageFormat = imageFormat;
+    image.sd_isDecoded = YES;
+    return image;
+}
+
 #pragma mark - Encode
 - (BOOL)canEncodeToFormat:(SDImageFormat)format {
     return YES;
@@ -30,6 +30,17 @@ void SDImageLoaderSetProgressiveCoder(id<SDWebImageOperation> operation, id<SDPr
     objc_setAssociatedObject(operation, SDImageLoaderProgressiveCoderKey, progressiveCoder, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
 }
 
+static void * SDImageLoaderProgressiveDataLengthKey = &SDImageLoaderProgressiveDataLengthKey;
+
+// The data length which has been passed to progressive coder, for coder which consume only the new bytes
+static NSUInteger SDImageLoaderGetProgressiveDataLength(id<SDWebImageOperation> operation) {
+    return [objc_getAssociatedObject(operation, SDImageLoaderProgressiveDataLengthKey) unsignedIntegerValue];
+}
+
+static void SDImageLoaderSetProgressiveDataLength(id<SDWebImageOperation> operation, NSUInteger length) {
+    objc_setAssociatedObject(operation, SDImageLoaderProgressiveDataLengthKey, @(length), OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+}
+
 UIImage * _Nullable SDImageLoaderDecodeImageData(NSData * _Nonnull imageData, NSURL * _Nonnull imageURL, SDWebImageOptions options, SDWebImageContext * _Nullable context) {
     NSCParameterAssert(imageData);
     NSCParameterAssert(imageURL);
@@ -135,7 +146,20 @@ UIImage * _Nullable SDImageLoaderDecodeProgressiveImageData(NSData * _Nonnull im
         return nil;
     }
     
-    [progressiveCoder updateIncrementalData:imageData finished:finished];
+    if ([progressiveCoder respondsToSelector:@selector(appendIncrementalData:finished:)]) {
+        NSUInteger length = SDImageLoaderGetProgressiveDataLength(operation);
+        if (length <= imageData.length) {
+            NSData *newData = [imageData subdataWithRange:NSMakeRange(length, imageData.length - length)];
+            [progressiveCoder appendIncrementalData:newData finished:finished];
+            SDImageLoaderSetProgressiveDataLength(operation, imageData.length);
+        } else {
+            // The data is not continuous with the previous one, fallback to update the whole data
+            [progressiveCoder updateIncrementalData:imageData finished:finished];
+            SDImageLoaderSetProgressiveDataLength(operation, imageData.length);
+        }
+    } else {
+        [progressiveCoder updateIncrementalData:imageData finished:finished];
+    }
     if (!decodeFirstFrame) {
         // check whether we should use `SDAnimatedImage`
         Class animatedImageClass = context[SDWebImageContextAnimatedImageClass];
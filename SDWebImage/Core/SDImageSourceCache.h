@@ -0,0 +1,66 @@
+/*
+* This file is part of the SDWebImage package.
+* (c) Olivier Poitrey <rs@dailymotion.com>
+*
+* For the full copyright and license information, please view the LICENSE
+* file that was distributed with this source code.
+*/
+
+#import <Foundation/Foundation.h>
+#import <ImageIO/ImageIO.h>
+#import "SDWebImageCompat.h"
+
+/**
+ A bounded cache of the parsed `CGImageSource`, keyed by the image cache key. Decoding the same image again (like a photo grid which ask for several thumbnail sizes of the same image, or the tiles of one huge image) reuse the parsed image source, instead of parsing the headers again.
+ The cache is disabled by default, set the `totalCostLimit` to enable it. The cost is the length of the encoded data, which is retained by the cached image source. The least recently used image source is evicted when exceeding the `totalCostLimit`, and all the image sources are removed when receiving memory warning (or memory pressure event on macOS).
+ The built-in `SDImageIOCoder` and `SDImageIOAnimatedCoder` (and its subclasses) use the shared cache for non-incremental decoding, when the `SDImageCoderDecodeImageSourceCacheKey` option is provided. `SDImageCache` and `SDImageLoader` provide the cache key automatically, and `SDImageCache` remove the cached image source when the image for the key is stored or removed. Clearing the disk of one `SDImageCache` only remove the image sources of the keys decoded by that cache.
+ @note The image created from the cached image source does not ask ImageIO to cache the decoded pixels (`kCGImageSourceShouldCache` is NO), so the cached image source only keep the encoded data and the parsed headers.
+ */
+@interface SDImageSourceCache : NSObject
+
+/// The shared image source cache
+@property (nonatomic, class, readonly, nonnull) SDImageSourceCache *sharedCache;
+
+/// The maximum total length of the encoded data retained by the cached image sources. Defaults to 0.
+/// `0` means disable the cache, each decoding create its own image source.
+@property (nonatomic, assign) NSUInteger totalCostLimit;
+
+/// The total length of the encoded data retained by the cached image sources
+@property (nonatomic, assign, readonly) NSUInteger totalCost;
+
+/// The number of the image sources currently cached
+@property (nonatomic, assign, readonly) NSUInteger count;
+
+/// The number of the lookups which reuse the cached image source
+@property (nonatomic, assign, readonly) NSUInteger hitCount;
+
+/// The number of the lookups which create a new image source
+@property (nonatomic, assign, readonly) NSUInteger missCount;
+
+/// The hit rate in [0, 1], which is `hitCount / (hitCount + missCount)`. 0 when there is no lookup.
+@property (nonatomic, assign, readonly) double hitRate;
+
+/// Return the cached image source for the key, or create and cache a new one.
+/// @param data The image data
+/// @param key The image cache key. If nil, or the cache is disabled, or the data is larger than `totalCostLimit`, a new image source is created without caching.
+/// @param typeIdentifierHint The UTType hint to create the image source, only used when creating a new one
+/// @param cached On return, whether the image source is shared by the cache. Pass NULL if you don't care.
+/// @return The retained image source, caller should release it. Or NULL if the image source can not be created.
+/// @note A cached image source whose data is not equal to the provided data (compared by bytes) is treated as stale and replaced.
+- (nullable CGImageSourceRef)copyImageSourceWithData:(nonnull NSData *)data forKey:(nullable NSString *)key typeIdentifierHint:(nullable NSString *)typeIdentifierHint cached:(nullable BOOL *)cached CF_RETURNS_RETAINED;
+
+/// Remove the cached image source for the key
+/// @param key The image cache key
+- (void)removeImageSourceForKey:(nullable NSString *)key;
+
+/// Whether there is a cached image source for the key
+/// @param key The image cache key
+- (BOOL)containsImageSourceForKey:(nullable NSString *)key;
+
+/// Remove all the cached image sources
+- (void)removeAllImageSources;
+
+/// Reset the `hitCount` and `missCount` to zero
+- (void)resetStatistics;
+
+@end
@@ -0,0 +1,307 @@
+/*
+* This file is part of the SDWebImage package.
+* (c) Olivier Poitrey <rs@dailymotion.com>
+*
+* For the full copyright and license information, please view the LICENSE
+* file that was distributed with this source code.
+*/
+
+#import "SDImageSourceCache.h"
+#import "SDInternalMacros.h"
+
+@interface SDImageSourceCacheEntry : NSObject {
+    @package
+    // The LRU list node, retained by the entries dictionary
+    __unsafe_unretained SDImageSourceCacheEntry *_prev;
+    __unsafe_unretained SDImageSourceCacheEntry *_next;
+}
+
+@property (nonatomic, copy) NSString *key;
+@property (nonatomic, strong) id imageSource;
+// The image source retain the data as well, keep it to check the data identity on lookup
+@property (nonatomic, strong) NSData *data;
+@property (nonatomic, assign) NSUInteger cost;
+
+@end
+
+@implementation SDImageSourceCacheEntry
+@end
+
+@interface SDImageSourceCache () {
+    SD_LOCK_DECLARE(_lock);
+    __unsafe_unretained SDImageSourceCacheEntry *_head; // most recently used
+    __unsafe_unretained SDImageSourceCacheEntry *_tail; // least recently used
+#if SD_MAC
+    dispatch_source_t _memoryPressureSource;
+#endif
+}
+
+@property (nonatomic, strong) NSMutableDictionary<NSString *, SDImageSourceCacheEntry *> *entries;
+@property (nonatomic, assign, readwrite) NSUInteger totalCost;
+@property (nonatomic, assign, readwrite) NSUInteger hitCount;
+@property (nonatomic, assign, readwrite) NSUInteger missCount;
+
+@end
+
+@implementation SDImageSourceCache
+
++ (SDImageSourceCache *)sharedCache {
+    static dispatch_once_t onceToken;
+    static SDImageSourceCache *cache;
+    dispatch_once(&onceToken, ^{
+        cache = [[SDImageSourceCache alloc] init];
+    });
+    return cache;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _entries = [NSMutableDictionary dictionary];
+        SD_LOCK_INIT(_lock);
+#if SD_UIKIT
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(didReceiveMemoryWarning:)
+                                                     name:UIApplicationDidReceiveMemoryWarningNotification
+                                                   object:nil];
+#elif SD_MAC
+        // macOS does not have memory warning notification, use the memory pressure event instead
+        _memoryPressureSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_MEMORYPRESSURE, 0, DISPATCH_MEMORYPRESSURE_WARN | DISPATCH_MEMORYPRESSURE_CRITICAL, dispatch_get_global_queue(QOS_CLASS_UTILITY, 0));
+        @weakify(self);
+        dispatch_source_set_event_handler(_memoryPressureSource, ^{
+            @strongify(self);
+            [self removeAllImageSources];
+        });
+        dispatch_resume(_memoryPressureSource);
+#endif
+    }
+    return self;
+}
+
+- (void)dealloc {
+#if SD_UIKIT
+    [[NSNotificationCenter defaultCenter] removeObserver:self name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
+#elif SD_MAC
+    if (_memoryPressureSource) {
+        dispatch_source_cancel(_memoryPressureSource);
+    }
+#endif
+}
+
+#if SD_UIKIT
+- (void)didReceiveMemoryWarning:(NSNotification *)notification {
+    [self removeAllImageSources];
+}
+#endif
+
+- (void)setTotalCostLimit:(NSUInteger)totalCostLimit {
+    SD_LOCK(_lock);
+    _totalCostLimit = totalCostLimit;
+    [self trimToCostLimit];
+    SD_UNLOCK(_lock);
+}
+
+- (NSUInteger)totalCostLimit {
+    SD_LOCK(_lock);
+    NSUInteger totalCostLimit = _totalCostLimit;
+    SD_UNLOCK(_lock);
+    return totalCostLimit;
+}
+
+- (NSUInteger)totalCost {
+    SD_LOCK(_lock);
+    NSUInteger totalCost = _totalCost;
+    SD_UNLOCK(_lock);
+    return totalCost;
+}
+
+- (NSUInteger)count {
+    SD_LOCK(_lock);
+    NSUInteger count = self.entries.count;
+    SD_UNLOCK(_lock);
+    return count;
+}
+
+- (NSUInteger)hitCount {
+    SD_LOCK(_lock);
+    NSUInteger hitCount = _hitCount;
+    SD_UNLOCK(_lock);
+    return hitCount;
+}
+
+- (NSUInteger)missCount {
+    SD_LOCK(_lock);
+    NSUInteger missCount = _missCount;
+    SD_UNLOCK(_lock);
+    return missCount;
+}
+
+- (double)hitRate {
+    SD_LOCK(_lock);
+    NSUInteger total = _hitCount + _missCount;
+    double hitRate = total > 0 ? (double)_hitCount / total : 0;
+    SD_UNLOCK(_lock);
+    return hitRate;
+}
+
+#pragma mark - Image Source
+
+- (CGImageSourceRef)copyImageSourceWithData:(NSData *)data forKey:(NSString *)key typeIdentifierHint:(NSString *)typeIdentifierHint cached:(BOOL *)cached {
+    if (cached) {
+        *cached = NO;
+    }
+    if (!data) {
+        return NULL;
+    }
+    NSUInteger cost = data.length;
+    BOOL shouldCache = NO;
+    CGImageSourceRef source = NULL;
+    if (key) {
+        SD_LOCK(_lock);
+        shouldCache = _totalCostLimit > 0 && cost <= _totalCostLimit;
+        if (shouldCache) {
+            SDImageSourceCacheEntry *entry = self.entries[key];
+            // Compare the bytes, a refreshed image of the same length should not use the stale image source. This is cheap compared to parsing, and `isEqualToData:` return immediately for the same instance
+            if (entry && [entry.data isEqualToData:data]) {
+                source = (__bridge CGImageSourceRef)entry.imageSource;
+                CFRetain(source);
+                _hitCount++;
+                // Mark as most recently used
+                [self bringEntryToHead:entry];
+            } else {
+                // The image for the key was replaced, drop the stale one
+                [self removeEntryForKey:key];
+                _missCount++;
+            }
+        }
+        SD_UNLOCK(_lock);
+    }
+    if (source) {
+        if (cached) {
+            *cached = YES;
+        }
+        return source;
+    }
+    
+    // Parse outside the lock
+    NSDictionary *creatingOptions = nil;
+    if (typeIdentifierHint) {
+        creatingOptions = @{(__bridge NSString *)kCGImageSourceTypeIdentifierHint : typeIdentifierHint};
+    }
+    source = CGImageSourceCreateWithData((__bridge CFDataRef)data, (__bridge CFDictionaryRef)creatingOptions);
+    if (!source && creatingOptions) {
+        // Try again without UTType hint, the call site from user may provide the wrong UTType
+        source = CGImageSourceCreateWithData((__bridge CFDataRef)data, nil);
+    }
+    if (!source || !shouldCache) {
+        return source;
+    }
+    
+    SD_LOCK(_lock);
+    // The limit may be changed during parsing
+    if (_totalCostLimit > 0 && cost <= _totalCostLimit) {
+        [self removeEntryForKey:key];
+        SDImageSourceCacheEntry *entry = [SDImageSourceCacheEntry new];
+        entry.key = key;
+        entry.imageSource = (__bridge id)source;
+        entry.data = data;
+        entry.cost = cost;
+        self.entries[key] = entry;
+        [self insertEntryAtHead:entry];
+        _totalCost += cost;
+        [self trimToCostLimit];
+        if (cached) {
+            *cached = self.entries[key] != nil;
+        }
+    }
+    SD_UNLOCK(_lock);
+    return source;
+}
+
+- (void)removeImageSourceForKey:(NSString *)key {
+    if (!key) {
+        return;
+    }
+    SD_LOCK(_lock);
+    [self removeEntryForKey:key];
+    SD_UNLOCK(_lock);
+}
+
+- (BOOL)containsImageSourceForKey:(NSString *)key {
+    if (!key) {
+        return NO;
+    }
+    SD_LOCK(_lock);
+    BOOL contains = self.entries[key] != nil;
+    SD_UNLOCK(_lock);
+    return contains;
+}
+
+- (void)removeAllImageSources {
+    SD_LOCK(_lock);
+    _head = _tail = nil;
+    [self.entries removeAllObjects];
+    _totalCost = 0;
+    SD_UNLOCK(_lock);
+}
+
+- (void)resetStatistics {
+    SD_LOCK(_lock);
+    _hitCount = 0;
+    _missCount = 0;
+    SD_UNLOCK(_lock);
+}
+
+#pragma mark - Util
+
+// Should be called inside lock
+- (void)removeEntryForKey:(NSString *)key {
+    SDImageSourceCacheEntry *entry = self.entries[key];
+    if (!entry) {
+        return;
+    }
+    _totalCost -= entry.cost;
+    [self removeEntryFromList:entry];
+    [self.entries removeObjectForKey:key];
+}
+
+// Should be called inside lock
+- (void)trimToCostLimit {
+    while (_tail && _totalCost > _totalCostLimit) {
+        [self removeEntryForKey:_tail.key];
+    }
+}
+
+// Should be called inside lock
+- (void)insertEntryAtHead:(SDImageSourceCacheEntry *)entry {
+    entry->_prev = nil;
+    entry->_next = _head;
+    if (_head) {
+        _head->_prev = entry;
+    }
+    _head = entry;
+    if (!_tail) {
+        _tail = entry;
+    }
+}
+
+// Should be called inside lock
+- (void)removeEntryFromList:(SDImageSourceCacheEntry *)entry {
+    if (entry->_next) entry->_next->_prev = entry->_prev;
+    if (entry->_prev) entry->_prev->_next = entry->_next;
+    if (_head == entry) _head = entry->_next;
+    if (_tail == entry) _tail = entry->_prev;
+    entry->_prev = nil;
+    entry->_next = nil;
+}
+
+// Should be called inside lock
+- (void)bringEntryToHead:(SDImageSourceCacheEntry *)entry {
+    if (_head == entry) {
+        return;
+    }
+    [self removeEntryFromList:entry];
+    [self insertEntryAtHead:entry];
+}
+
+@end
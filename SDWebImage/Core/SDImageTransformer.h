@@ -28,6 +28,15 @@ FOUNDATION_EXPORT NSString * _Nullable SDTransformedKeyForKey(NSString * _Nullab
  */
 FOUNDATION_EXPORT NSString * _Nullable SDThumbnailedKeyForKey(NSString * _Nullable key, CGSize thumbnailPixelSize, BOOL preserveAspectRatio);
 
+/**
+ Return the regioned cache key which applied with specify region and pixelSize, used for the tile decoded by `SDRegionImageCoder`.
+ @param key The original cache key
+ @param region The source rect in pixels of the image
+ @param pixelSize The target pixel size of the tile
+ @return The regioned cache key
+ */
+FOUNDATION_EXPORT NSString * _Nullable SDRegionedKeyForKey(NSString * _Nullable key, CGRect region, CGSize pixelSize);
+
 /**
  A transformer protocol to transform the image load from cache or from download.
  You can provide transformer to cache and manager (Through the `transformer` property or context option `SDWebImageContextImageTransformer`).
@@ -73,6 +82,7 @@ FOUNDATION_EXPORT NSString * _Nullable SDThumbnailedKeyForKey(NSString * _Nullab
 /**
  Pipeline transformer. Which you can bind multiple transformers together to let the image to be transformed one by one in order and generate the final image.
  @note Because transformers are lightweight, if you want to append or arrange transformers, create another pipeline transformer instead. This class is considered as immutable.
+ @note The continuous built-in geometry and blending transformers (resizing, cropping, flipping, rotation, round corner and tint) are rendered in one pass into the final bitmap, without creating the intermediate bitmap for each of them. The `transformerKey` is the same as the unfused one.
  */
 @interface SDImagePipelineTransformer : NSObject<SDImageTransformer>
 /// For pipeline transformer, this property is readonly and always return NO. We handle each transformer's choice inside implementation
@@ -9,6 +9,9 @@
 #import "SDImageTransformer.h"
 #import "UIColor+SDHexString.h"
 #import "SDAssociatedObject.h"
+#import "SDGraphicsImageRenderer.h"
+#import "NSBezierPath+SDRoundedCorners.h"
+#import "SDImageTransformInternal.h"
 #if SD_UIKIT || SD_MAC
 #import <CoreImage/CoreImage.h>
 #endif
@@ -44,6 +47,191 @@ NSString * _Nullable SDThumbnailedKeyForKey(NSString * _Nullable key, CGSize thu
     return SDTransformedKeyForKey(key, thumbnailKey);
 }
 
+NSString * _Nullable SDRegionedKeyForKey(NSString * _Nullable key, CGRect region, CGSize pixelSize) {
+    NSString *regionKey = [NSString stringWithFormat:@"Region({%f,%f,%f,%f},{%f,%f})", region.origin.x, region.origin.y, region.size.width, region.size.height, pixelSize.width, pixelSize.height];
+    return SDTransformedKeyForKey(key, regionKey);
+}
+
+// The built-in geometry and blending transformers, which can be rendered in one pass by the pipeline transformer
+@interface SDImageResizingTransformer ()
+@property (nonatomic, assign) CGSize size;
+@property (nonatomic, assign) SDImageScaleMode scaleMode;
+@end
+
+@interface SDImageCroppingTransformer ()
+@property (nonatomic, assign) CGRect rect;
+@end
+
+@interface SDImageFlippingTransformer ()
+@property (nonatomic, assign) BOOL horizontal;
+@property (nonatomic, assign) BOOL vertical;
+@end
+
+@interface SDImageRotationTransformer ()
+@property (nonatomic, assign) CGFloat angle;
+@property (nonatomic, assign) BOOL fitSize;
+@end
+
+@interface SDImageRoundCornerTransformer ()
+@property (nonatomic, assign) CGFloat cornerRadius;
+@property (nonatomic, assign) SDRectCorner corners;
+@property (nonatomic, assign) CGFloat borderWidth;
+@property (nonatomic, strong, nullable) UIColor *borderColor;
+@end
+
+@interface SDImageTintTransformer ()
+@property (nonatomic, strong, nonnull) UIColor *tintColor;
+@property (nonatomic, assign) CGBlendMode blendMode;
+@end
+
+// One stage of fused rendering. All the coordinates are in points, the same as `UIImage+Transform` drawing
+typedef struct SDImageFusedStage {
+    __unsafe_unretained id<SDImageTransformer> transformer;
+    CGSize outputSize;
+    CGAffineTransform transform; // map the input canvas coordinate to the output canvas coordinate
+} SDImageFusedStage;
+
+static inline BOOL SDImageTransformerCanFuse(id<SDImageTransformer> transformer) {
+    // Only the exact built-in class, subclass may override the transform
+    Class cls = [transformer class];
+    return cls == SDImageResizingTransformer.class
+    || cls == SDImageCroppingTransformer.class
+    || cls == SDImageFlippingTransformer.class
+    || cls == SDImageRotationTransformer.class
+    || cls == SDImageRoundCornerTransformer.class
+    || cls == SDImageTintTransformer.class;
+}
+
+// Calculate the stage geometry from input size, the same as the `UIImage+Transform` method. Return NO if the unfused transform return nil
+static BOOL SDImageFusedStageMake(id<SDImageTransformer> transformer, CGSize inputSize, CGFloat scale, SDImageFusedStage *stage) {
+    stage->transformer = transformer;
+    stage->outputSize = inputSize;
+    stage->transform = CGAffineTransformIdentity;
+    Class cls = [transformer class];
+    if (cls == SDImageResizingTransformer.class) {
+        SDImageResizingTransformer *resizing = (SDImageResizingTransformer *)transformer;
+        CGSize size = resizing.size;
+        if (size.width <= 0 || size.height <= 0) return NO;
+        CGRect drawRect = SDCGRectFitWithScaleMode(CGRectMake(0, 0, size.width, size.height), inputSize, resizing.scaleMode);
+        stage->outputSize = size;
+        if (drawRect.size.width == 0 || drawRect.size.height == 0 || inputSize.width == 0 || inputSize.height == 0) {
+            // Nothing is drawn, the result is a blank image
+            stage->transform = CGAffineTransformMakeScale(0, 0);
+        } else {
+            stage->transform = CGAffineTransformConcat(CGAffineTransformMakeScale(drawRect.size.width / inputSize.width, drawRect.size.height / inputSize.height), CGAffineTransformMakeTranslation(drawRect.origin.x, drawRect.origin.y));
+        }
+    } else if (cls == SDImageCroppingTransformer.class) {
+        // The same as `CGImageCreateWithImageInRect`, which use the integral pixel rect inside the image bounds
+        CGRect rect = ((SDImageCroppingTransformer *)transformer).rect;
+        CGRect pixelRect = CGRectMake(rect.origin.x * scale, rect.origin.y * scale, rect.size.width * scale, rect.size.height * scale);
+        if (pixelRect.size.width <= 0 || pixelRect.size.height <= 0) return NO;
+        pixelRect = CGRectIntersection(CGRectIntegral(pixelRect), CGRectMake(0, 0, round(inputSize.width * scale), round(inputSize.height * scale)));
+        if (CGRectIsNull(pixelRect) || CGRectIsEmpty(pixelRect)) return NO;
+        CGRect cropRect = CGRectMake(pixelRect.origin.x / scale, pixelRect.origin.y / scale, pixelRect.size.width / scale, pixelRect.size.height / scale);
+        stage->outputSize = cropRect.size;
+#if SD_MAC
+        // AppKit context is not flipped, but the crop rect is top-left origin
+        stage->transform = CGAffineTransformMakeTranslation(-cropRect.origin.x, -(inputSize.height - CGRectGetMaxY(cropRect)));
+#else
+        stage->transform = CGAffineTransformMakeTranslation(-cropRect.origin.x, -cropRect.origin.y);
+#endif
+    } else if (cls == SDImageFlippingTransformer.class) {
+        SDImageFlippingTransformer *flipping = (SDImageFlippingTransformer *)transformer;
+        size_t width = inputSize.width;
+        size_t height = inputSize.height;
+        if (width == 0 || height == 0) return NO;
+        CGAffineTransform transform = CGAffineTransformMakeScale(width / inputSize.width, height / inputSize.height);
+        if (flipping.horizontal) {
+            transform = CGAffineTransformConcat(transform, CGAffineTransformMake(-1, 0, 0, 1, width, 0));
+        }
+        if (flipping.vertical) {
+            transform = CGAffineTransformConcat(transform, CGAffineTransformMake(1, 0, 0, -1, 0, height));
+        }
+        stage->transform = transform;
+    } else if (cls == SDImageRotationTransformer.class) {
+        SDImageRotationTransformer *rotation = (SDImageRotationTransformer *)transformer;
+        CGFloat angle = rotation.angle;
+        size_t width = inputSize.width;
+        size_t height = inputSize.height;
+        if (width == 0 || height == 0) return NO;
+        CGRect newRect = CGRectApplyAffineTransform(CGRectMake(0, 0, width, height), rotation.fitSize ? CGAffineTransformMakeRotation(angle) : CGAffineTransformIdentity);
+        CGAffineTransform transform = CGAffineTransformMakeScale(width / inputSize.width, height / inputSize.height);
+        transform = CGAffineTransformConcat(transform, CGAffineTransformMakeTranslation(-(width * 0.5), -(height * 0.5)));
+#if SD_UIKIT || SD_WATCH
+        transform = CGAffineTransformConcat(transform, CGAffineTransformMakeRotation(-angle));
+#else
+        transform = CGAffineTransformConcat(transform, CGAffineTransformMakeRotation(angle));
+#endif
+        transform = CGAffineTransformConcat(transform, CGAffineTransformMakeTranslation(newRect.size.width * 0.5, newRect.size.height * 0.5));
+        stage->outputSize = newRect.size;
+        stage->transform = transform;
+    }
+    // Round corner and tint does not change the geometry
+    return YES;
+}
+
+// Move the context from the last stage's output coordinate into the `index` stage's output coordinate, applying the clip of the stages after it. Return NO if nothing is visible
+static BOOL SDImageFusedContextEnterStage(CGContextRef context, SDImageFusedStage *stages, NSInteger count, NSInteger index) {
+    for (NSInteger i = count - 1; i > index; i--) {
+        SDImageFusedStage stage = stages[i];
+        CGRect rect = CGRectMake(0, 0, stage.outputSize.width, stage.outputSize.height);
+        CGContextClipToRect(context, rect);
+        if ([stage.transformer class] == SDImageRoundCornerTransformer.class) {
+            SDImageRoundCornerTransformer *roundCorner = (SDImageRoundCornerTransformer *)stage.transformer;
+            CGFloat borderWidth = roundCorner.borderWidth;
+            CGFloat minSize = MIN(rect.size.width, rect.size.height);
+            if (borderWidth >= minSize / 2) {
+                return NO;
+            }
+#if SD_UIKIT || SD_WATCH
+            UIBezierPath *path = [UIBezierPath bezierPathWithRoundedRect:CGRectInset(rect, borderWidth, borderWidth) byRoundingCorners:roundCorner.corners cornerRadii:CGSizeMake(roundCorner.cornerRadius, roundCorner.cornerRadius)];
+#else
+            NSBezierPath *path = [NSBezierPath sd_bezierPathWithRoundedRect:CGRectInset(rect, borderWidth, borderWidth) byRoundingCorners:roundCorner.corners cornerRadius:roundCorner.cornerRadius];
+#endif
+            [path closePath];
+            [path addClip];
+        }
+        CGContextConcatCTM(context, stage.transform);
+    }
+    return YES;
+}
+
+// Draw the stage content which is above the input image, like round corner border and tint color
+static void SDImageFusedContextDrawStageOverlay(CGContextRef context, SDImageFusedStage stage, CGFloat scale) {
+    CGRect rect = CGRectMake(0, 0, stage.outputSize.width, stage.outputSize.height);
+    Class cls = [stage.transformer class];
+    if (cls == SDImageRoundCornerTransformer.class) {
+        SDImageRoundCornerTransformer *roundCorner = (SDImageRoundCornerTransformer *)stage.transformer;
+        CGFloat borderWidth = roundCorner.borderWidth;
+        UIColor *borderColor = roundCorner.borderColor;
+        CGFloat cornerRadius = roundCorner.cornerRadius;
+        CGFloat minSize = MIN(rect.size.width, rect.size.height);
+        if (borderColor && borderWidth < minSize / 2 && borderWidth > 0) {
+            CGFloat strokeInset = (floor(borderWidth * scale) + 0.5) / scale;
+            CGRect strokeRect = CGRectInset(rect, strokeInset, strokeInset);
+            CGFloat strokeRadius = cornerRadius > scale / 2 ? cornerRadius - scale / 2 : 0;
+#if SD_UIKIT || SD_WATCH
+            UIBezierPath *path = [UIBezierPath bezierPathWithRoundedRect:strokeRect byRoundingCorners:roundCorner.corners cornerRadii:CGSizeMake(strokeRadius, strokeRadius)];
+#else
+            NSBezierPath *path = [NSBezierPath sd_bezierPathWithRoundedRect:strokeRect byRoundingCorners:roundCorner.corners cornerRadius:strokeRadius];
+#endif
+            [path closePath];
+            path.lineWidth = borderWidth;
+            [borderColor setStroke];
+            [path stroke];
+        }
+    } else if (cls == SDImageTintTransformer.class) {
+        // Keep the same as `SDImageTintTransformer`, which fill the tint color with its blend mode
+        SDImageTintTransformer *tint = (SDImageTintTransformer *)stage.transformer;
+        UIColor *tintColor = tint.tintColor;
+        if (CGColorGetAlpha(tintColor.CGColor) > __FLT_EPSILON__) {
+            CGContextSetBlendMode(context, tint.blendMode);
+            CGContextSetFillColorWithColor(context, tintColor.CGColor);
+            CGContextFillRect(context, rect);
+        }
+    }
+}
+
 @interface SDImagePipelineTransformer ()
 
 @property (nonatomic, copy, readwrite, nonnull) NSArray<id<SDImageTransformer>> *transformers;
@@ -83,7 +271,30 @@ NSString * _Nullable SDThumbnailedKeyForKey(NSString * _Nullable key, CGSize thu
         return nil;
     }
     UIImage *transformedImage = image;
-    for (id<SDImageTransformer> transformer in self.transformers) {
+    NSArray<id<SDImageTransformer>> *transformers = self.transformers;
+    NSUInteger index = 0;
+    while (index < transformers.count) {
+        // Find the continuous fusable transformers, render them in one pass without the intermediate bitmaps
+        NSUInteger fusedCount = 0;
+        while (index + fusedCount < transformers.count && SDImageTransformerCanFuse(transformers[index + fusedCount])) {
+            fusedCount++;
+        }
+        if (fusedCount >= 2 && transformedImage && [self canFuseImage:transformedImage]) {
+            NSArray<id<SDImageTransformer>> *fusedTransformers = [transformers subarrayWithRange:NSMakeRange(index, fusedCount)];
+            UIImage *newImage = [self fusedImageWithImage:transformedImage transformers:fusedTransformers];
+            // Each transformer copy the metadata from its input image, so the metadata is kept only when all of them preserve
+            BOOL preserveImageMetadata = YES;
+            for (SDImageBaseTransformer *transformer in fusedTransformers) {
+                preserveImageMetadata = preserveImageMetadata && transformer.preserveImageMetadata;
+            }
+            if (preserveImageMetadata) {
+                SDImageCopyAssociatedObject(transformedImage, newImage);
+            }
+            transformedImage = newImage;
+            index += fusedCount;
+            continue;
+        }
+        id<SDImageTransformer> transformer = transformers[index];
         UIImage *newImage = [transformer transformedImageWithImage:transformedImage forKey:key];
         // Handle each transformer's preserveImageMetadata choice
         BOOL preserveImageMetadata = YES;
@@ -94,10 +305,69 @@ NSString * _Nullable SDThumbnailedKeyForKey(NSString * _Nullable key, CGSize thu
             SDImageCopyAssociatedObject(transformedImage, newImage);
         }
         transformedImage = newImage;
+        index++;
     }
     return transformedImage;
 }
 
+#pragma mark - Fused Rendering
+
+- (BOOL)canFuseImage:(nonnull UIImage *)image {
+    // CIImage and animated image use different code path in `UIImage+Transform`
+    if (!image.CGImage || image.images.count > 0) {
+        return NO;
+    }
+#if SD_UIKIT || SD_WATCH
+    // The cropping use the bitmap coordinate without orientation
+    if (image.imageOrientation != UIImageOrientationUp) {
+        return NO;
+    }
+#endif
+    return YES;
+}
+
+- (nullable UIImage *)fusedImageWithImage:(nonnull UIImage *)image transformers:(nonnull NSArray<id<SDImageTransformer>> *)transformers {
+    NSInteger count = transformers.count;
+    CGFloat scale = image.scale;
+    SDImageFusedStage *stages = calloc(count, sizeof(SDImageFusedStage));
+    if (!stages) {
+        return nil;
+    }
+    CGSize size = image.size;
+    for (NSInteger i = 0; i < count; i++) {
+        if (!SDImageFusedStageMake(transformers[i], size, scale, &stages[i])) {
+            free(stages);
+            return nil;
+        }
+        size = stages[i].outputSize;
+    }
+    
+    SDGraphicsImageRendererFormat *format = [[SDGraphicsImageRendererFormat alloc] init];
+    format.scale = scale;
+    SDGraphicsImageRenderer *renderer = [[SDGraphicsImageRenderer alloc] initWithSize:size format:format];
+    UIImage *fusedImage = [renderer imageWithActions:^(CGContextRef  _Nonnull context) {
+        CGContextSetShouldAntialias(context, true);
+        CGContextSetAllowsAntialiasing(context, true);
+        CGContextSetInterpolationQuality(context, kCGInterpolationHigh);
+        // Draw the input image through all the stages
+        CGContextSaveGState(context);
+        if (SDImageFusedContextEnterStage(context, stages, count, -1)) {
+            [image drawInRect:CGRectMake(0, 0, image.size.width, image.size.height)];
+        }
+        CGContextRestoreGState(context);
+        // Draw the overlay in order, each one is affected by the stages after it
+        for (NSInteger i = 0; i < count; i++) {
+            CGContextSaveGState(context);
+            if (SDImageFusedContextEnterStage(context, stages, count, i)) {
+                SDImageFusedContextDrawStageOverlay(context, stages[i], scale);
+            }
+            CGContextRestoreGState(context);
+        }
+    }];
+    free(stages);
+    return fusedImage;
+}
+
 @end
 
 @implementation SDImageBaseTransformer
@@ -124,15 +394,6 @@ NSString * _Nullable SDThumbnailedKeyForKey(NSString * _Nullable key, CGSize thu
 
 @end
 
-@interface SDImageRoundCornerTransformer ()
-
-@property (nonatomic, assign) CGFloat cornerRadius;
-@property (nonatomic, assign) SDRectCorner corners;
-@property (nonatomic, assign) CGFloat borderWidth;
-@property (nonatomic, strong, nullable) UIColor *borderColor;
-
-@end
-
 @implementation SDImageRoundCornerTransformer
 
 + (instancetype)transformerWithRadius:(CGFloat)cornerRadius corners:(SDRectCorner)corners borderWidth:(CGFloat)borderWidth borderColor:(UIColor *)borderColor {
@@ -158,13 +419,6 @@ NSString * _Nullable SDThumbnailedKeyForKey(NSString * _Nullable key, CGSize thu
 
 @end
 
-@interface SDImageResizingTransformer ()
-
-@property (nonatomic, assign) CGSize size;
-@property (nonatomic, assign) SDImageScaleMode scaleMode;
-
-@end
-
 @implementation SDImageResizingTransformer
 
 + (instancetype)transformerWithSize:(CGSize)size scaleMode:(SDImageScaleMode)scaleMode {
@@ -189,12 +443,6 @@ NSString * _Nullable SDThumbnailedKeyForKey(NSString * _Nullable key, CGSize thu
 
 @end
 
-@interface SDImageCroppingTransformer ()
-
-@property (nonatomic, assign) CGRect rect;
-
-@end
-
 @implementation SDImageCroppingTransformer
 
 + (instancetype)transformerWithRect:(CGRect)rect {
@@ -218,13 +466,6 @@ NSString * _Nullable SDThumbnailedKeyForKey(NSString * _Nullable key, CGSize thu
 
 @end
 
-@interface SDImageFlippingTransformer ()
-
-@property (nonatomic, assign) BOOL horizontal;
-@property (nonatomic, assign) BOOL vertical;
-
-@end
-
 @implementation SDImageFlippingTransformer
 
 + (instancetype)transformerWithHorizontal:(BOOL)horizontal vertical:(BOOL)vertical {
@@ -248,13 +489,6 @@ NSString * _Nullable SDThumbnailedKeyForKey(NSString * _Nullable key, CGSize thu
 
 @end
 
-@interface SDImageRotationTransformer ()
-
-@property (nonatomic, assign) CGFloat angle;
-@property (nonatomic, assign) BOOL fitSize;
-
-@end
-
 @implementation SDImageRotationTransformer
 
 + (instancetype)transformerWithAngle:(CGFloat)angle fitSize:(BOOL)fitSize {
@@ -280,13 +514,6 @@ NSString * _Nullable SDThumbnailedKeyForKey(NSString * _Nullable key, CGSize thu
 
 #pragma mark - Image Blending
 
-@interface SDImageTintTransformer ()
-
-@property (nonatomic, strong, nonnull) UIColor *tintColor;
-@property (nonatomic, assign) CGBlendMode blendMode;
-
-@end
-
 @implementation SDImageTintTransformer
 
 + (instancetype)transformerWithColor:(UIColor *)tintColor {
@@ -0,0 +1,57 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDWebImageCompat.h"
+#import "SDDiskCache.h"
+
+/**
+ A disk cache which packs small data into append-only segment files, instead of one file per key. This avoids the per-file inode, open and close cost for workloads with huge amount of small images (like avatar or thumbnail).
+
+ - Small data (not larger than `maxPackedDataSize`) and its extended data are appended as records into the current segment file. The key -> record location index is kept in memory, and rebuilt by scanning the segment records on the first access.
+ - Reading data use memory-mapped segment file, the returned data reference the mapping without copy.
+ - Removing or overwriting data only mark the old record as dead. A segment is compacted in background when most of its bytes are dead: the live records are copied into a new file outside the lock, then the file replace the segment and the index is updated under the lock.
+ - Large data is stored as separate files using the built-in `SDDiskCache`, in the `large` sub-directory.
+
+ To use this class for `SDImageCache`, set `SDImageCacheConfig.diskCacheClass` to `SDPackedDiskCache.class`.
+ @note For packed data, the `SDImageCacheConfigExpireTypeAccessDate` expire type use the access date in memory, which is reset to write date when the segments are scanned. Other expire types use the write date.
+ @note Packed data does not have a standalone file, the `cachePathForKey:` extract a snapshot of the data into the `extracted` sub-directory and return that file path, the store is not changed. The snapshot is not updated when the data is overwritten, call it again to get the latest one.
+ @note The packed data and large files share the `maxDiskSize` limit, the large files use the part not used by packed data.
+ */
+@interface SDPackedDiskCache : NSObject <SDDiskCache>
+
+/**
+ Cache Config object - storing all kind of settings.
+ */
+@property (nonatomic, strong, readonly, nonnull) SDImageCacheConfig *config;
+
+/**
+ The maximum data size in bytes to be packed into segment. Larger data is stored as separate file.
+ Defaults to 64 KB.
+ */
+@property (nonatomic, assign) NSUInteger maxPackedDataSize;
+
+/**
+ The maximum segment file size in bytes. When the current segment exceed this size, a new segment is created.
+ Defaults to 4 MB.
+ */
+@property (nonatomic, assign) NSUInteger maxSegmentSize;
+
+/**
+ The number of segment files currently on disk.
+ */
+@property (nonatomic, assign, readonly) NSUInteger segmentCount;
+
+- (nonnull instancetype)init NS_UNAVAILABLE;
++ (nonnull instancetype)new  NS_UNAVAILABLE;
+
+/**
+ Synchronously compact the segments which most of bytes are dead. This is called automatically in background, you don't need to call it manually.
+ */
+- (void)compact;
+
+@end
@@ -0,0 +1,863 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDPackedDiskCache.h"
+#import "SDImageCacheConfig.h"
+#import "SDInternalMacros.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+static NSString * const kSDPackedDiskCacheSegmentPrefix = @"segment-";
+static NSString * const kSDPackedDiskCacheSegmentExtension = @"sdpack";
+static NSString * const kSDPackedDiskCacheLargeDirectory = @"large";
+static NSString * const kSDPackedDiskCacheExtractedDirectory = @"extracted";
+
+static const uint32_t kSDPackedDiskCacheRecordMagic = 0x4B504453; // 'SDPK'
+// magic(u32) + type(u8) + key length(u16) + payload length(u32) + date(double)
+static const NSUInteger kSDPackedDiskCacheRecordHeaderSize = 4 + 1 + 2 + 4 + 8;
+
+typedef NS_ENUM(uint8_t, SDPackedDiskCacheRecordType) {
+    SDPackedDiskCacheRecordTypeData = 1,
+    SDPackedDiskCacheRecordTypeExtendedData = 2,
+    SDPackedDiskCacheRecordTypeRemove = 3,
+};
+
+// The segment is compacted when the dead bytes exceed this ratio
+static const double kSDPackedDiskCacheCompactDeadRatio = 0.5;
+
+#pragma mark - Segment
+
+@interface SDPackedDiskCacheSegment : NSObject
+
+@property (nonatomic, assign) NSUInteger segmentID;
+@property (nonatomic, copy) NSString *path;
+@property (nonatomic, assign) NSUInteger size;
+@property (nonatomic, assign) NSUInteger liveSize;
+// The remove records kept by the last compaction, they are not live but can not be dropped
+@property (nonatomic, assign) NSUInteger tombstoneSize;
+// The memory mapping of this segment file, remapped when the file is appended beyond it
+@property (nonatomic, strong, nullable) NSData *mappedData;
+
+@end
+
+@implementation SDPackedDiskCacheSegment
+@end
+
+#pragma mark - Entry
+
+@interface SDPackedDiskCacheEntry : NSObject
+
+@property (nonatomic, assign) NSUInteger dataSegmentID;
+@property (nonatomic, assign) NSUInteger dataOffset;
+@property (nonatomic, assign) NSUInteger dataLength;
+@property (nonatomic, assign) NSUInteger dataRecordSize;
+// 0 means no extended data. The extended data record is always written after the data record
+@property (nonatomic, assign) NSUInteger extendedSegmentID;
+@property (nonatomic, assign) NSUInteger extendedOffset;
+@property (nonatomic, assign) NSUInteger extendedLength;
+@property (nonatomic, assign) NSUInteger extendedRecordSize;
+@property (nonatomic, assign) NSTimeInterval writeDate;
+@property (nonatomic, assign) NSTimeInterval accessDate;
+
+@end
+
+@implementation SDPackedDiskCacheEntry
+@end
+
+#pragma mark - SDPackedDiskCache
+
+@interface SDPackedDiskCache () {
+    SD_LOCK_DECLARE(_lock);
+    int _fd; // The append file descriptor of current segment, -1 if not opened
+    BOOL _loaded;
+    BOOL _compactScheduled;
+}
+
+@property (nonatomic, copy) NSString *diskCachePath;
+@property (nonatomic, strong, nonnull) NSFileManager *fileManager;
+@property (nonatomic, strong, nonnull) SDDiskCache *largeCache;
+// The config copy for large cache, the size limit is the part not used by packed data
+@property (nonatomic, strong, nonnull) SDImageCacheConfig *largeConfig;
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSString *, SDPackedDiskCacheEntry *> *entries;
+// Ordered by segment id, the last one is the current segment for append
+@property (nonatomic, strong, nonnull) NSMutableArray<SDPackedDiskCacheSegment *> *segments;
+@property (nonatomic, assign) NSUInteger packedSize;
+@property (nonatomic, strong, nonnull) dispatch_queue_t compactQueue;
+
+@end
+
+@implementation SDPackedDiskCache
+
+- (instancetype)init {
+    NSAssert(NO, @"Use `initWithCachePath:` with the disk cache path");
+    return nil;
+}
+
+- (void)dealloc {
+    if (_fd >= 0) {
+        close(_fd);
+    }
+}
+
+#pragma mark - SDDiskCache Protocol
+
+- (instancetype)initWithCachePath:(NSString *)cachePath config:(SDImageCacheConfig *)config {
+    if (self = [super init]) {
+        _diskCachePath = [cachePath copy];
+        _config = config;
+        _maxPackedDataSize = 64 * 1024;
+        _maxSegmentSize = 4 * 1024 * 1024;
+        _fd = -1;
+        _entries = [NSMutableDictionary dictionary];
+        _segments = [NSMutableArray array];
+        _compactQueue = dispatch_queue_create("com.hackemist.SDPackedDiskCache.compactQueue", DISPATCH_QUEUE_SERIAL);
+        SD_LOCK_INIT(_lock);
+        if (config.fileManager) {
+            _fileManager = config.fileManager;
+        } else {
+            _fileManager = [NSFileManager new];
+        }
+        [self createDirectory];
+        _largeConfig = [config copy];
+        _largeCache = [[SDDiskCache alloc] initWithCachePath:[_diskCachePath stringByAppendingPathComponent:kSDPackedDiskCacheLargeDirectory] config:_largeConfig];
+    }
+    return self;
+}
+
+- (BOOL)containsDataForKey:(NSString *)key {
+    NSParameterAssert(key);
+    SD_LOCK(_lock);
+    [self loadIfNeeded];
+    BOOL exists = self.entries[key] != nil;
+    SD_UNLOCK(_lock);
+    if (exists) {
+        return YES;
+    }
+    return [self.largeCache containsDataForKey:key];
+}
+
+- (NSData *)dataForKey:(NSString *)key {
+    NSParameterAssert(key);
+    SD_LOCK(_lock);
+    [self loadIfNeeded];
+    SDPackedDiskCacheEntry *entry = self.entries[key];
+    NSData *data;
+    if (entry) {
+        entry.accessDate = [NSDate date].timeIntervalSince1970;
+        data = [self mappedDataInSegmentID:entry.dataSegmentID offset:entry.dataOffset length:entry.dataLength];
+    }
+    SD_UNLOCK(_lock);
+    if (entry) {
+        return data;
+    }
+    return [self.largeCache dataForKey:key];
+}
+
+- (void)setData:(NSData *)data forKey:(NSString *)key {
+    NSParameterAssert(data);
+    NSParameterAssert(key);
+    NSData *keyData = [key dataUsingEncoding:NSUTF8StringEncoding];
+    BOOL shouldPack = data.length <= self.maxPackedDataSize && keyData.length <= UINT16_MAX;
+    if (!shouldPack) {
+        [self updateLargeConfig];
+        [self.largeCache setData:data forKey:key];
+        SD_LOCK(_lock);
+        [self loadIfNeeded];
+        if (self.entries[key]) {
+            [self removeEntryForKey:key keyData:keyData];
+        }
+        SD_UNLOCK(_lock);
+        [self scheduleCompactIfNeeded];
+        return;
+    }
+
+    SD_LOCK(_lock);
+    [self loadIfNeeded];
+    BOOL replacePacked = self.entries[key] != nil;
+    NSTimeInterval date = [NSDate date].timeIntervalSince1970;
+    SDPackedDiskCacheSegment *segment;
+    NSUInteger offset = [self appendRecordWithType:SDPackedDiskCacheRecordTypeData keyData:keyData payload:data date:date segment:&segment];
+    if (offset != NSNotFound) {
+        [self discardEntryForKey:key];
+        SDPackedDiskCacheEntry *entry = [SDPackedDiskCacheEntry new];
+        entry.dataSegmentID = segment.segmentID;
+        entry.dataOffset = offset;
+        entry.dataLength = data.length;
+        entry.dataRecordSize = kSDPackedDiskCacheRecordHeaderSize + keyData.length + data.length;
+        entry.writeDate = date;
+        entry.accessDate = date;
+        segment.liveSize += entry.dataRecordSize;
+        self.packedSize += entry.dataLength;
+        self.entries[key] = entry;
+    }
+    SD_UNLOCK(_lock);
+    if (offset != NSNotFound && !replacePacked && [self.largeCache containsDataForKey:key]) {
+        // The data was stored as large file before
+        [self.largeCache removeDataForKey:key];
+    }
+    [self scheduleCompactIfNeeded];
+}
+
+- (NSData *)extendedDataForKey:(NSString *)key {
+    NSParameterAssert(key);
+    SD_LOCK(_lock);
+    [self loadIfNeeded];
+    SDPackedDiskCacheEntry *entry = self.entries[key];
+    NSData *extendedData;
+    if (entry && entry.extendedSegmentID > 0) {
+        extendedData = [self mappedDataInSegmentID:entry.extendedSegmentID offset:entry.extendedOffset length:entry.extendedLength];
+    }
+    SD_UNLOCK(_lock);
+    if (entry) {
+        return extendedData;
+    }
+    return [self.largeCache extendedDataForKey:key];
+}
+
+- (void)setExtendedData:(NSData *)extendedData forKey:(NSString *)key {
+    NSParameterAssert(key);
+    SD_LOCK(_lock);
+    [self loadIfNeeded];
+    SDPackedDiskCacheEntry *entry = self.entries[key];
+    if (entry) {
+        NSData *keyData = [key dataUsingEncoding:NSUTF8StringEncoding];
+        SDPackedDiskCacheSegment *segment;
+        // Empty payload means remove the extended data
+        NSData *payload = extendedData ?: [NSData data];
+        NSUInteger offset = [self appendRecordWithType:SDPackedDiskCacheRecordTypeExtendedData keyData:keyData payload:payload date:entry.writeDate segment:&segment];
+        if (offset != NSNotFound) {
+            [self discardExtendedDataOfEntry:entry];
+            NSUInteger recordSize = kSDPackedDiskCacheRecordHeaderSize + keyData.length + payload.length;
+            if (extendedData) {
+                entry.extendedSegmentID = segment.segmentID;
+                entry.extendedOffset = offset;
+                entry.extendedLength = payload.length;
+                entry.extendedRecordSize = recordSize;
+                segment.liveSize += recordSize;
+            }
+        }
+    }
+    SD_UNLOCK(_lock);
+    if (!entry) {
+        [self.largeCache setExtendedData:extendedData forKey:key];
+    } else {
+        [self scheduleCompactIfNeeded];
+    }
+}
+
+- (void)removeDataForKey:(NSString *)key {
+    NSParameterAssert(key);
+    SD_LOCK(_lock);
+    [self loadIfNeeded];
+    if (self.entries[key]) {
+        [self removeEntryForKey:key keyData:[key dataUsingEncoding:NSUTF8StringEncoding]];
+    }
+    SD_UNLOCK(_lock);
+    [self.largeCache removeDataForKey:key];
+    [self removeExtractedFileForKey:key];
+    [self scheduleCompactIfNeeded];
+}
+
+- (void)removeAllData {
+    SD_LOCK(_lock);
+    [self closeSegment];
+    // The existing memory mappings are still valid after the files are unlinked
+    [self.fileManager removeItemAtPath:self.diskCachePath error:nil];
+    [self createDirectory];
+    [self.entries removeAllObjects];
+    [self.segments removeAllObjects];
+    self.packedSize = 0;
+    _loaded = YES;
+    SD_UNLOCK(_lock);
+    [self.largeCache removeAllData];
+}
+
+- (void)removeExpiredData {
+    SD_LOCK(_lock);
+    [self loadIfNeeded];
+    BOOL useAccessDate = self.config.diskCacheExpireType == SDImageCacheConfigExpireTypeAccessDate;
+    BOOL shouldExpire = self.config.maxDiskAge >= 0;
+    NSTimeInterval expirationDate = [NSDate date].timeIntervalSince1970 - self.config.maxDiskAge;
+
+    NSMutableArray<NSString *> *remainKeys = [NSMutableArray arrayWithCapacity:self.entries.count];
+    for (NSString *key in self.entries.allKeys) {
+        SDPackedDiskCacheEntry *entry = self.entries[key];
+        NSTimeInterval date = useAccessDate ? entry.accessDate : entry.writeDate;
+        if (shouldExpire && date <= expirationDate) {
+            [self removeEntryForKey:key keyData:[key dataUsingEncoding:NSUTF8StringEncoding]];
+            continue;
+        }
+        [remainKeys addObject:key];
+    }
+
+    // The large files share the same size limit
+    NSUInteger maxDiskSize = self.config.maxDiskSize;
+    NSUInteger largeSize = maxDiskSize > 0 ? self.largeCache.totalSize : 0;
+    if (maxDiskSize > 0 && self.packedSize + largeSize > maxDiskSize) {
+        // Target half of our maximum cache size for this cleanup pass, the packed data take its proportional part.
+        const NSUInteger desiredCacheSize = (NSUInteger)((double)maxDiskSize / 2 * self.packedSize / (self.packedSize + largeSize));
+
+        // Sort the remaining entries by date (oldest first).
+        NSDictionary<NSString *, SDPackedDiskCacheEntry *> *entries = self.entries;
+        [remainKeys sortUsingComparator:^NSComparisonResult(NSString *key1, NSString *key2) {
+            SDPackedDiskCacheEntry *entry1 = entries[key1];
+            SDPackedDiskCacheEntry *entry2 = entries[key2];
+            NSTimeInterval date1 = useAccessDate ? entry1.accessDate : entry1.writeDate;
+            NSTimeInterval date2 = useAccessDate ? entry2.accessDate : entry2.writeDate;
+            return date1 < date2 ? NSOrderedAscending : (date1 > date2 ? NSOrderedDescending : NSOrderedSame);
+        }];
+
+        // Delete entries until we fall below our desired cache size.
+        for (NSString *key in remainKeys) {
+            if (self.packedSize < desiredCacheSize) {
+                break;
+            }
+            [self removeEntryForKey:key keyData:[key dataUsingEncoding:NSUTF8StringEncoding]];
+        }
+    }
+    SD_UNLOCK(_lock);
+    // The extracted files are only snapshots for `cachePathForKey:`
+    [self.fileManager removeItemAtPath:[self.diskCachePath stringByAppendingPathComponent:kSDPackedDiskCacheExtractedDirectory] error:nil];
+    [self scheduleCompactIfNeeded];
+
+    // The large cache clean itself with the remaining size limit
+    [self updateLargeConfig];
+    [self.largeCache removeExpiredData];
+}
+
+- (void)updateLargeConfig {
+    SDImageCacheConfig *config = self.config;
+    SDImageCacheConfig *largeConfig = self.largeConfig;
+    largeConfig.shouldDisableiCloud = config.shouldDisableiCloud;
+    largeConfig.diskCacheReadingOptions = config.diskCacheReadingOptions;
+    largeConfig.shouldMapDiskCacheData = config.shouldMapDiskCacheData;
+    largeConfig.diskCacheWritingOptions = config.diskCacheWritingOptions;
+    largeConfig.maxDiskAge = config.maxDiskAge;
+    largeConfig.maxDiskEvictionCount = config.maxDiskEvictionCount;
+    largeConfig.diskCacheExpireType = config.diskCacheExpireType;
+    NSUInteger maxDiskSize = config.maxDiskSize;
+    if (maxDiskSize > 0) {
+        SD_LOCK(_lock);
+        [self loadIfNeeded];
+        NSUInteger packedSize = self.packedSize;
+        SD_UNLOCK(_lock);
+        // 0 means no limit, keep at least 1 byte
+        maxDiskSize = packedSize < maxDiskSize ? maxDiskSize - packedSize : 1;
+    }
+    largeConfig.maxDiskSize = maxDiskSize;
+}
+
+- (nullable NSString *)cachePathForKey:(NSString *)key {
+    NSParameterAssert(key);
+    SD_LOCK(_lock);
+    [self loadIfNeeded];
+    SDPackedDiskCacheEntry *entry = self.entries[key];
+    NSData *data;
+    if (entry) {
+        data = [self mappedDataInSegmentID:entry.dataSegmentID offset:entry.dataOffset length:entry.dataLength];
+    }
+    SD_UNLOCK(_lock);
+    // The path computing of large cache does not touch the store
+    NSString *largePath = [self.largeCache cachePathForKey:key];
+    if (!entry) {
+        return largePath;
+    }
+    // Packed data does not have a standalone file, extract a snapshot for the caller which access the file directly. The store is not changed
+    if (!data) {
+        return nil;
+    }
+    NSString *extractedDirectory = [self.diskCachePath stringByAppendingPathComponent:kSDPackedDiskCacheExtractedDirectory];
+    [self.fileManager createDirectoryAtPath:extractedDirectory withIntermediateDirectories:YES attributes:nil error:nil];
+    NSString *extractedPath = [extractedDirectory stringByAppendingPathComponent:largePath.lastPathComponent];
+    if (![data writeToFile:extractedPath options:NSDataWritingAtomic error:nil]) {
+        return nil;
+    }
+    return extractedPath;
+}
+
+- (void)removeExtractedFileForKey:(NSString *)key {
+    NSString *fileName = [self.largeCache cachePathForKey:key].lastPathComponent;
+    if (!fileName) {
+        return;
+    }
+    NSString *extractedPath = [[self.diskCachePath stringByAppendingPathComponent:kSDPackedDiskCacheExtractedDirectory] stringByAppendingPathComponent:fileName];
+    [self.fileManager removeItemAtPath:extractedPath error:nil];
+}
+
+- (NSUInteger)totalSize {
+    SD_LOCK(_lock);
+    [self loadIfNeeded];
+    NSUInteger size = 0;
+    for (SDPackedDiskCacheSegment *segment in self.segments) {
+        size += segment.size;
+    }
+    SD_UNLOCK(_lock);
+    return size + self.largeCache.totalSize;
+}
+
+- (NSUInteger)totalCount {
+    SD_LOCK(_lock);
+    [self loadIfNeeded];
+    NSUInteger count = self.entries.count;
+    SD_UNLOCK(_lock);
+    return count + self.largeCache.totalCount;
+}
+
+- (NSUInteger)segmentCount {
+    SD_LOCK(_lock);
+    [self loadIfNeeded];
+    NSUInteger count = self.segments.count;
+    SD_UNLOCK(_lock);
+    return count;
+}
+
+- (void)compact {
+    // Serial with the background compaction
+    dispatch_sync(self.compactQueue, ^{
+        [self compactSegments];
+    });
+}
+
+#pragma mark - Private (must be called inside lock)
+
+- (void)createDirectory {
+    [self.fileManager createDirectoryAtPath:self.diskCachePath
+                withIntermediateDirectories:YES
+                                 attributes:nil
+                                      error:NULL];
+
+    // disable iCloud backup
+    if (self.config.shouldDisableiCloud) {
+        // ignore iCloud backup resource value error
+        [[NSURL fileURLWithPath:self.diskCachePath isDirectory:YES] setResourceValue:@YES forKey:NSURLIsExcludedFromBackupKey error:nil];
+    }
+}
+
+- (NSString *)pathForSegmentID:(NSUInteger)segmentID {
+    NSString *fileName = [NSString stringWithFormat:@"%@%08lu.%@", kSDPackedDiskCacheSegmentPrefix, (unsigned long)segmentID, kSDPackedDiskCacheSegmentExtension];
+    return [self.diskCachePath stringByAppendingPathComponent:fileName];
+}
+
+- (nullable SDPackedDiskCacheSegment *)segmentForID:(NSUInteger)segmentID {
+    // Only few segments, linear search is enough
+    for (SDPackedDiskCacheSegment *segment in self.segments) {
+        if (segment.segmentID == segmentID) {
+            return segment;
+        }
+    }
+    return nil;
+}
+
+- (void)loadIfNeeded {
+    if (_loaded) {
+        return;
+    }
+    _loaded = YES;
+    NSArray<NSString *> *fileNames = [self.fileManager contentsOfDirectoryAtPath:self.diskCachePath error:nil];
+    NSMutableArray<NSNumber *> *segmentIDs = [NSMutableArray array];
+    for (NSString *fileName in fileNames) {
+        if (![fileName hasPrefix:kSDPackedDiskCacheSegmentPrefix] || ![fileName.pathExtension isEqualToString:kSDPackedDiskCacheSegmentExtension]) {
+            continue;
+        }
+        NSString *idString = [fileName.stringByDeletingPathExtension substringFromIndex:kSDPackedDiskCacheSegmentPrefix.length];
+        long long segmentID = idString.longLongValue;
+        if (segmentID > 0) {
+            [segmentIDs addObject:@(segmentID)];
+        }
+    }
+    [segmentIDs sortUsingSelector:@selector(compare:)];
+
+    for (NSNumber *segmentID in segmentIDs) {
+        @autoreleasepool {
+            SDPackedDiskCacheSegment *segment = [SDPackedDiskCacheSegment new];
+            segment.segmentID = segmentID.unsignedIntegerValue;
+            segment.path = [self pathForSegmentID:segment.segmentID];
+            [self.segments addObject:segment];
+            [self scanSegment:segment];
+        }
+    }
+}
+
+// Replay all records of the segment into entries. The broken tail (like crash during append) is truncated
+- (void)scanSegment:(SDPackedDiskCacheSegment *)segment {
+    NSData *data = [NSData dataWithContentsOfFile:segment.path options:NSDataReadingMappedIfSafe error:nil];
+    const uint8_t *bytes = data.bytes;
+    NSUInteger length = data.length;
+    NSUInteger offset = 0;
+    while (offset + kSDPackedDiskCacheRecordHeaderSize <= length) {
+        uint32_t magic;
+        uint8_t type;
+        uint16_t keyLength;
+        uint32_t payloadLength;
+        double date;
+        const uint8_t *header = bytes + offset;
+        memcpy(&magic, header, 4);
+        memcpy(&type, header + 4, 1);
+        memcpy(&keyLength, header + 5, 2);
+        memcpy(&payloadLength, header + 7, 4);
+        memcpy(&date, header + 11, 8);
+        NSUInteger recordSize = kSDPackedDiskCacheRecordHeaderSize + keyLength + payloadLength;
+        if (magic != kSDPackedDiskCacheRecordMagic || type < SDPackedDiskCacheRecordTypeData || type > SDPackedDiskCacheRecordTypeRemove || offset + recordSize > length) {
+            break;
+        }
+        NSString *key = [[NSString alloc] initWithBytes:header + kSDPackedDiskCacheRecordHeaderSize length:keyLength encoding:NSUTF8StringEncoding];
+        NSUInteger payloadOffset = offset + kSDPackedDiskCacheRecordHeaderSize + keyLength;
+        if (key) {
+            [self applyRecordWithType:type key:key payloadOffset:payloadOffset payloadLength:payloadLength recordSize:recordSize date:date segment:segment];
+        }
+        offset += recordSize;
+    }
+    segment.size = offset;
+    if (offset < length) {
+        truncate(segment.path.fileSystemRepresentation, (off_t)offset);
+    }
+}
+
+- (void)applyRecordWithType:(SDPackedDiskCacheRecordType)type key:(NSString *)key payloadOffset:(NSUInteger)payloadOffset payloadLength:(NSUInteger)payloadLength recordSize:(NSUInteger)recordSize date:(NSTimeInterval)date segment:(SDPackedDiskCacheSegment *)segment {
+    switch (type) {
+        case SDPackedDiskCacheRecordTypeData: {
+            [self discardEntryForKey:key];
+            SDPackedDiskCacheEntry *entry = [SDPackedDiskCacheEntry new];
+            entry.dataSegmentID = segment.segmentID;
+            entry.dataOffset = payloadOffset;
+            entry.dataLength = payloadLength;
+            entry.dataRecordSize = recordSize;
+            entry.writeDate = date;
+            entry.accessDate = date;
+            segment.liveSize += recordSize;
+            self.packedSize += payloadLength;
+            self.entries[key] = entry;
+            break;
+        }
+        case SDPackedDiskCacheRecordTypeExtendedData: {
+            SDPackedDiskCacheEntry *entry = self.entries[key];
+            if (!entry) {
+                break;
+            }
+            [self discardExtendedDataOfEntry:entry];
+            if (payloadLength > 0) {
+                entry.extendedSegmentID = segment.segmentID;
+                entry.extendedOffset = payloadOffset;
+                entry.extendedLength = payloadLength;
+                entry.extendedRecordSize = recordSize;
+                segment.liveSize += recordSize;
+            }
+            break;
+        }
+        case SDPackedDiskCacheRecordTypeRemove:
+            [self discardEntryForKey:key];
+            break;
+    }
+}
+
+// Mark the records of key as dead in memory, without writing to disk
+- (void)discardEntryForKey:(NSString *)key {
+    SDPackedDiskCacheEntry *entry = self.entries[key];
+    if (!entry) {
+        return;
+    }
+    [self discardExtendedDataOfEntry:entry];
+    SDPackedDiskCacheSegment *segment = [self segmentForID:entry.dataSegmentID];
+    segment.liveSize -= MIN(segment.liveSize, entry.dataRecordSize);
+    self.packedSize -= MIN(self.packedSize, entry.dataLength);
+    [self.entries removeObjectForKey:key];
+}
+
+- (void)discardExtendedDataOfEntry:(SDPackedDiskCacheEntry *)entry {
+    if (entry.extendedSegmentID == 0) {
+        return;
+    }
+    SDPackedDiskCacheSegment *segment = [self segmentForID:entry.extendedSegmentID];
+    segment.liveSize -= MIN(segment.liveSize, entry.extendedRecordSize);
+    entry.extendedSegmentID = 0;
+    entry.extendedOffset = 0;
+    entry.extendedLength = 0;
+    entry.extendedRecordSize = 0;
+}
+
+// Write a remove record, so the entry does not come back when the segments are scanned next time
+- (void)removeEntryForKey:(NSString *)key keyData:(NSData *)keyData {
+    [self appendRecordWithType:SDPackedDiskCacheRecordTypeRemove keyData:keyData payload:[NSData data] date:[NSDate date].timeIntervalSince1970 segment:NULL];
+    [self discardEntryForKey:key];
+}
+
+- (BOOL)openSegmentIfNeeded {
+    SDPackedDiskCacheSegment *segment = self.segments.lastObject;
+    if (_fd >= 0 && segment.size < self.maxSegmentSize) {
+        return YES;
+    }
+    if (!segment || segment.size >= self.maxSegmentSize) {
+        // Roll over to a new segment
+        [self closeSegment];
+        SDPackedDiskCacheSegment *newSegment = [SDPackedDiskCacheSegment new];
+        newSegment.segmentID = segment ? segment.segmentID + 1 : 1;
+        newSegment.path = [self pathForSegmentID:newSegment.segmentID];
+        [self.segments addObject:newSegment];
+        segment = newSegment;
+    }
+    _fd = open(segment.path.fileSystemRepresentation, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (_fd < 0) {
+        // The directory may be removed outside
+        [self createDirectory];
+        _fd = open(segment.path.fileSystemRepresentation, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    }
+    return _fd >= 0;
+}
+
+- (void)closeSegment {
+    if (_fd >= 0) {
+        close(_fd);
+        _fd = -1;
+    }
+}
+
+// Append one record into current segment, return the payload offset in segment, or NSNotFound if failed
+- (NSUInteger)appendRecordWithType:(SDPackedDiskCacheRecordType)type keyData:(NSData *)keyData payload:(NSData *)payload date:(NSTimeInterval)date segment:(SDPackedDiskCacheSegment **)outSegment {
+    if (![self openSegmentIfNeeded]) {
+        return NSNotFound;
+    }
+    SDPackedDiskCacheSegment *segment = self.segments.lastObject;
+
+    uint8_t header[kSDPackedDiskCacheRecordHeaderSize];
+    uint32_t magic = kSDPackedDiskCacheRecordMagic;
+    uint8_t recordType = type;
+    uint16_t keyLength = (uint16_t)keyData.length;
+    uint32_t payloadLength = (uint32_t)payload.length;
+    double recordDate = date;
+    memcpy(header, &magic, 4);
+    memcpy(header + 4, &recordType, 1);
+    memcpy(header + 5, &keyLength, 2);
+    memcpy(header + 7, &payloadLength, 4);
+    memcpy(header + 11, &recordDate, 8);
+
+    struct iovec iov[3];
+    iov[0].iov_base = header;
+    iov[0].iov_len = kSDPackedDiskCacheRecordHeaderSize;
+    iov[1].iov_base = (void *)keyData.bytes;
+    iov[1].iov_len = keyData.length;
+    iov[2].iov_base = (void *)payload.bytes;
+    iov[2].iov_len = payload.length;
+
+    NSUInteger recordSize = kSDPackedDiskCacheRecordHeaderSize + keyData.length + payload.length;
+    ssize_t written = writev(_fd, iov, 3);
+    if (written != (ssize_t)recordSize) {
+        // Drop the partial record, the next scan stops at it otherwise
+        if (written > 0) {
+            ftruncate(_fd, (off_t)segment.size);
+        }
+        return NSNotFound;
+    }
+    NSUInteger payloadOffset = segment.size + kSDPackedDiskCacheRecordHeaderSize + keyData.length;
+    segment.size += recordSize;
+    if (outSegment) {
+        *outSegment = segment;
+    }
+    return payloadOffset;
+}
+
+- (nullable NSData *)mappedDataInSegmentID:(NSUInteger)segmentID offset:(NSUInteger)offset length:(NSUInteger)length {
+    SDPackedDiskCacheSegment *segment = [self segmentForID:segmentID];
+    if (!segment) {
+        return nil;
+    }
+    NSData *mappedData = segment.mappedData;
+    if (mappedData.length < offset + length) {
+        // Map the whole file again, the previous mapping is still retained by the returned data
+        mappedData = [NSData dataWithContentsOfFile:segment.path options:NSDataReadingMappedAlways error:nil];
+        segment.mappedData = mappedData;
+        if (mappedData.length < offset + length) {
+            return nil;
+        }
+    }
+    if (length == 0) {
+        return [NSData data];
+    }
+    // Zero-copy, the data keep the mapping alive
+    return [[NSData alloc] initWithBytesNoCopy:(void *)((const uint8_t *)mappedData.bytes + offset) length:length deallocator:^(void * _Nonnull mappedBytes, NSUInteger mappedLength) {
+        [mappedData self];
+    }];
+}
+
+- (BOOL)shouldCompactSegment:(SDPackedDiskCacheSegment *)segment {
+    if (segment == self.segments.lastObject) {
+        // Never compact the current segment
+        return NO;
+    }
+    return segment.liveSize + segment.tombstoneSize < segment.size * (1 - kSDPackedDiskCacheCompactDeadRatio);
+}
+
+- (nullable SDPackedDiskCacheSegment *)segmentToCompactExcludingSegments:(nullable NSSet<SDPackedDiskCacheSegment *> *)excludedSegments {
+    for (SDPackedDiskCacheSegment *segment in self.segments) {
+        if (![excludedSegments containsObject:segment] && [self shouldCompactSegment:segment]) {
+            return segment;
+        }
+    }
+    return nil;
+}
+
+#pragma mark - Compaction (must be called on compact queue, outside lock)
+
+- (void)compactSegments {
+    NSMutableSet<SDPackedDiskCacheSegment *> *compactedSegments = [NSMutableSet set];
+    while (YES) {
+        @autoreleasepool {
+            // Snapshot the live record offsets inside lock
+            SD_LOCK(_lock);
+            [self loadIfNeeded];
+            SDPackedDiskCacheSegment *segment = [self segmentToCompactExcludingSegments:compactedSegments];
+            BOOL isOldest = segment == self.segments.firstObject;
+            NSMutableIndexSet *liveOffsets = [NSMutableIndexSet indexSet];
+            if (segment) {
+                for (SDPackedDiskCacheEntry *entry in self.entries.objectEnumerator) {
+                    if (entry.dataSegmentID == segment.segmentID) {
+                        [liveOffsets addIndex:entry.dataOffset];
+                    }
+                    if (entry.extendedSegmentID == segment.segmentID) {
+                        [liveOffsets addIndex:entry.extendedOffset];
+                    }
+                }
+            }
+            SD_UNLOCK(_lock);
+            if (!segment) {
+                return;
+            }
+            [compactedSegments addObject:segment];
+            [self rewriteSegment:segment liveOffsets:liveOffsets keepTombstones:!isOldest];
+        }
+    }
+}
+
+// Write the live records into a new file and replace the segment with it. The records are copied outside lock, only the index swap is inside.
+// The records keep their order and segment, so the newer segments still override them. The remove records hide the dead records in older segments, they are only dropped from the oldest segment
+- (void)rewriteSegment:(SDPackedDiskCacheSegment *)segment liveOffsets:(NSIndexSet *)liveOffsets keepTombstones:(BOOL)keepTombstones {
+    // The segment is not the current one, no more append into it
+    NSData *data = [NSData dataWithContentsOfFile:segment.path options:NSDataReadingMappedIfSafe error:nil];
+    if (!data) {
+        return;
+    }
+    NSString *tempPath = [segment.path stringByAppendingPathExtension:@"tmp"];
+    int fd = open(tempPath.fileSystemRepresentation, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return;
+    }
+    const uint8_t *bytes = data.bytes;
+    NSUInteger length = data.length;
+    NSUInteger offset = 0;
+    NSUInteger newSize = 0;
+    NSUInteger tombstoneSize = 0;
+    // The old payload offset -> new payload offset
+    NSMutableDictionary<NSNumber *, NSNumber *> *offsetMap = [NSMutableDictionary dictionary];
+    BOOL success = YES;
+    while (offset + kSDPackedDiskCacheRecordHeaderSize <= length) {
+        uint32_t magic;
+        uint8_t type;
+        uint16_t keyLength;
+        uint32_t payloadLength;
+        const uint8_t *header = bytes + offset;
+        memcpy(&magic, header, 4);
+        memcpy(&type, header + 4, 1);
+        memcpy(&keyLength, header + 5, 2);
+        memcpy(&payloadLength, header + 7, 4);
+        NSUInteger recordSize = kSDPackedDiskCacheRecordHeaderSize + keyLength + payloadLength;
+        if (magic != kSDPackedDiskCacheRecordMagic || offset + recordSize > length) {
+            break;
+        }
+        NSUInteger payloadOffset = offset + kSDPackedDiskCacheRecordHeaderSize + keyLength;
+        BOOL isLive = [liveOffsets containsIndex:payloadOffset] && type != SDPackedDiskCacheRecordTypeRemove;
+        // The empty extended data record remove the extended data, it's a tombstone as well
+        BOOL isTombstone = type == SDPackedDiskCacheRecordTypeRemove || (type == SDPackedDiskCacheRecordTypeExtendedData && payloadLength == 0);
+        if (isLive || (keepTombstones && isTombstone)) {
+            if (write(fd, header, recordSize) != (ssize_t)recordSize) {
+                success = NO;
+                break;
+            }
+            if (isLive) {
+                offsetMap[@(payloadOffset)] = @(newSize + kSDPackedDiskCacheRecordHeaderSize + keyLength);
+            } else {
+                tombstoneSize += recordSize;
+            }
+            newSize += recordSize;
+        }
+        offset += recordSize;
+    }
+    close(fd);
+    if (!success) {
+        unlink(tempPath.fileSystemRepresentation);
+        return;
+    }
+
+    // Swap the index inside lock
+    SD_LOCK(_lock);
+    if ([self.segments indexOfObjectIdenticalTo:segment] == NSNotFound) {
+        // Removed during rewriting
+        SD_UNLOCK(_lock);
+        unlink(tempPath.fileSystemRepresentation);
+        return;
+    }
+    NSUInteger segmentID = segment.segmentID;
+    NSUInteger liveSize = 0;
+    for (SDPackedDiskCacheEntry *entry in self.entries.objectEnumerator) {
+        // The entries changed during rewriting point to newer segments, the rest are in the offset map
+        if (entry.dataSegmentID == segmentID) {
+            liveSize += entry.dataRecordSize;
+        }
+        if (entry.extendedSegmentID == segmentID) {
+            liveSize += entry.extendedRecordSize;
+        }
+    }
+    if (newSize == 0) {
+        [self.segments removeObjectIdenticalTo:segment];
+        unlink(segment.path.fileSystemRepresentation);
+        unlink(tempPath.fileSystemRepresentation);
+    } else if (rename(tempPath.fileSystemRepresentation, segment.path.fileSystemRepresentation) == 0) {
+        // The existing memory mappings of old file are still valid after rename
+        for (SDPackedDiskCacheEntry *entry in self.entries.objectEnumerator) {
+            if (entry.dataSegmentID == segmentID) {
+                entry.dataOffset = offsetMap[@(entry.dataOffset)].unsignedIntegerValue;
+            }
+            if (entry.extendedSegmentID == segmentID) {
+                entry.extendedOffset = offsetMap[@(entry.extendedOffset)].unsignedIntegerValue;
+            }
+        }
+        segment.size = newSize;
+        segment.liveSize = liveSize;
+        segment.tombstoneSize = tombstoneSize;
+        segment.mappedData = nil;
+    } else {
+        unlink(tempPath.fileSystemRepresentation);
+    }
+    SD_UNLOCK(_lock);
+}
+
+#pragma mark - Background compaction
+
+- (void)scheduleCompactIfNeeded {
+    SD_LOCK(_lock);
+    BOOL shouldSchedule = !_compactScheduled && [self segmentToCompactExcludingSegments:nil] != nil;
+    if (shouldSchedule) {
+        _compactScheduled = YES;
+    }
+    SD_UNLOCK(_lock);
+    if (!shouldSchedule) {
+        return;
+    }
+    @weakify(self);
+    dispatch_async(self.compactQueue, ^{
+        @strongify(self);
+        if (!self) {
+            return;
+        }
+        SD_LOCK(self->_lock);
+        self->_compactScheduled = NO;
+        SD_UNLOCK(self->_lock);
+        [self compactSegments];
+    });
+}
+
+@end
@@ -0,0 +1,66 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDWebImageCompat.h"
+#import "SDMemoryCache.h"
+
+/**
+ A memory cache which split the keys into multiple hash-sharded segments. Each segment has its own lock, cost-aware LRU list and weak cache table, so concurrent access on different keys does not contend on a single global lock.
+ Unlike `SDMemoryCache` (which is based on `NSCache`), the limit is strictly kept: when the whole cache exceeds the limit, objects are evicted until both the cost and the count fit the limit. The eviction is approximate LRU: each eviction samples a few segments (include the one just inserted into) and evicts the least recently used object among them, so the insertion does not lock every segment.
+ To use this class for `SDImageCache`, set `SDImageCacheConfig.memoryCacheClass` to `SDShardedMemoryCache.class`.
+ @note The `maxMemoryCost` and `maxMemoryCount` limit in config are for the whole cache, not divided into segments. The object just stored is never evicted by its own insertion, so an object larger than `maxMemoryCost` is still cached until it become the least recently used one.
+ */
+@interface SDShardedMemoryCache <KeyType, ObjectType> : NSObject <SDMemoryCache>
+
+@property (nonatomic, strong, nonnull, readonly) SDImageCacheConfig *config;
+
+/**
+ The number of hash-sharded segments. Always be the power of 2.
+ */
+@property (nonatomic, assign, readonly) NSUInteger shardCount;
+
+/**
+ The total cost of objects currently in the cache (not include the weak cache).
+ */
+@property (nonatomic, assign, readonly) NSUInteger totalCost;
+
+/**
+ The total number of objects currently in the cache (not include the weak cache).
+ */
+@property (nonatomic, assign, readonly) NSUInteger totalCount;
+
+/**
+ Create a new memory cache instance with the specify cache config. The shard count is chosen from the active processor count.
+
+ @param config The cache config to be used to create the cache.
+ @return The new memory cache instance.
+ */
+- (nonnull instancetype)initWithConfig:(nonnull SDImageCacheConfig *)config;
+
+/**
+ Create a new memory cache instance with the specify cache config and shard count.
+
+ @param config The cache config to be used to create the cache.
+ @param shardCount The number of segments, will be rounded up to the power of 2. Pass 0 to choose from the active processor count.
+ @return The new memory cache instance.
+ */
+- (nonnull instancetype)initWithConfig:(nonnull SDImageCacheConfig *)config shardCount:(NSUInteger)shardCount NS_DESIGNATED_INITIALIZER;
+
+- (nullable ObjectType)objectForKey:(nonnull KeyType)key;
+- (void)setObject:(nullable ObjectType)object forKey:(nonnull KeyType)key;
+- (void)setObject:(nullable ObjectType)object forKey:(nonnull KeyType)key cost:(NSUInteger)cost;
+- (void)removeObjectForKey:(nonnull KeyType)key;
+
+/**
+ Removes the least recently used objects until the total cost is under the limit.
+
+ @param costLimit The total cost limit of whole cache.
+ */
+- (void)trimToCost:(NSUInteger)costLimit;
+
+@end
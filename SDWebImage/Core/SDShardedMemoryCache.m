@@ -0,0 +1,459 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDShardedMemoryCache.h"
+#import "SDImageCacheConfig.h"
+#import "UIImage+MemoryCacheCost.h"
+#import "SDInternalMacros.h"
+#import <stdatomic.h>
+#import <mach/mach_time.h>
+
+static void * SDShardedMemoryCacheContext = &SDShardedMemoryCacheContext;
+static const NSUInteger kSDShardedMemoryCacheMaxShardCount = 64;
+// The number of segments sampled for each eviction, the oldest tail among them is evicted
+static const NSUInteger kSDShardedMemoryCacheEvictionSampleCount = 3;
+
+static inline uint64_t SDMemoryCacheAccessTime(void) {
+    // Read from commpage, no syscall and no shared write between threads
+    return mach_absolute_time();
+}
+
+/// A node in the LRU doubly linked list. The node is retained by the shard's dictionary.
+@interface SDMemoryCacheNode : NSObject {
+    @package
+    __unsafe_unretained SDMemoryCacheNode *_prev;
+    __unsafe_unretained SDMemoryCacheNode *_next;
+    id _key;
+    id _value;
+    NSUInteger _cost;
+    uint64_t _accessTime; // the last access time, used to compare the least recently used nodes across segments
+}
+@end
+
+@implementation SDMemoryCacheNode
+@end
+
+/// A segment of the sharded memory cache. All the ivars should be accessed inside `_lock`.
+@interface SDMemoryCacheShard : NSObject {
+    @package
+    SD_LOCK_DECLARE(_lock);
+    CFMutableDictionaryRef _dic;
+    __unsafe_unretained SDMemoryCacheNode *_head; // most recently used
+    __unsafe_unretained SDMemoryCacheNode *_tail; // least recently used
+    NSUInteger _totalCost;
+    NSUInteger _totalCount;
+    NSMapTable *_weakCache; // strong-weak cache
+}
+@end
+
+@implementation SDMemoryCacheShard
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        SD_LOCK_INIT(_lock);
+        _dic = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
+        _weakCache = [[NSMapTable alloc] initWithKeyOptions:NSPointerFunctionsStrongMemory valueOptions:NSPointerFunctionsWeakMemory capacity:0];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    CFRelease(_dic);
+}
+
+// Below methods should be called inside `_lock`
+
+- (void)bringNodeToHead:(SDMemoryCacheNode *)node {
+    if (_head == node) {
+        return;
+    }
+    if (_tail == node) {
+        _tail = node->_prev;
+        _tail->_next = nil;
+    } else {
+        node->_next->_prev = node->_prev;
+        node->_prev->_next = node->_next;
+    }
+    node->_next = _head;
+    node->_prev = nil;
+    _head->_prev = node;
+    _head = node;
+}
+
+- (void)insertNodeAtHead:(SDMemoryCacheNode *)node {
+    CFDictionarySetValue(_dic, (__bridge const void *)(node->_key), (__bridge const void *)(node));
+    _totalCost += node->_cost;
+    _totalCount++;
+    if (_head) {
+        node->_next = _head;
+        _head->_prev = node;
+        _head = node;
+    } else {
+        _head = _tail = node;
+    }
+}
+
+- (void)unlinkNode:(SDMemoryCacheNode *)node {
+    _totalCost -= node->_cost;
+    _totalCount--;
+    if (node->_next) node->_next->_prev = node->_prev;
+    if (node->_prev) node->_prev->_next = node->_next;
+    if (_head == node) _head = node->_next;
+    if (_tail == node) _tail = node->_prev;
+    node->_prev = nil;
+    node->_next = nil;
+}
+
+/// The least recently used node, skip the excluded one (the node just inserted)
+- (SDMemoryCacheNode *)tailNodeExcludingNode:(SDMemoryCacheNode *)excludedNode {
+    SDMemoryCacheNode *node = _tail;
+    if (node && node == excludedNode) {
+        node = node->_prev;
+    }
+    return node;
+}
+
+/// Remove the node, the node is added to `holder` so the caller can release it outside the lock
+- (void)removeNode:(SDMemoryCacheNode *)node holder:(NSMutableArray *)holder {
+    [holder addObject:node];
+    [self unlinkNode:node];
+    CFDictionaryRemoveValue(_dic, (__bridge const void *)(node->_key));
+}
+
+- (void)removeAllNodesWithHolder:(NSMutableArray *)holder {
+    SDMemoryCacheNode *node = _head;
+    while (node) {
+        [holder addObject:node];
+        node = node->_next;
+    }
+    _head = _tail = nil;
+    _totalCost = 0;
+    _totalCount = 0;
+    CFDictionaryRemoveAllValues(_dic);
+}
+
+@end
+
+@interface SDShardedMemoryCache () {
+    NSUInteger _shardMask;
+    // The totals of all segments, updated inside the segment lock, so the limit can be checked without locking every segment
+    atomic_ulong _totalCost;
+    atomic_ulong _totalCount;
+}
+
+@property (nonatomic, strong, nullable) SDImageCacheConfig *config;
+@property (nonatomic, copy, nonnull) NSArray<SDMemoryCacheShard *> *shards;
+@property (nonatomic, strong, nonnull) dispatch_queue_t releaseQueue;
+
+@end
+
+@implementation SDShardedMemoryCache
+
+- (void)dealloc {
+    [_config removeObserver:self forKeyPath:NSStringFromSelector(@selector(maxMemoryCost)) context:SDShardedMemoryCacheContext];
+    [_config removeObserver:self forKeyPath:NSStringFromSelector(@selector(maxMemoryCount)) context:SDShardedMemoryCacheContext];
+#if SD_UIKIT
+    [[NSNotificationCenter defaultCenter] removeObserver:self name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
+#endif
+}
+
+- (instancetype)init {
+    return [self initWithConfig:[[SDImageCacheConfig alloc] init]];
+}
+
+- (instancetype)initWithConfig:(SDImageCacheConfig *)config {
+    return [self initWithConfig:config shardCount:0];
+}
+
+- (instancetype)initWithConfig:(SDImageCacheConfig *)config shardCount:(NSUInteger)shardCount {
+    self = [super init];
+    if (self) {
+        _config = config;
+        if (shardCount == 0) {
+            // Twice of the core count, to reduce the chance of two threads access the same segment
+            shardCount = NSProcessInfo.processInfo.activeProcessorCount * 2;
+        }
+        shardCount = MIN(shardCount, kSDShardedMemoryCacheMaxShardCount);
+        // Round up to power of 2, so we can use bit mask instead of modulo
+        NSUInteger roundedCount = 1;
+        while (roundedCount < shardCount) {
+            roundedCount <<= 1;
+        }
+        _shardCount = roundedCount;
+        _shardMask = roundedCount - 1;
+        NSMutableArray<SDMemoryCacheShard *> *shards = [NSMutableArray arrayWithCapacity:roundedCount];
+        for (NSUInteger i = 0; i < roundedCount; i++) {
+            [shards addObject:[SDMemoryCacheShard new]];
+        }
+        _shards = [shards copy];
+        _releaseQueue = dispatch_get_global_queue(QOS_CLASS_UTILITY, 0);
+        atomic_init(&_totalCost, 0);
+        atomic_init(&_totalCount, 0);
+
+        [config addObserver:self forKeyPath:NSStringFromSelector(@selector(maxMemoryCost)) options:0 context:SDShardedMemoryCacheContext];
+        [config addObserver:self forKeyPath:NSStringFromSelector(@selector(maxMemoryCount)) options:0 context:SDShardedMemoryCacheContext];
+#if SD_UIKIT
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(didReceiveMemoryWarning:)
+                                                     name:UIApplicationDidReceiveMemoryWarningNotification
+                                                   object:nil];
+#endif
+    }
+    return self;
+}
+
+#pragma mark - Helper
+
+- (SDMemoryCacheShard *)shardForKey:(id)key {
+    NSUInteger hash = [key hash];
+    // Mix the high bits, because `-[NSString hash]` may be poor on the low bits
+    hash ^= (hash >> 16);
+    hash *= 0x45d9f3b;
+    hash ^= (hash >> 16);
+    return self.shards[hash & _shardMask];
+}
+
+- (void)releaseNodesAsync:(NSMutableArray *)holder {
+    if (holder.count == 0) {
+        return;
+    }
+    // Release the evicted objects (which may be large bitmap) in background
+    dispatch_async(self.releaseQueue, ^{
+        [holder count]; // capture and release in queue
+    });
+}
+
+// Should be called inside the segment lock, after the segment totals changed
+- (void)addCostDelta:(NSUInteger)costDelta countDelta:(NSUInteger)countDelta {
+    // Unsigned wrap around, so the negative delta also works
+    atomic_fetch_add_explicit(&_totalCost, costDelta, memory_order_relaxed);
+    atomic_fetch_add_explicit(&_totalCount, countDelta, memory_order_relaxed);
+}
+
+- (BOOL)exceedsCostLimit:(NSUInteger)costLimit countLimit:(NSUInteger)countLimit {
+    NSUInteger totalCost = atomic_load_explicit(&_totalCost, memory_order_relaxed);
+    NSUInteger totalCount = atomic_load_explicit(&_totalCount, memory_order_relaxed);
+    return (costLimit > 0 && totalCost > costLimit) || (countLimit > 0 && totalCount > countLimit);
+}
+
+/// Pick the segment which has the oldest tail in the given segments, nil if they only contain the excluded node
+- (nullable SDMemoryCacheShard *)oldestShardInShards:(id<NSFastEnumeration>)shards excludingNode:(SDMemoryCacheNode *)excludedNode {
+    SDMemoryCacheShard *oldestShard;
+    uint64_t oldestTime = UINT64_MAX;
+    for (SDMemoryCacheShard *shard in shards) {
+        SD_LOCK(shard->_lock);
+        SDMemoryCacheNode *node = [shard tailNodeExcludingNode:excludedNode];
+        if (node && node->_accessTime <= oldestTime) {
+            oldestTime = node->_accessTime;
+            oldestShard = shard;
+        }
+        SD_UNLOCK(shard->_lock);
+    }
+    return oldestShard;
+}
+
+/// Evict the approximate least recently used nodes until the whole cache fit the limit. Each eviction only sample a few segments (include the segment just inserted into), and evict the oldest tail among them, so the insertion does not lock all the segments. The excluded node (the node just inserted) is never evicted, so an object larger than the limit is still cached until the next insertion
+- (void)trimToCostLimit:(NSUInteger)costLimit countLimit:(NSUInteger)countLimit preferredShard:(nullable SDMemoryCacheShard *)preferredShard excludingNode:(nullable SDMemoryCacheNode *)excludedNode {
+    if (![self exceedsCostLimit:costLimit countLimit:countLimit]) {
+        return;
+    }
+    NSArray<SDMemoryCacheShard *> *shards = self.shards;
+    uint32_t shardCount = (uint32_t)shards.count;
+    NSMutableArray *holder = [NSMutableArray array];
+    while ([self exceedsCostLimit:costLimit countLimit:countLimit]) {
+        SDMemoryCacheShard *samples[kSDShardedMemoryCacheEvictionSampleCount];
+        for (NSUInteger i = 0; i < kSDShardedMemoryCacheEvictionSampleCount; i++) {
+            samples[i] = (i == 0 && preferredShard) ? preferredShard : shards[arc4random_uniform(shardCount)];
+        }
+        SDMemoryCacheShard *oldestShard = [self oldestShardInShards:[NSArray arrayWithObjects:samples count:kSDShardedMemoryCacheEvictionSampleCount] excludingNode:excludedNode];
+        if (!oldestShard) {
+            // The sampled segments are empty, only happen when the cache is sparse, check all of them
+            oldestShard = [self oldestShardInShards:shards excludingNode:excludedNode];
+        }
+        if (!oldestShard) {
+            // Only the excluded node left
+            break;
+        }
+        // The tail may be accessed during sampling, evict the current tail, it's still the oldest one in that segment
+        SD_LOCK(oldestShard->_lock);
+        SDMemoryCacheNode *node = [oldestShard tailNodeExcludingNode:excludedNode];
+        if (node) {
+            NSUInteger cost = node->_cost;
+            [oldestShard removeNode:node holder:holder];
+            [self addCostDelta:-cost countDelta:-1];
+        }
+        SD_UNLOCK(oldestShard->_lock);
+    }
+    [self releaseNodesAsync:holder];
+}
+
+- (void)updateLimits {
+    [self trimToCostLimit:self.config.maxMemoryCost countLimit:self.config.maxMemoryCount preferredShard:nil excludingNode:nil];
+}
+
+- (void)removeAllNodes {
+    NSMutableArray *holder = [NSMutableArray array];
+    for (SDMemoryCacheShard *shard in self.shards) {
+        SD_LOCK(shard->_lock);
+        [self addCostDelta:-shard->_totalCost countDelta:-shard->_totalCount];
+        [shard removeAllNodesWithHolder:holder];
+        SD_UNLOCK(shard->_lock);
+    }
+    [self releaseNodesAsync:holder];
+}
+
+#if SD_UIKIT
+- (void)didReceiveMemoryWarning:(NSNotification *)notification {
+    // Only remove cache, but keep weak cache
+    [self removeAllNodes];
+}
+#endif
+
+#pragma mark - SDMemoryCache
+
+- (id)objectForKey:(id)key {
+    if (!key) {
+        return nil;
+    }
+    SDMemoryCacheShard *shard = [self shardForKey:key];
+    BOOL shouldUseWeakMemoryCache = self.config.shouldUseWeakMemoryCache;
+    id obj;
+    SD_LOCK(shard->_lock);
+    SDMemoryCacheNode *node = CFDictionaryGetValue(shard->_dic, (__bridge const void *)(key));
+    BOOL hitWeakCache = NO;
+    if (node) {
+        [shard bringNodeToHead:node];
+        node->_accessTime = SDMemoryCacheAccessTime();
+        obj = node->_value;
+    } else if (shouldUseWeakMemoryCache) {
+        // Check weak cache
+        obj = [shard->_weakCache objectForKey:key];
+        hitWeakCache = obj != nil;
+    }
+    SD_UNLOCK(shard->_lock);
+    if (hitWeakCache) {
+        // Sync cache
+        NSUInteger cost = 0;
+        if ([obj isKindOfClass:[UIImage class]]) {
+            cost = [(UIImage *)obj sd_memoryCost];
+        }
+        [self setObject:obj forKey:key cost:cost];
+    }
+    return obj;
+}
+
+- (void)setObject:(id)object forKey:(id)key {
+    [self setObject:object forKey:key cost:0];
+}
+
+- (void)setObject:(id)object forKey:(id)key cost:(NSUInteger)cost {
+    if (!key) {
+        return;
+    }
+    if (!object) {
+        [self removeObjectForKey:key];
+        return;
+    }
+    SDMemoryCacheShard *shard = [self shardForKey:key];
+    BOOL shouldUseWeakMemoryCache = self.config.shouldUseWeakMemoryCache;
+    NSMutableArray *holder = [NSMutableArray array];
+    SD_LOCK(shard->_lock);
+    SDMemoryCacheNode *node = CFDictionaryGetValue(shard->_dic, (__bridge const void *)(key));
+    if (node) {
+        if (node->_value != object) {
+            // Keep the old value alive until unlock
+            [holder addObject:node->_value];
+        }
+        shard->_totalCost = shard->_totalCost - node->_cost + cost;
+        [self addCostDelta:cost - node->_cost countDelta:0];
+        node->_cost = cost;
+        node->_value = object;
+        [shard bringNodeToHead:node];
+    } else {
+        node = [SDMemoryCacheNode new];
+        // Copy the key, a mutable key changed later would break the hash table
+        node->_key = [key copy];
+        node->_value = object;
+        node->_cost = cost;
+        [shard insertNodeAtHead:node];
+        [self addCostDelta:cost countDelta:1];
+    }
+    node->_accessTime = SDMemoryCacheAccessTime();
+    if (shouldUseWeakMemoryCache) {
+        [shard->_weakCache setObject:object forKey:node->_key];
+    }
+    SD_UNLOCK(shard->_lock);
+    [self releaseNodesAsync:holder];
+    // The limit is for the whole cache, evict the least recently used objects from any segment
+    [self trimToCostLimit:self.config.maxMemoryCost countLimit:self.config.maxMemoryCount preferredShard:shard excludingNode:node];
+}
+
+- (void)removeObjectForKey:(id)key {
+    if (!key) {
+        return;
+    }
+    SDMemoryCacheShard *shard = [self shardForKey:key];
+    SDMemoryCacheNode *node;
+    SD_LOCK(shard->_lock);
+    node = CFDictionaryGetValue(shard->_dic, (__bridge const void *)(key));
+    if (node) {
+        // Retained by local variable, release outside the lock
+        [shard unlinkNode:node];
+        CFDictionaryRemoveValue(shard->_dic, (__bridge const void *)(key));
+        [self addCostDelta:-node->_cost countDelta:-1];
+    }
+    [shard->_weakCache removeObjectForKey:key];
+    SD_UNLOCK(shard->_lock);
+}
+
+- (void)removeAllObjects {
+    NSMutableArray *holder = [NSMutableArray array];
+    for (SDMemoryCacheShard *shard in self.shards) {
+        SD_LOCK(shard->_lock);
+        [self addCostDelta:-shard->_totalCost countDelta:-shard->_totalCount];
+        [shard removeAllNodesWithHolder:holder];
+        // Manually remove should also remove weak cache
+        [shard->_weakCache removeAllObjects];
+        SD_UNLOCK(shard->_lock);
+    }
+    [self releaseNodesAsync:holder];
+}
+
+#pragma mark - Cache Info
+
+- (NSUInteger)totalCost {
+    return atomic_load_explicit(&_totalCost, memory_order_relaxed);
+}
+
+- (NSUInteger)totalCount {
+    return atomic_load_explicit(&_totalCount, memory_order_relaxed);
+}
+
+- (void)trimToCost:(NSUInteger)costLimit {
+    if (costLimit == 0) {
+        [self removeAllNodes];
+        return;
+    }
+    [self trimToCostLimit:costLimit countLimit:0 preferredShard:nil excludingNode:nil];
+}
+
+#pragma mark - KVO
+
+- (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary<NSKeyValueChangeKey,id> *)change context:(void *)context {
+    if (context == SDShardedMemoryCacheContext) {
+        if ([keyPath isEqualToString:NSStringFromSelector(@selector(maxMemoryCost))] ||
+            [keyPath isEqualToString:NSStringFromSelector(@selector(maxMemoryCount))]) {
+            [self updateLimits];
+        }
+    } else {
+        [super observeValueForKeyPath:keyPath ofObject:object change:change context:context];
+    }
+}
+
+@end
@@ -11,6 +11,8 @@
 #import "NSImage+Compatibility.h"
 #import "SDAnimatedImage.h"
 #import "SDAssociatedObject.h"
+#import "SDImageFrame.h"
+#import "SDFrameSequenceImage.h"
 
 #pragma mark - Image scale
 
@@ -91,6 +93,20 @@ inline UIImage * _Nullable SDScaledImageForScaleFactor(CGFloat scale, UIImage *
     if (image.sd_isAnimated) {
         UIImage *animatedImage;
 #if SD_UIKIT || SD_WATCH
+        if ([image isKindOfClass:[SDFrameSequenceImage class]] && ((SDFrameSequenceImage *)image).frames.count > 0) {
+            // Scale the distinct frames only, keep the duration table
+            NSArray<SDImageFrame *> *frames = ((SDFrameSequenceImage *)image).frames;
+            NSMutableArray<SDImageFrame *> *scaledFrames = [NSMutableArray arrayWithCapacity:frames.count];
+            for (SDImageFrame *frame in frames) {
+                UIImage *tempScaledImage = [[UIImage alloc] initWithCGImage:frame.image.CGImage scale:scale orientation:frame.image.imageOrientation];
+                [scaledFrames addObject:[SDImageFrame frameWithImage:tempScaledImage duration:frame.duration]];
+            }
+            scaledImage = [[SDFrameSequenceImage alloc] initWithFrames:scaledFrames];
+            if (scaledImage) {
+                SDImageCopyAssociatedObject(image, scaledImage);
+                return scaledImage;
+            }
+        }
         // `UIAnimatedImage` images share the same size and scale.
         NSArray<UIImage *> *images = image.images;
         NSMutableArray<UIImage *> *scaledImages = [NSMutableArray arrayWithCapacity:images.count];
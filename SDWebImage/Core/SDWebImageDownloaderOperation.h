@@ -48,6 +48,25 @@
 @property (copy, nonatomic, nullable) NSIndexSet *acceptableStatusCodes;
 @property (copy, nonatomic, nullable) NSSet<NSString *> *acceptableContentTypes;
 
+/**
+ * The shared operation queue to decode the downloaded image data, used by all the downloader operations.
+ * The different decode variants (like different thumbnail pixel sizes) of the same download are decoded in parallel, and the total number of concurrent decoding in process is bounded by this queue.
+ * Defaults `maxConcurrentOperationCount` to the active processor count. You can change it to limit the CPU usage for decoding.
+ */
+@property (class, nonatomic, strong, readonly, nonnull) NSOperationQueue *decodeQueue;
+
+/**
+ * The number of thumbnail variants which are produced by downscaling an already decoded larger variant from the same download, instead of decoding the image data again.
+ * This is counted for all the downloader operations.
+ */
+@property (class, nonatomic, assign, readonly) NSUInteger derivedVariantCount;
+
+/**
+ * The estimated decoding time saved by the derived thumbnail variants, in seconds. Each derivation is compared with the average duration of the real variant decoding.
+ * This is counted for all the downloader operations.
+ */
+@property (class, nonatomic, assign, readonly) NSTimeInterval derivedVariantSavedDuration;
+
 @end
 
 
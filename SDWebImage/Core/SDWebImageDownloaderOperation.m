@@ -13,6 +13,80 @@
 #import "SDWebImageDownloaderDecryptor.h"
 #import "SDImageCacheDefine.h"
 #import "SDCallbackQueue.h"
+#import "SDImageCache.h"
+#import "SDChunkedData.h"
+#import "SDImageCoderHelper.h"
+#import "SDAnimatedImage.h"
+#import "UIImage+Metadata.h"
+#import "UIImage+ForceDecode.h"
+#include <stdatomic.h>
+
+// The statistics of variant derivation, shared by all operations. Durations are in microseconds
+static atomic_ullong SDDecodedVariantCount;
+static atomic_ullong SDDecodedVariantDuration;
+static atomic_ullong SDDerivedVariantCount;
+static atomic_ullong SDDerivedVariantSavedDuration;
+
+static inline CGSize SDThumbnailPixelSizeFromDecodeOptions(SDImageCoderOptions * _Nullable decodeOptions) {
+    CGSize thumbnailSize = CGSizeZero;
+    NSValue *thumbnailSizeValue = decodeOptions[SDImageCoderDecodeThumbnailPixelSize];
+    if (thumbnailSizeValue != nil) {
+#if SD_MAC
+        thumbnailSize = thumbnailSizeValue.sizeValue;
+#else
+        thumbnailSize = thumbnailSizeValue.CGSizeValue;
+#endif
+    }
+    return thumbnailSize;
+}
+
+static inline BOOL SDPreserveAspectRatioFromDecodeOptions(SDImageCoderOptions * _Nullable decodeOptions) {
+    NSNumber *preserveAspectRatioValue = decodeOptions[SDImageCoderDecodePreserveAspectRatio];
+    return preserveAspectRatioValue != nil ? preserveAspectRatioValue.boolValue : YES;
+}
+
+// Whether the target variant can be produced by downscaling the source variant. Only the thumbnail size can be different, and the source should keep aspect ratio
+static BOOL SDCanDeriveDecodeOptions(SDImageCoderOptions * _Nonnull sourceOptions, SDImageCoderOptions * _Nonnull targetOptions) {
+    CGSize sourceSize = SDThumbnailPixelSizeFromDecodeOptions(sourceOptions);
+    if (sourceSize.width > 0 && sourceSize.height > 0 && !SDPreserveAspectRatioFromDecodeOptions(sourceOptions)) {
+        return NO;
+    }
+    NSArray<SDImageCoderOption> *variantKeys = @[SDImageCoderDecodeThumbnailPixelSize, SDImageCoderDecodePreserveAspectRatio];
+    NSMutableDictionary *mutableSourceOptions = [sourceOptions mutableCopy];
+    NSMutableDictionary *mutableTargetOptions = [targetOptions mutableCopy];
+    [mutableSourceOptions removeObjectsForKeys:variantKeys];
+    [mutableTargetOptions removeObjectsForKeys:variantKeys];
+    return [mutableSourceOptions isEqualToDictionary:mutableTargetOptions];
+}
+
+// The target pixel size when derive from source image, or zero size if the source is not larger than the target
+static CGSize SDDerivedPixelSize(UIImage * _Nonnull sourceImage, SDImageCoderOptions * _Nonnull targetOptions) {
+    CGImageRef cgImage = sourceImage.CGImage;
+    CGSize thumbnailSize = SDThumbnailPixelSizeFromDecodeOptions(targetOptions);
+    if (!cgImage || thumbnailSize.width <= 0 || thumbnailSize.height <= 0) {
+        return CGSizeZero;
+    }
+    // Animated image and vector image can not be derived from a bitmap
+    if (sourceImage.sd_isAnimated || sourceImage.sd_isVector || [sourceImage conformsToProtocol:@protocol(SDAnimatedImage)]) {
+        return CGSizeZero;
+    }
+#if SD_UIKIT || SD_WATCH
+    // The thumbnail decoding apply the EXIF orientation to bitmap, keep simple
+    if (sourceImage.imageOrientation != UIImageOrientationUp) {
+        return CGSizeZero;
+    }
+#endif
+    CGSize sourceSize = CGSizeMake(CGImageGetWidth(cgImage), CGImageGetHeight(cgImage));
+    if (sourceSize.width <= thumbnailSize.width && sourceSize.height <= thumbnailSize.height) {
+        return CGSizeZero;
+    }
+    CGSize targetSize = [SDImageCoderHelper scaledSizeWithImageSize:sourceSize scaleSize:thumbnailSize preserveAspectRatio:SDPreserveAspectRatioFromDecodeOptions(targetOptions) shouldScaleUp:NO];
+    targetSize = CGSizeMake(round(targetSize.width), round(targetSize.height));
+    if (targetSize.width < 1 || targetSize.height < 1) {
+        return CGSizeZero;
+    }
+    return targetSize;
+}
 
 // A handler to represent individual request
 @interface SDWebImageDownloaderOperationToken : NSObject
@@ -52,7 +126,7 @@
 
 @property (assign, nonatomic, getter = isExecuting) BOOL executing;
 @property (assign, nonatomic, getter = isFinished) BOOL finished;
-@property (strong, nonatomic, nullable) NSMutableData *imageData;
+@property (strong, nonatomic, nullable) SDChunkedData *imageData; // received chunks, joined only when decoder need contiguous bytes
 @property (copy, nonatomic, nullable) NSData *cachedData; // for `SDWebImageDownloaderIgnoreCachedResponse`
 @property (assign, nonatomic) NSUInteger expectedSize; // may be 0
 @property (assign, nonatomic) NSUInteger receivedSize;
@@ -75,7 +149,8 @@
 
 @property (strong, nonatomic, readwrite, nullable) NSURLSessionTaskMetrics *metrics API_AVAILABLE(macos(10.12), ios(10.0), watchos(3.0), tvos(10.0));
 
-@property (strong, nonatomic, nonnull) NSOperationQueue *coderQueue; // the serial operation queue to do image decoding
+@property (strong, nonatomic, nonnull) NSHashTable<NSOperation *> *decodeOperations; // the pending decode operations submitted to the shared decode queue
+@property (weak, nonatomic, nullable) NSOperation *progressiveOperation; // the latest progressive decode operation
 
 @property (strong, nonatomic, nonnull) NSMapTable<SDImageCoderOptions *, UIImage *> *imageMap; // each variant of image is weak-referenced to avoid too many re-decode during downloading
 #if SD_UIKIT
@@ -113,9 +188,7 @@
         _expectedSize = 0;
         _unownedSession = session;
         _downloadCompleted = NO;
-        _coderQueue = [[NSOperationQueue alloc] init];
-        _coderQueue.maxConcurrentOperationCount = 1;
-        _coderQueue.name = @"com.hackemist.SDWebImageDownloaderOperation.coderQueue";
+        _decodeOperations = [NSHashTable weakObjectsHashTable];
         _imageMap = [[NSMapTable alloc] initWithKeyOptions:NSPointerFunctionsStrongMemory valueOptions:NSPointerFunctionsWeakMemory capacity:1];
 #if SD_UIKIT
         _backgroundTaskId = UIBackgroundTaskInvalid;
@@ -124,6 +197,25 @@
     return self;
 }
 
++ (NSOperationQueue *)decodeQueue {
+    static dispatch_once_t onceToken;
+    static NSOperationQueue *decodeQueue;
+    dispatch_once(&onceToken, ^{
+        decodeQueue = [[NSOperationQueue alloc] init];
+        decodeQueue.maxConcurrentOperationCount = NSProcessInfo.processInfo.activeProcessorCount;
+        decodeQueue.name = @"com.hackemist.SDWebImageDownloaderOperation.decodeQueue";
+    });
+    return decodeQueue;
+}
+
++ (NSUInteger)derivedVariantCount {
+    return (NSUInteger)atomic_load_explicit(&SDDerivedVariantCount, memory_order_relaxed);
+}
+
++ (NSTimeInterval)derivedVariantSavedDuration {
+    return atomic_load_explicit(&SDDerivedVariantSavedDuration, memory_order_relaxed) / (double)USEC_PER_SEC;
+}
+
 - (nullable id)addHandlersForProgress:(nullable SDWebImageDownloaderProgressBlock)progressBlock
                             completed:(nullable SDWebImageDownloaderCompletedBlock)completedBlock {
     return [self addHandlersForProgress:progressBlock completed:completedBlock decodeOptions:nil];
@@ -282,6 +374,9 @@
         self.dataTask = nil;
     }
     
+    // The decoding result is useless now
+    [self cancelDecodeOperations];
+    
     // NSOperation disallow setFinished=YES **before** operation's start method been called
     // We check for the initialized status, which is isExecuting == NO && isFinished = NO
     // Ony update for non-intialized status, which is !(isExecuting == NO && isFinished = NO), or if (self.isExecuting || self.isFinished) {...}
@@ -360,51 +455,95 @@
 - (void)startCoderOperationWithImageData:(NSData *)imageData
                            pendingTokens:(NSArray<SDWebImageDownloaderOperationToken *> *)pendingTokens
                           finishedTokens:(NSArray<SDWebImageDownloaderOperationToken *> *)finishedTokens {
-    @weakify(self);
+    // Group the tokens by decode options, each variant is decoded once
+    NSMutableArray<SDImageCoderOptions *> *variants = [NSMutableArray array];
+    NSMutableDictionary<SDImageCoderOptions *, NSMutableArray<SDWebImageDownloaderOperationToken *> *> *variantTokens = [NSMutableDictionary dictionary];
+    NSMutableArray<SDWebImageDownloaderOperationToken *> *defaultTokens = [NSMutableArray array];
     for (SDWebImageDownloaderOperationToken *token in pendingTokens) {
-        [self.coderQueue addOperationWithBlock:^{
+        if (!token.decodeOptions) {
+            [defaultTokens addObject:token];
+            continue;
+        }
+        NSMutableArray<SDWebImageDownloaderOperationToken *> *tokens = variantTokens[token.decodeOptions];
+        if (!tokens) {
+            tokens = [NSMutableArray array];
+            variantTokens[token.decodeOptions] = tokens;
+            [variants addObject:token.decodeOptions];
+        }
+        [tokens addObject:token];
+    }
+    
+    // Decode the larger variant first, the smaller variant may be derived from it
+    [variants sortUsingComparator:^NSComparisonResult(SDImageCoderOptions *options1, SDImageCoderOptions *options2) {
+        CGSize size1 = SDThumbnailPixelSizeFromDecodeOptions(options1);
+        CGSize size2 = SDThumbnailPixelSizeFromDecodeOptions(options2);
+        CGFloat area1 = size1.width > 0 && size1.height > 0 ? size1.width * size1.height : CGFLOAT_MAX;
+        CGFloat area2 = size2.width > 0 && size2.height > 0 ? size2.width * size2.height : CGFLOAT_MAX;
+        if (area1 > area2) {
+            return NSOrderedAscending;
+        } else if (area1 < area2) {
+            return NSOrderedDescending;
+        }
+        return NSOrderedSame;
+    }];
+    
+    // The progressive coder is stateful, it can not be used by multiple decoding at the same time
+    id<SDProgressiveImageCoder> progressiveCoder = SDImageLoaderGetProgressiveCoder(self);
+    NSOperation *previousOperation = progressiveCoder ? self.progressiveOperation : nil;
+    NSMutableArray<NSOperation *> *operations = [NSMutableArray arrayWithCapacity:variants.count + 1];
+    @weakify(self);
+    // The variants which decode from image data, the other variants are derived from them
+    NSMutableDictionary<SDImageCoderOptions *, NSOperation *> *rootOperations = [NSMutableDictionary dictionary];
+    void(^addDecodeOperation)(SDImageCoderOptions *, NSArray<SDWebImageDownloaderOperationToken *> *) = ^(SDImageCoderOptions *decodeOptions, NSArray<SDWebImageDownloaderOperationToken *> *tokens) {
+        NSOperation *operation = [NSBlockOperation blockOperationWithBlock:^{
             @strongify(self);
             if (!self) {
                 return;
             }
-            UIImage *image;
-            // check if we already decode this variant of image for current callback
-            if (token.decodeOptions) {
-                image = [self.imageMap objectForKey:token.decodeOptions];
+            UIImage *image = [self decodedImageWithImageData:imageData decodeOptions:decodeOptions];
+            for (SDWebImageDownloaderOperationToken *token in tokens) {
+                [self callCompletionBlockWithToken:token image:image imageData:imageData];
             }
-            if (!image) {
-                // check if we already use progressive decoding, use that to produce faster decoding
-                id<SDProgressiveImageCoder> progressiveCoder = SDImageLoaderGetProgressiveCoder(self);
-                SDWebImageOptions options = [[self class] imageOptionsFromDownloaderOptions:self.options];
-                SDWebImageContext *context;
-                if (token.decodeOptions) {
-                    SDWebImageMutableContext *mutableContext = [NSMutableDictionary dictionaryWithDictionary:self.context];
-                    SDSetDecodeOptionsToContext(mutableContext, &options, token.decodeOptions);
-                    context = [mutableContext copy];
-                } else {
-                    context = self.context;
-                }
-                if (progressiveCoder) {
-                    image = SDImageLoaderDecodeProgressiveImageData(imageData, self.request.URL, YES, self, options, context);
-                } else {
-                    image = SDImageLoaderDecodeImageData(imageData, self.request.URL, options, context);
+        }];
+        if (previousOperation) {
+            [operation addDependency:previousOperation];
+        } else if (decodeOptions) {
+            // wait for the largest compatible variant which decode from data only, so this one can be derived by downscaling it
+            // The derived variants do not wait for each other, they are derived in parallel
+            NSOperation *rootOperation;
+            for (SDImageCoderOptions *largerOptions in variants) {
+                if (largerOptions == decodeOptions) {
+                    break;
                 }
-                if (image && token.decodeOptions) {
-                    [self.imageMap setObject:image forKey:token.decodeOptions];
+                NSOperation *largerOperation = rootOperations[largerOptions];
+                if (largerOperation && SDCanDeriveDecodeOptions(largerOptions, decodeOptions)) {
+                    rootOperation = largerOperation;
+                    break;
                 }
             }
-            CGSize imageSize = image.size;
-            if (imageSize.width == 0 || imageSize.height == 0) {
-                NSString *description = image == nil ? @"Downloaded image decode failed" : @"Downloaded image has 0 pixels";
-                NSError *error = [NSError errorWithDomain:SDWebImageErrorDomain code:SDWebImageErrorBadImageData userInfo:@{NSLocalizedDescriptionKey : description}];
-                [self callCompletionBlockWithToken:token image:nil imageData:nil error:error finished:YES];
+            if (rootOperation) {
+                [operation addDependency:rootOperation];
             } else {
-                [self callCompletionBlockWithToken:token image:image imageData:imageData error:nil finished:YES];
+                rootOperations[decodeOptions] = operation;
             }
-        }];
+        }
+        [operations addObject:operation];
+    };
+    if (defaultTokens.count > 0) {
+        addDecodeOperation(nil, defaultTokens);
+        if (progressiveCoder) {
+            previousOperation = operations.lastObject;
+        }
     }
+    for (SDImageCoderOptions *decodeOptions in variants) {
+        addDecodeOperation(decodeOptions, variantTokens[decodeOptions]);
+        if (progressiveCoder) {
+            previousOperation = operations.lastObject;
+        }
+    }
+    
     // call [self done] after all completed block was dispatched
-    dispatch_block_t doneBlock = ^{
+    NSOperation *doneOperation = [NSBlockOperation blockOperationWithBlock:^{
         @strongify(self);
         if (!self) {
             return;
@@ -412,15 +551,140 @@
         // Check for new tokens added during the decode operation.
         [self checkDoneWithImageData:imageData
                       finishedTokens:[finishedTokens arrayByAddingObjectsFromArray:pendingTokens]];
-    };
-    if (@available(iOS 13, tvOS 13, macOS 10.15, watchOS 6, *)) {
-        // seems faster than `addOperationWithBlock`
-        [self.coderQueue addBarrierBlock:doneBlock];
+    }];
+    for (NSOperation *operation in operations) {
+        [doneOperation addDependency:operation];
+    }
+    [operations addObject:doneOperation];
+    @synchronized (self.decodeOperations) {
+        for (NSOperation *operation in operations) {
+            [self.decodeOperations addObject:operation];
+        }
+    }
+    [SDWebImageDownloaderOperation.decodeQueue addOperations:operations waitUntilFinished:NO];
+}
+
+- (nullable UIImage *)decodedImageWithImageData:(NSData *)imageData decodeOptions:(nullable SDImageCoderOptions *)decodeOptions {
+    UIImage *image;
+    // check if we already decode this variant of image for current callback
+    if (decodeOptions) {
+        @synchronized (self.imageMap) {
+            image = [self.imageMap objectForKey:decodeOptions];
+        }
+    }
+    if (!image && decodeOptions) {
+        // check if we can downscale from a larger decoded variant
+        CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+        image = [self derivedImageWithDecodeOptions:decodeOptions];
+        if (image) {
+            unsigned long long duration = (unsigned long long)((CFAbsoluteTimeGetCurrent() - startTime) * USEC_PER_SEC);
+            unsigned long long decodedCount = atomic_load_explicit(&SDDecodedVariantCount, memory_order_relaxed);
+            unsigned long long averageDecodeDuration = decodedCount > 0 ? atomic_load_explicit(&SDDecodedVariantDuration, memory_order_relaxed) / decodedCount : 0;
+            atomic_fetch_add_explicit(&SDDerivedVariantCount, 1, memory_order_relaxed);
+            if (averageDecodeDuration > duration) {
+                atomic_fetch_add_explicit(&SDDerivedVariantSavedDuration, averageDecodeDuration - duration, memory_order_relaxed);
+            }
+            @synchronized (self.imageMap) {
+                [self.imageMap setObject:image forKey:decodeOptions];
+            }
+        }
+    }
+    if (!image) {
+        CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+        // check if we already use progressive decoding, use that to produce faster decoding
+        id<SDProgressiveImageCoder> progressiveCoder = SDImageLoaderGetProgressiveCoder(self);
+        SDWebImageOptions options = [[self class] imageOptionsFromDownloaderOptions:self.options];
+        SDWebImageContext *context;
+        if (decodeOptions) {
+            SDWebImageMutableContext *mutableContext = [NSMutableDictionary dictionaryWithDictionary:self.context];
+            SDSetDecodeOptionsToContext(mutableContext, &options, decodeOptions);
+            context = [mutableContext copy];
+        } else {
+            context = self.context;
+        }
+        if (progressiveCoder) {
+            image = SDImageLoaderDecodeProgressiveImageData(imageData, self.request.URL, YES, self, options, context);
+        } else {
+            image = SDImageLoaderDecodeImageData(imageData, self.request.URL, options, context);
+        }
+        if (image && decodeOptions) {
+            @synchronized (self.imageMap) {
+                [self.imageMap setObject:image forKey:decodeOptions];
+            }
+        }
+        if (image && !progressiveCoder) {
+            atomic_fetch_add_explicit(&SDDecodedVariantCount, 1, memory_order_relaxed);
+            atomic_fetch_add_explicit(&SDDecodedVariantDuration, (unsigned long long)((CFAbsoluteTimeGetCurrent() - startTime) * USEC_PER_SEC), memory_order_relaxed);
+        }
+    }
+    return image;
+}
+
+// Produce the thumbnail variant by downscaling the smallest larger variant in image map. Only the images decoded by this operation are used, the memory cache may hold stale pixels for the same key
+- (nullable UIImage *)derivedImageWithDecodeOptions:(nonnull SDImageCoderOptions *)decodeOptions {
+    if (self.context[SDWebImageContextAnimatedImageClass]) {
+        // The custom image class need decoding
+        return nil;
+    }
+    UIImage *sourceImage;
+    CGSize targetSize = CGSizeZero;
+    @synchronized (self.imageMap) {
+        for (SDImageCoderOptions *options in self.imageMap.keyEnumerator) {
+            UIImage *image = [self.imageMap objectForKey:options];
+            if (!image || !SDCanDeriveDecodeOptions(options, decodeOptions)) {
+                continue;
+            }
+            CGSize size = SDDerivedPixelSize(image, decodeOptions);
+            if (size.width == 0) {
+                continue;
+            }
+            if (!sourceImage || CGImageGetWidth(image.CGImage) < CGImageGetWidth(sourceImage.CGImage)) {
+                sourceImage = image;
+                targetSize = size;
+            }
+        }
+    }
+    if (!sourceImage || targetSize.width == 0) {
+        return nil;
+    }
+    CGImageRef scaledImageRef = [SDImageCoderHelper CGImageCreateScaled:sourceImage.CGImage size:targetSize];
+    if (!scaledImageRef) {
+        return nil;
+    }
+    NSNumber *scaleValue = decodeOptions[SDImageCoderDecodeScaleFactor];
+    CGFloat scale = scaleValue.doubleValue >= 1 ? scaleValue.doubleValue : sourceImage.scale;
+#if SD_MAC
+    UIImage *image = [[UIImage alloc] initWithCGImage:scaledImageRef scale:scale orientation:kCGImagePropertyOrientationUp];
+#else
+    UIImage *image = [[UIImage alloc] initWithCGImage:scaledImageRef scale:scale orientation:UIImageOrientationUp];
+#endif
+    CGImageRelease(scaledImageRef);
+    image.sd_imageFormat = sourceImage.sd_imageFormat;
+    image.sd_isDecoded = YES;
+    image.sd_decodeOptions = decodeOptions;
+    return image;
+}
+
+- (void)callCompletionBlockWithToken:(nonnull SDWebImageDownloaderOperationToken *)token image:(nullable UIImage *)image imageData:(nonnull NSData *)imageData {
+    CGSize imageSize = image.size;
+    if (imageSize.width == 0 || imageSize.height == 0) {
+        NSString *description = image == nil ? @"Downloaded image decode failed" : @"Downloaded image has 0 pixels";
+        NSError *error = [NSError errorWithDomain:SDWebImageErrorDomain code:SDWebImageErrorBadImageData userInfo:@{NSLocalizedDescriptionKey : description}];
+        [self callCompletionBlockWithToken:token image:nil imageData:nil error:error finished:YES];
     } else {
-        // serial queue, this does the same effect in semantics
-        [self.coderQueue addOperationWithBlock:doneBlock];
+        [self callCompletionBlockWithToken:token image:image imageData:imageData error:nil finished:YES];
     }
+}
 
+- (void)cancelDecodeOperations {
+    NSArray<NSOperation *> *operations;
+    @synchronized (self.decodeOperations) {
+        operations = self.decodeOperations.allObjects;
+        [self.decodeOperations removeAllObjects];
+    }
+    for (NSOperation *operation in operations) {
+        [operation cancel];
+    }
 }
 
 #pragma mark NSURLSessionDataDelegate
@@ -512,7 +776,7 @@ didReceiveResponse:(NSURLResponse *)response
 
 - (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveData:(NSData *)data {
     if (!self.imageData) {
-        self.imageData = [[NSMutableData alloc] initWithCapacity:self.expectedSize];
+        self.imageData = [[SDChunkedData alloc] init];
     }
     [self.imageData appendData:data];
     
@@ -549,14 +813,14 @@ didReceiveResponse:(NSURLResponse *)response
     // We currently only pick the first thumbnail size, see #3423 talks
     // Progressive decoding Only decode partial image, full image in `URLSession:task:didCompleteWithError:`
     if (supportProgressive && !finished) {
-        // Get the image data
-        NSData *imageData = self.imageData;
-        
-        // keep maximum one progressive decode process during download
-        if (imageData && self.coderQueue.operationCount == 0) {
+        // keep maximum one progressive decode process during download, check it before joining the data
+        NSOperation *progressiveOperation = self.progressiveOperation;
+        if (!progressiveOperation || progressiveOperation.isFinished) {
+            // Get the image data snapshot, joined only when a new decode is enqueued. ImageIO need contiguous bytes, a non-contiguous snapshot would be joined again on each `bytes` access
+            NSData *imageData = [self.imageData contiguousData];
             // NSOperation have autoreleasepool, don't need to create extra one
             @weakify(self);
-            [self.coderQueue addOperationWithBlock:^{
+            NSOperation *operation = [NSBlockOperation blockOperationWithBlock:^{
                 @strongify(self);
                 if (!self) {
                     return;
@@ -574,6 +838,11 @@ didReceiveResponse:(NSURLResponse *)response
                     [self callCompletionBlocksWithImage:image imageData:nil error:nil finished:NO];
                 }
             }];
+            self.progressiveOperation = operation;
+            @synchronized (self.decodeOperations) {
+                [self.decodeOperations addObject:operation];
+            }
+            [SDWebImageDownloaderOperation.decodeQueue addOperation:operation];
         }
     }
     
@@ -631,7 +900,8 @@ didReceiveResponse:(NSURLResponse *)response
         [self done];
     } else {
         if (tokens.count > 0) {
-            NSData *imageData = self.imageData;
+            // Join the received chunks once, all the variants decoding share the contiguous buffer
+            NSData *imageData = [self.imageData contiguousData];
             // data decryptor
             if (imageData && self.decryptor) {
                 imageData = [self.decryptor decryptedDataWithData:imageData response:self.response];
@@ -649,8 +919,8 @@ didReceiveResponse:(NSURLResponse *)response
                     [self callCompletionBlocksWithError:self.responseError];
                     [self done];
                 } else {
-                    // decode the image in coder queue, cancel all previous decoding process
-                    [self.coderQueue cancelAllOperations];
+                    // decode the image in shared decode queue, cancel all previous decoding process
+                    [self cancelDecodeOperations];
                     [self startCoderOperationWithImageData:imageData
                                              pendingTokens:tokens
                                             finishedTokens:@[]];
@@ -42,6 +42,16 @@ typedef void(^SDInternalCompletionBlock)(UIImage * _Nullable image, NSData * _Nu
  */
 @property (strong, nonatomic, nullable, readonly) id<SDWebImageOperation> loaderOperation;
 
+/**
+ The time in seconds the transform waited in the manager's transform queue before running. 0 if no transform is applied.
+ */
+@property (assign, nonatomic, readonly) NSTimeInterval transformQueueDuration;
+
+/**
+ The time in seconds the transformer took to transform the image. 0 if no transform is applied.
+ */
+@property (assign, nonatomic, readonly) NSTimeInterval transformDuration;
+
 @end
 
 
@@ -122,6 +132,12 @@ SDWebImageManager *manager = [SDWebImageManager sharedManager];
  */
 @property (strong, nonatomic, nullable) id<SDImageTransformer> transformer;
 
+/**
+ The maximum number of concurrent image transforms. The transforms are run in a manager's own queue, ordered by `SDWebImageHighPriority` and `SDWebImageLowPriority` options. The pending transform of a cancelled operation is dropped without running the transformer.
+ Defaults to the active processor count.
+ */
+@property (assign, nonatomic) NSUInteger maxConcurrentTransformCount;
+
 /**
  * The cache filter is used to convert an URL into a cache key each time SDWebImageManager need cache key to use image cache.
  *
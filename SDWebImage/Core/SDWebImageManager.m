@@ -24,6 +24,9 @@ static id<SDImageLoader> _defaultImageLoader;
 @property (strong, nonatomic, readwrite, nullable) id<SDWebImageOperation> loaderOperation;
 @property (strong, nonatomic, readwrite, nullable) id<SDWebImageOperation> cacheOperation;
 @property (weak, nonatomic, nullable) SDWebImageManager *manager;
+@property (weak, nonatomic, nullable) NSOperation *transformOperation;
+@property (assign, nonatomic, readwrite) NSTimeInterval transformQueueDuration;
+@property (assign, nonatomic, readwrite) NSTimeInterval transformDuration;
 
 @end
 
@@ -36,6 +39,7 @@ static id<SDImageLoader> _defaultImageLoader;
 @property (strong, nonatomic, readwrite, nonnull) id<SDImageLoader> imageLoader;
 @property (strong, nonatomic, nonnull) NSMutableSet<NSURL *> *failedURLs;
 @property (strong, nonatomic, nonnull) NSMutableSet<SDWebImageCombinedOperation *> *runningOperations;
+@property (strong, nonatomic, nonnull) NSOperationQueue *transformQueue;
 
 @end
 
@@ -92,10 +96,25 @@ static id<SDImageLoader> _defaultImageLoader;
         SD_LOCK_INIT(_failedURLsLock);
         _runningOperations = [NSMutableSet new];
         SD_LOCK_INIT(_runningOperationsLock);
+        _transformQueue = [NSOperationQueue new];
+        _transformQueue.name = @"com.hackemist.SDWebImageManager.transformQueue";
+        _transformQueue.qualityOfService = NSQualityOfServiceUserInitiated;
+        _transformQueue.maxConcurrentOperationCount = NSProcessInfo.processInfo.activeProcessorCount;
     }
     return self;
 }
 
+- (NSUInteger)maxConcurrentTransformCount {
+    return self.transformQueue.maxConcurrentOperationCount;
+}
+
+- (void)setMaxConcurrentTransformCount:(NSUInteger)maxConcurrentTransformCount {
+    if (maxConcurrentTransformCount == 0) {
+        maxConcurrentTransformCount = NSProcessInfo.processInfo.activeProcessorCount;
+    }
+    self.transformQueue.maxConcurrentOperationCount = maxConcurrentTransformCount;
+}
+
 - (nullable NSString *)cacheKeyForURL:(nullable NSURL *)url {
     if (!url) {
         return @"";
@@ -506,9 +525,18 @@ static id<SDImageLoader> _defaultImageLoader;
     if (shouldTransformImage) {
         // transformed cache key
         NSString *key = [self cacheKeyForURL:url context:context];
-        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_HIGH, 0), ^{
+        CFAbsoluteTime enqueueTime = CFAbsoluteTimeGetCurrent();
+        NSOperation *transformOperation = [NSBlockOperation blockOperationWithBlock:^{
+            if (operation.isCancelled) {
+                // The view does not need this image any more, drop the transform
+                [self callCompletionBlockForOperation:operation completion:completedBlock error:[NSError errorWithDomain:SDWebImageErrorDomain code:SDWebImageErrorCancelled userInfo:@{NSLocalizedDescriptionKey : @"Operation cancelled by user before transforming the image"}] queue:context[SDWebImageContextCallbackQueue] url:url];
+                return;
+            }
+            CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
             // Case that transformer on thumbnail, which this time need full pixel image
             UIImage *transformedImage = [transformer transformedImageWithImage:cacheImage forKey:key];
+            operation.transformQueueDuration = startTime - enqueueTime;
+            operation.transformDuration = CFAbsoluteTimeGetCurrent() - startTime;
             if (transformedImage) {
                 // We need keep some metadata from the full size image when needed
                 // Because most of our transformer does not care about these information
@@ -526,7 +554,14 @@ static id<SDImageLoader> _defaultImageLoader;
             } else {
                 [self callStoreOriginCacheProcessForOperation:operation url:url options:options context:context originalImage:originalImage cacheImage:cacheImage originalData:originalData cacheData:cacheData cacheType:cacheType finished:finished completed:completedBlock];
             }
-        });
+        }];
+        if (options & SDWebImageHighPriority) {
+            transformOperation.queuePriority = NSOperationQueuePriorityHigh;
+        } else if (options & SDWebImageLowPriority) {
+            transformOperation.queuePriority = NSOperationQueuePriorityLow;
+        }
+        operation.transformOperation = transformOperation;
+        [self.transformQueue addOperation:transformOperation];
     } else {
         [self callStoreOriginCacheProcessForOperation:operation url:url options:options context:context originalImage:originalImage cacheImage:cacheImage originalData:originalData cacheData:cacheData cacheType:cacheType finished:finished completed:completedBlock];
     }
@@ -793,6 +828,11 @@ static id<SDImageLoader> _defaultImageLoader;
             [self.loaderOperation cancel];
             self.loaderOperation = nil;
         }
+        NSOperation *transformOperation = self.transformOperation;
+        if (transformOperation && !transformOperation.isExecuting && !transformOperation.isFinished) {
+            // Let the pending transform leave the queue first, it only callback the cancelled error without transforming
+            transformOperation.queuePriority = NSOperationQueuePriorityVeryHigh;
+        }
         [self.manager safelyRemoveOperationFromRunning:self];
     }
 }
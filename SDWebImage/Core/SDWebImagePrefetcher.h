@@ -53,6 +53,15 @@
  */
 - (void)imagePrefetcher:(nonnull SDWebImagePrefetcher *)imagePrefetcher didFinishWithTotalCount:(NSUInteger)totalCount skippedCount:(NSUInteger)skippedCount;
 
+/**
+ * Called when an image in the working set was prefetched (successful or not), see `updateWorkingSetWithScores:options:context:`.
+ *
+ * @param imagePrefetcher The current image prefetcher
+ * @param imageURL        The image url that was prefetched
+ * @param error           The error if prefetch failed
+ */
+- (void)imagePrefetcher:(nonnull SDWebImagePrefetcher *)imagePrefetcher didPrefetchWorkingSetURL:(nonnull NSURL *)imageURL error:(nullable NSError *)error;
+
 @end
 
 typedef void(^SDWebImagePrefetcherProgressBlock)(NSUInteger noOfFinishedUrls, NSUInteger noOfTotalUrls);
@@ -160,9 +169,42 @@ typedef void(^SDWebImagePrefetcherCompletionBlock)(NSUInteger noOfFinishedUrls,
                                          completed:(nullable SDWebImagePrefetcherCompletionBlock)completionBlock;
 
 /**
- * Remove and cancel all the prefeching for the prefetcher.
+ * Remove and cancel all the prefeching for the prefetcher, including the working set.
  */
 - (void)cancelPrefetching;
 
+#pragma mark - Working Set
+
+/**
+ * Update the working set to prefetch with scores, such as the distance from the viewport for an infinite feed. Call this on each scroll update.
+ * The lower score is more urgent. The URL with score less than or equal to 0 is considered visible (inside the viewport).
+ * - The pending URLs are reordered by the new scores, and start in order when `maxConcurrentPrefetchCount` allows.
+ * - The URLs which leave the working set are cancelled if they are still loading.
+ * - The URLs which become visible are promoted to high priority, including the running download.
+ * @note The working set is separate from the URL list prefetching above. The `options` and `context` apply to the URLs started after this call.
+ *
+ * @param scores  The URLs of current working set and their scores
+ * @param options The options to use when downloading the image. Typically `SDWebImageLowPriority`, the visible URL is always downloaded with `SDWebImageHighPriority`.
+ * @param context A context contains different options to perform specify changes or processes, see `SDWebImageContextOption`.
+ */
+- (void)updateWorkingSetWithScores:(nonnull NSDictionary<NSURL *, NSNumber *> *)scores
+                           options:(SDWebImageOptions)options
+                           context:(nullable SDWebImageContext *)context;
+
+/**
+ * The number of working set prefetches which finished and then became visible. Which means the prefetch was useful.
+ */
+@property (nonatomic, assign, readonly) NSUInteger usedPrefetchCount;
+
+/**
+ * The number of working set prefetches which finished but left the working set without becoming visible. Which means the prefetch was wasted.
+ */
+@property (nonatomic, assign, readonly) NSUInteger wastedPrefetchCount;
+
+/**
+ * The number of working set prefetches which left the working set and were cancelled while loading.
+ */
+@property (nonatomic, assign, readonly) NSUInteger cancelledPrefetchCount;
+
 
 @end
@@ -9,6 +9,7 @@
 #import "SDWebImagePrefetcher.h"
 #import "SDAsyncBlockOperation.h"
 #import "SDCallbackQueue.h"
+#import "SDWebImageDownloader.h"
 #import "SDInternalMacros.h"
 #import <stdatomic.h>
 
@@ -18,6 +19,33 @@
 
 @end
 
+@interface SDWebImageDownloadToken ()
+
+@property (nonatomic, weak, nullable) NSOperation<SDWebImageDownloaderOperation> *downloadOperation;
+
+@end
+
+typedef NS_ENUM(NSUInteger, SDWebImagePrefetchEntryState) {
+    SDWebImagePrefetchEntryStatePending,
+    SDWebImagePrefetchEntryStateLoading,
+    SDWebImagePrefetchEntryStateFinished,
+    SDWebImagePrefetchEntryStateFailed
+};
+
+// One URL in the prefetching working set
+@interface SDWebImagePrefetchEntry : NSObject
+
+@property (nonatomic, strong, nonnull) NSURL *url;
+@property (nonatomic, assign) double score;
+@property (nonatomic, assign) SDWebImagePrefetchEntryState state;
+@property (nonatomic, assign, getter=isVisible) BOOL visible; // Whether it has been visible since entering working set
+@property (nonatomic, strong, nullable) SDWebImageCombinedOperation *operation;
+
+@end
+
+@implementation SDWebImagePrefetchEntry
+@end
+
 @interface SDWebImagePrefetchToken () {
     @public
     // Though current implementation, `SDWebImageManager` completion block is always on main queue. But however, there is no guarantee in docs. And we may introduce config to specify custom queue in the future.
@@ -44,9 +72,17 @@
 
 @end
 
-@interface SDWebImagePrefetcher ()
+@interface SDWebImagePrefetcher () {
+    SD_LOCK_DECLARE(_workingSetLock); // a lock to keep the access to working set thread-safe
+    atomic_ulong _usedPrefetchCount;
+    atomic_ulong _wastedPrefetchCount;
+    atomic_ulong _cancelledPrefetchCount;
+}
 
 @property (strong, nonatomic, nonnull) SDWebImageManager *manager;
+@property (strong, nonatomic, nonnull) NSMutableDictionary<NSURL *, SDWebImagePrefetchEntry *> *workingSetEntries;
+@property (assign, nonatomic) SDWebImageOptions workingSetOptions;
+@property (copy, nonatomic, nullable) SDWebImageContext *workingSetContext;
 @property (strong, atomic, nonnull) NSMutableSet<SDWebImagePrefetchToken *> *runningTokens;
 @property (strong, nonatomic, nonnull) NSOperationQueue *prefetchQueue;
 @property (strong, nonatomic, nullable) SDCallbackQueue *callbackQueue;
@@ -75,6 +111,8 @@
         _options = SDWebImageLowPriority;
         _prefetchQueue = [NSOperationQueue new];
         self.maxConcurrentPrefetchCount = 3;
+        _workingSetEntries = [NSMutableDictionary dictionary];
+        SD_LOCK_INIT(_workingSetLock);
     }
     return self;
 }
@@ -185,6 +223,161 @@
     }
 }
 
+#pragma mark - Working Set
+- (NSUInteger)usedPrefetchCount {
+    return atomic_load_explicit(&_usedPrefetchCount, memory_order_relaxed);
+}
+
+- (NSUInteger)wastedPrefetchCount {
+    return atomic_load_explicit(&_wastedPrefetchCount, memory_order_relaxed);
+}
+
+- (NSUInteger)cancelledPrefetchCount {
+    return atomic_load_explicit(&_cancelledPrefetchCount, memory_order_relaxed);
+}
+
+- (void)updateWorkingSetWithScores:(NSDictionary<NSURL *,NSNumber *> *)scores options:(SDWebImageOptions)options context:(SDWebImageContext *)context {
+    NSMutableArray<SDWebImageCombinedOperation *> *cancelOperations = [NSMutableArray array];
+    NSMutableArray<SDWebImageCombinedOperation *> *promoteOperations = [NSMutableArray array];
+    SD_LOCK(_workingSetLock);
+    self.workingSetOptions = options;
+    self.workingSetContext = context;
+    // Remove the URLs which leave the working set
+    for (NSURL *url in self.workingSetEntries.allKeys) {
+        if (scores[url] != nil) {
+            continue;
+        }
+        SDWebImagePrefetchEntry *entry = self.workingSetEntries[url];
+        [self.workingSetEntries removeObjectForKey:url];
+        if (entry.state == SDWebImagePrefetchEntryStateLoading) {
+            atomic_fetch_add_explicit(&_cancelledPrefetchCount, 1, memory_order_relaxed);
+            if (entry.operation) {
+                [cancelOperations addObject:entry.operation];
+            }
+        } else if (entry.state == SDWebImagePrefetchEntryStateFinished && !entry.isVisible) {
+            atomic_fetch_add_explicit(&_wastedPrefetchCount, 1, memory_order_relaxed);
+        }
+    }
+    // Add the new URLs and update the scores
+    [scores enumerateKeysAndObjectsUsingBlock:^(NSURL * _Nonnull url, NSNumber * _Nonnull score, BOOL * _Nonnull stop) {
+        SDWebImagePrefetchEntry *entry = self.workingSetEntries[url];
+        if (!entry) {
+            entry = [SDWebImagePrefetchEntry new];
+            entry.url = url;
+            entry.state = SDWebImagePrefetchEntryStatePending;
+            self.workingSetEntries[url] = entry;
+        }
+        entry.score = score.doubleValue;
+        if (entry.score <= 0 && !entry.isVisible) {
+            entry.visible = YES;
+            if (entry.state == SDWebImagePrefetchEntryStateFinished) {
+                atomic_fetch_add_explicit(&self->_usedPrefetchCount, 1, memory_order_relaxed);
+            } else if (entry.state == SDWebImagePrefetchEntryStateLoading && entry.operation) {
+                [promoteOperations addObject:entry.operation];
+            }
+        }
+    }];
+    SD_UNLOCK(_workingSetLock);
+    
+    // Call outside the lock, the completion may be called synchronously
+    for (SDWebImageCombinedOperation *operation in cancelOperations) {
+        [operation cancel];
+    }
+    for (SDWebImageCombinedOperation *operation in promoteOperations) {
+        id<SDWebImageOperation> loaderOperation = operation.loaderOperation;
+        if ([loaderOperation isKindOfClass:SDWebImageDownloadToken.class]) {
+            ((SDWebImageDownloadToken *)loaderOperation).downloadOperation.queuePriority = NSOperationQueuePriorityHigh;
+        }
+    }
+    [self startWorkingSetPrefetching];
+}
+
+- (void)startWorkingSetPrefetching {
+    NSArray<SDWebImagePrefetchEntry *> *startEntries;
+    SDWebImageOptions options;
+    SDWebImageContext *context;
+    SD_LOCK(_workingSetLock);
+    NSUInteger loadingCount = 0;
+    NSMutableArray<SDWebImagePrefetchEntry *> *pendingEntries = [NSMutableArray array];
+    for (SDWebImagePrefetchEntry *entry in self.workingSetEntries.objectEnumerator) {
+        if (entry.state == SDWebImagePrefetchEntryStateLoading) {
+            loadingCount++;
+        } else if (entry.state == SDWebImagePrefetchEntryStatePending) {
+            [pendingEntries addObject:entry];
+        }
+    }
+    NSUInteger maxCount = self.maxConcurrentPrefetchCount;
+    NSUInteger startCount = loadingCount < maxCount ? MIN(maxCount - loadingCount, pendingEntries.count) : 0;
+    if (startCount > 0) {
+        [pendingEntries sortUsingComparator:^NSComparisonResult(SDWebImagePrefetchEntry * _Nonnull entry1, SDWebImagePrefetchEntry * _Nonnull entry2) {
+            if (entry1.score < entry2.score) {
+                return NSOrderedAscending;
+            } else if (entry1.score > entry2.score) {
+                return NSOrderedDescending;
+            }
+            return NSOrderedSame;
+        }];
+        startEntries = [pendingEntries subarrayWithRange:NSMakeRange(0, startCount)];
+        for (SDWebImagePrefetchEntry *entry in startEntries) {
+            entry.state = SDWebImagePrefetchEntryStateLoading;
+        }
+    }
+    options = self.workingSetOptions;
+    context = self.workingSetContext;
+    SD_UNLOCK(_workingSetLock);
+    
+    for (SDWebImagePrefetchEntry *entry in startEntries) {
+        [self startWorkingSetEntry:entry options:options context:context];
+    }
+}
+
+- (void)startWorkingSetEntry:(SDWebImagePrefetchEntry *)entry options:(SDWebImageOptions)options context:(SDWebImageContext *)context {
+    if (entry.isVisible) {
+        // The view is waiting for it
+        options = (options & ~SDWebImageLowPriority) | SDWebImageHighPriority;
+    }
+    @weakify(self);
+    SDWebImageCombinedOperation *operation = [self.manager loadImageWithURL:entry.url options:options context:context progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, SDImageCacheType cacheType, BOOL finished, NSURL * _Nullable imageURL) {
+        @strongify(self);
+        if (!self || !finished) {
+            return;
+        }
+        BOOL isCurrentEntry = NO;
+        SD_LOCK(self->_workingSetLock);
+        entry.operation = nil;
+        if (entry.state == SDWebImagePrefetchEntryStateLoading) {
+            entry.state = error ? SDWebImagePrefetchEntryStateFailed : SDWebImagePrefetchEntryStateFinished;
+            isCurrentEntry = self.workingSetEntries[entry.url] == entry;
+            if (isCurrentEntry && !error && entry.isVisible) {
+                atomic_fetch_add_explicit(&self->_usedPrefetchCount, 1, memory_order_relaxed);
+            }
+        }
+        SD_UNLOCK(self->_workingSetLock);
+        if (isCurrentEntry) {
+            [self callWorkingSetDelegateWithURL:entry.url error:error context:context];
+        }
+        [self startWorkingSetPrefetching];
+    }];
+    SD_LOCK(_workingSetLock);
+    if (entry.state == SDWebImagePrefetchEntryStateLoading) {
+        entry.operation = operation;
+    }
+    SD_UNLOCK(_workingSetLock);
+}
+
+- (void)callWorkingSetDelegateWithURL:(NSURL *)url error:(NSError *)error context:(SDWebImageContext *)context {
+    if (![self.delegate respondsToSelector:@selector(imagePrefetcher:didPrefetchWorkingSetURL:error:)]) {
+        return;
+    }
+    SDCallbackQueue *queue = context[SDWebImageContextCallbackQueue];
+    if (!queue) {
+        queue = self.callbackQueue;
+    }
+    [(queue ?: SDCallbackQueue.mainQueue) async:^{
+        [self.delegate imagePrefetcher:self didPrefetchWorkingSetURL:url error:error];
+    }];
+}
+
 #pragma mark - Cancel
 - (void)cancelPrefetching {
     @synchronized(self.runningTokens) {
@@ -192,6 +385,11 @@
         [copiedTokens makeObjectsPerformSelector:@selector(cancel)];
         [self.runningTokens removeAllObjects];
     }
+    SD_LOCK(_workingSetLock);
+    SDWebImageOptions options = self.workingSetOptions;
+    SDWebImageContext *context = self.workingSetContext;
+    SD_UNLOCK(_workingSetLock);
+    [self updateWorkingSetWithScores:@{} options:options context:context];
 }
 
 - (void)callProgressBlockForToken:(SDWebImagePrefetchToken *)token imageURL:(NSURL *)url {
@@ -9,6 +9,7 @@
 #import "UIImage+MemoryCacheCost.h"
 #import "objc/runtime.h"
 #import "NSImage+Compatibility.h"
+#import "SDFrameSequenceImage.h"
 
 FOUNDATION_STATIC_INLINE NSUInteger SDMemoryCacheCostForImage(UIImage *image) {
     CGImageRef imageRef = image.CGImage;
@@ -20,8 +21,13 @@ FOUNDATION_STATIC_INLINE NSUInteger SDMemoryCacheCostForImage(UIImage *image) {
 #if SD_MAC
     frameCount = 1;
 #elif SD_UIKIT || SD_WATCH
-    // Filter the same frame in `_UIAnimatedImage`.
-    frameCount = image.images.count > 1 ? [NSSet setWithArray:image.images].count : 1;
+    if ([image isKindOfClass:[SDFrameSequenceImage class]] && ((SDFrameSequenceImage *)image).frames.count > 0) {
+        // Distinct frames, no need to expand the images
+        frameCount = ((SDFrameSequenceImage *)image).frames.count;
+    } else {
+        // Filter the same frame in `_UIAnimatedImage`.
+        frameCount = image.images.count > 1 ? [NSSet setWithArray:image.images].count : 1;
+    }
 #endif
     NSUInteger cost = bytesPerFrame * frameCount;
     return cost;
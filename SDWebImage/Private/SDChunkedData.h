@@ -0,0 +1,33 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import <Foundation/Foundation.h>
+#import "SDWebImageCompat.h"
+
+/**
+ A segmented data buffer (rope) which keeps the appended chunks as is, so appending never reallocate and copy the previous bytes like `NSMutableData` does when the total length is unknown.
+ The chunks are joined into one contiguous buffer only when someone need the `bytes`.
+ @note This class is not thread-safe. The returned `data` is immutable and can be used from any thread.
+ */
+@interface SDChunkedData : NSObject
+
+/// The total length in bytes of all chunks
+@property (nonatomic, assign, readonly) NSUInteger length;
+/// The number of chunks. This is reset to 1 after the chunks are joined
+@property (nonatomic, assign, readonly) NSUInteger chunkCount;
+
+/// Append a chunk. The data is retained without copying bytes
+- (void)appendData:(nonnull NSData *)data;
+
+/// An immutable snapshot of all the bytes. This does not copy bytes, the returned data may be non-contiguous (a `dispatch_data_t`), which is joined again each time the `bytes` is accessed. Use `contiguousData` if the consumer need `bytes`
+- (nonnull NSData *)data;
+
+/// An immutable snapshot of all the bytes, joined into one contiguous buffer. The joined buffer replace the previous chunks, so calling it again without new chunk does not copy, and the `bytes` of the returned data is free
+- (nonnull NSData *)contiguousData;
+
+@end
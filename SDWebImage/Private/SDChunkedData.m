@@ -0,0 +1,84 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDChunkedData.h"
+
+@interface SDChunkedData ()
+
+@property (nonatomic, strong, nonnull) NSMutableArray<dispatch_data_t> *chunks;
+// The concatenation of all chunks, created lazily and reset when new chunk appended
+@property (nonatomic, strong, nullable) dispatch_data_t concatenatedData;
+@property (nonatomic, assign, readwrite) NSUInteger length;
+
+@end
+
+@implementation SDChunkedData
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _chunks = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (NSUInteger)chunkCount {
+    return self.chunks.count;
+}
+
+- (void)appendData:(NSData *)data {
+    if (data.length == 0) {
+        return;
+    }
+    dispatch_data_t chunk = [self dispatchDataWithData:data];
+    [self.chunks addObject:chunk];
+    self.length += data.length;
+    if (self.concatenatedData) {
+        // Concat only reference the ranges, no bytes copy
+        self.concatenatedData = dispatch_data_create_concat(self.concatenatedData, chunk);
+    }
+}
+
+- (NSData *)data {
+    if (!self.concatenatedData) {
+        dispatch_data_t concatenatedData = dispatch_data_empty;
+        for (dispatch_data_t chunk in self.chunks) {
+            concatenatedData = dispatch_data_create_concat(concatenatedData, chunk);
+        }
+        self.concatenatedData = concatenatedData;
+    }
+    // `dispatch_data_t` is toll-free bridged to `NSData`
+    return (NSData *)self.concatenatedData;
+}
+
+- (NSData *)contiguousData {
+    if (self.chunks.count > 1) {
+        // Map the concatenation, this is the only time to copy bytes
+        dispatch_data_t contiguousData = dispatch_data_create_map([self data], NULL, NULL);
+        [self.chunks removeAllObjects];
+        [self.chunks addObject:contiguousData];
+        self.concatenatedData = contiguousData;
+    }
+    return [self data];
+}
+
+#pragma mark - Helper
+
+- (dispatch_data_t)dispatchDataWithData:(NSData *)data {
+    if ([data isKindOfClass:NSClassFromString(@"OS_dispatch_data")]) {
+        // URLSession delivers `dispatch_data_t` already
+        return (dispatch_data_t)data;
+    }
+    // Keep the original data alive as the destructor, avoid copying bytes
+    NSData *immutableData = [data copy];
+    return dispatch_data_create(immutableData.bytes, immutableData.length, NULL, ^{
+        [immutableData self];
+    });
+}
+
+@end
@@ -0,0 +1,73 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// The index entry for one disk cache file
+@interface SDDiskCacheIndexEntry : NSObject
+
+/// The file name (not the full path) in cache directory
+@property (nonatomic, copy, readonly) NSString *fileName;
+/// The file size in bytes
+@property (nonatomic, assign, readonly) NSUInteger size;
+/// The time interval since 1970 when the file is written
+@property (nonatomic, assign, readonly) NSTimeInterval writeDate;
+/// The time interval since 1970 when the file is last read or written
+@property (nonatomic, assign, readonly) NSTimeInterval accessDate;
+
+@end
+
+/**
+ An in-memory index of the files in disk cache directory, persisted with an append-only journal file in the same directory.
+ The journal is loaded lazily on the first access. If the journal does not exist or is corrupted, the index is rebuilt by scanning the directory once.
+ The journal record for access date update is buffered, so the read path does not trigger any syscall.
+ @note This class is thread-safe.
+ */
+@interface SDDiskCacheIndex : NSObject
+
+/// The journal file name, which is a hidden file, so directory enumeration with `NSDirectoryEnumerationSkipsHiddenFiles` will ignore it
+@property (nonatomic, class, readonly) NSString *journalFileName;
+
+- (instancetype)initWithDirectory:(NSString *)directory fileManager:(NSFileManager *)fileManager NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Whether the entries are ordered by access date, or by write date. Should be set before the first access. Defaults to YES.
+@property (nonatomic, assign) BOOL orderByAccessDate;
+
+/// Total file size in bytes of all entries
+@property (nonatomic, assign, readonly) NSUInteger totalSize;
+/// Total count of all entries
+@property (nonatomic, assign, readonly) NSUInteger totalCount;
+
+/// Query the entry for file name, return nil if not exist
+- (nullable SDDiskCacheIndexEntry *)entryForFileName:(NSString *)fileName;
+/// Record a file which is going to be written. If the process exit before `setEntryForFileName:size:`, the file is checked when the journal is loaded next time
+- (void)beginEntryForFileName:(NSString *)fileName;
+/// Record a file which has been written just now
+- (void)setEntryForFileName:(NSString *)fileName size:(NSUInteger)size;
+/// Update the access date of a file to now
+- (void)touchEntryForFileName:(NSString *)fileName;
+/// Remove the entry for file name
+- (void)removeEntryForFileName:(NSString *)fileName;
+/// Remove all entries
+- (void)removeAllEntries;
+/// A snapshot of all entries
+- (NSArray<SDDiskCacheIndexEntry *> *)allEntries;
+/// The oldest entries (by access date or write date, see `orderByAccessDate`), oldest first. This does not need to sort all entries
+- (NSArray<SDDiskCacheIndexEntry *> *)oldestEntriesWithLimit:(NSUInteger)limit;
+
+/// Drop the current index and rebuild it by scanning the directory
+- (void)rebuild;
+/// Write the buffered journal records to file
+- (void)synchronize;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,488 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDDiskCacheIndex.h"
+#import "SDInternalMacros.h"
+#include <stdio.h>
+
+// Journal layout: header (magic + version), followed by records.
+// Each record begins with one byte op, then a uint16 file name length and the UTF-8 file name, then the op payload.
+static const uint32_t kSDDiskCacheIndexMagic = 0x58494453; // 'SDIX'
+static const uint32_t kSDDiskCacheIndexVersion = 2;
+// Compact the journal when the records count exceed this value, and also exceed twice of entries count
+static const NSUInteger kSDDiskCacheIndexMinCompactRecordCount = 1024;
+
+typedef NS_ENUM(uint8_t, SDDiskCacheIndexOp) {
+    SDDiskCacheIndexOpSet = 1, // size(uint64), writeDate(double), accessDate(double)
+    SDDiskCacheIndexOpTouch = 2, // accessDate(double)
+    SDDiskCacheIndexOpRemove = 3, // no payload
+    SDDiskCacheIndexOpBegin = 4, // no payload, the file is going to be written
+};
+
+@interface SDDiskCacheIndexEntry () {
+    @package
+    // The ordered list, retained by the entries dictionary
+    __unsafe_unretained SDDiskCacheIndexEntry *_prev;
+    __unsafe_unretained SDDiskCacheIndexEntry *_next;
+}
+
+@property (nonatomic, copy, readwrite) NSString *fileName;
+@property (nonatomic, assign, readwrite) NSUInteger size;
+@property (nonatomic, assign, readwrite) NSTimeInterval writeDate;
+@property (nonatomic, assign, readwrite) NSTimeInterval accessDate;
+
+@end
+
+@implementation SDDiskCacheIndexEntry
+@end
+
+@interface SDDiskCacheIndex () {
+    SD_LOCK_DECLARE(_lock);
+    FILE *_journal;
+    BOOL _loaded;
+    NSUInteger _totalSize;
+    NSUInteger _journalRecordCount;
+    __unsafe_unretained SDDiskCacheIndexEntry *_head; // newest
+    __unsafe_unretained SDDiskCacheIndexEntry *_tail; // oldest
+}
+
+@property (nonatomic, copy) NSString *directory;
+@property (nonatomic, copy) NSString *journalPath;
+@property (nonatomic, strong) NSFileManager *fileManager;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, SDDiskCacheIndexEntry *> *entries;
+
+@end
+
+@implementation SDDiskCacheIndex
+
++ (NSString *)journalFileName {
+    return @".SDDiskCacheIndex";
+}
+
+- (instancetype)initWithDirectory:(NSString *)directory fileManager:(NSFileManager *)fileManager {
+    self = [super init];
+    if (self) {
+        _directory = [directory copy];
+        _journalPath = [directory stringByAppendingPathComponent:self.class.journalFileName];
+        _fileManager = fileManager;
+        _entries = [NSMutableDictionary dictionary];
+        _orderByAccessDate = YES;
+        SD_LOCK_INIT(_lock);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    if (_journal) {
+        fclose(_journal);
+        _journal = NULL;
+    }
+}
+
+#pragma mark - Public
+
+- (NSUInteger)totalSize {
+    SD_LOCK(_lock);
+    [self loadIfNeeded];
+    NSUInteger totalSize = _totalSize;
+    SD_UNLOCK(_lock);
+    return totalSize;
+}
+
+- (NSUInteger)totalCount {
+    SD_LOCK(_lock);
+    [self loadIfNeeded];
+    NSUInteger totalCount = self.entries.count;
+    SD_UNLOCK(_lock);
+    return totalCount;
+}
+
+- (SDDiskCacheIndexEntry *)entryForFileName:(NSString *)fileName {
+    if (!fileName) {
+        return nil;
+    }
+    SD_LOCK(_lock);
+    [self loadIfNeeded];
+    SDDiskCacheIndexEntry *entry = self.entries[fileName];
+    SD_UNLOCK(_lock);
+    return entry;
+}
+
+- (void)setEntryForFileName:(NSString *)fileName size:(NSUInteger)size {
+    if (!fileName) {
+        return;
+    }
+    NSTimeInterval now = [NSDate date].timeIntervalSince1970;
+    SD_LOCK(_lock);
+    [self loadIfNeeded];
+    SDDiskCacheIndexEntry *entry = [self applySetWithFileName:fileName size:size writeDate:now accessDate:now];
+    [self appendRecordWithOp:SDDiskCacheIndexOpSet entry:entry];
+    // The file write is already a syscall, flush the journal together to reduce the chance of lost record
+    fflush(_journal);
+    [self compactIfNeeded];
+    SD_UNLOCK(_lock);
+}
+
+- (void)beginEntryForFileName:(NSString *)fileName {
+    if (!fileName) {
+        return;
+    }
+    SD_LOCK(_lock);
+    [self loadIfNeeded];
+    SDDiskCacheIndexEntry *entry = [SDDiskCacheIndexEntry new];
+    entry.fileName = fileName;
+    [self appendRecordWithOp:SDDiskCacheIndexOpBegin entry:entry];
+    // Must reach the file before the data write, so a crash in between can be reconciled
+    fflush(_journal);
+    SD_UNLOCK(_lock);
+}
+
+- (void)touchEntryForFileName:(NSString *)fileName {
+    if (!fileName) {
+        return;
+    }
+    NSTimeInterval now = [NSDate date].timeIntervalSince1970;
+    SD_LOCK(_lock);
+    [self loadIfNeeded];
+    SDDiskCacheIndexEntry *entry = self.entries[fileName];
+    if (entry) {
+        entry.accessDate = now;
+        if (self.orderByAccessDate) {
+            [self bringEntryToHead:entry];
+        }
+        // Buffered by stdio, no syscall for most of time
+        [self appendRecordWithOp:SDDiskCacheIndexOpTouch entry:entry];
+        [self compactIfNeeded];
+    }
+    SD_UNLOCK(_lock);
+}
+
+- (void)removeEntryForFileName:(NSString *)fileName {
+    if (!fileName) {
+        return;
+    }
+    SD_LOCK(_lock);
+    [self loadIfNeeded];
+    SDDiskCacheIndexEntry *entry = self.entries[fileName];
+    if (entry) {
+        [self applyRemoveWithFileName:fileName];
+        [self appendRecordWithOp:SDDiskCacheIndexOpRemove entry:entry];
+        fflush(_journal);
+        [self compactIfNeeded];
+    }
+    SD_UNLOCK(_lock);
+}
+
+- (void)removeAllEntries {
+    SD_LOCK(_lock);
+    [self.entries removeAllObjects];
+    _head = _tail = nil;
+    _totalSize = 0;
+    _loaded = YES;
+    // The directory may be removed, write a fresh journal
+    [self writeSnapshot];
+    SD_UNLOCK(_lock);
+}
+
+- (NSArray<SDDiskCacheIndexEntry *> *)allEntries {
+    SD_LOCK(_lock);
+    [self loadIfNeeded];
+    NSArray<SDDiskCacheIndexEntry *> *allEntries = self.entries.allValues;
+    SD_UNLOCK(_lock);
+    return allEntries;
+}
+
+- (NSArray<SDDiskCacheIndexEntry *> *)oldestEntriesWithLimit:(NSUInteger)limit {
+    NSMutableArray<SDDiskCacheIndexEntry *> *oldestEntries = [NSMutableArray arrayWithCapacity:limit];
+    SD_LOCK(_lock);
+    [self loadIfNeeded];
+    SDDiskCacheIndexEntry *entry = _tail;
+    while (entry && oldestEntries.count < limit) {
+        [oldestEntries addObject:entry];
+        entry = entry->_prev;
+    }
+    SD_UNLOCK(_lock);
+    return [oldestEntries copy];
+}
+
+- (void)rebuild {
+    SD_LOCK(_lock);
+    [self scanDirectory];
+    [self sortEntries];
+    [self writeSnapshot];
+    _loaded = YES;
+    SD_UNLOCK(_lock);
+}
+
+- (void)synchronize {
+    SD_LOCK(_lock);
+    if (_journal) {
+        fflush(_journal);
+    }
+    SD_UNLOCK(_lock);
+}
+
+#pragma mark - Private, should be called inside lock
+
+- (void)loadIfNeeded {
+    if (_loaded) {
+        return;
+    }
+    _loaded = YES;
+    if (![self replayJournal]) {
+        // Journal does not exist or corrupted, rebuild from directory
+        [self scanDirectory];
+    }
+    [self sortEntries];
+    // Always compact once after load, this also remove the partial written record at the end
+    [self writeSnapshot];
+}
+
+- (SDDiskCacheIndexEntry *)applySetWithFileName:(NSString *)fileName size:(NSUInteger)size writeDate:(NSTimeInterval)writeDate accessDate:(NSTimeInterval)accessDate {
+    SDDiskCacheIndexEntry *entry = self.entries[fileName];
+    if (entry) {
+        _totalSize -= entry.size;
+        [self bringEntryToHead:entry];
+    } else {
+        entry = [SDDiskCacheIndexEntry new];
+        entry.fileName = fileName;
+        self.entries[fileName] = entry;
+        [self insertEntryAtHead:entry];
+    }
+    entry.size = size;
+    entry.writeDate = writeDate;
+    entry.accessDate = accessDate;
+    _totalSize += size;
+    return entry;
+}
+
+- (void)applyRemoveWithFileName:(NSString *)fileName {
+    SDDiskCacheIndexEntry *entry = self.entries[fileName];
+    if (entry) {
+        _totalSize -= entry.size;
+        [self unlinkEntry:entry];
+        [self.entries removeObjectForKey:fileName];
+    }
+}
+
+#pragma mark - Ordered list, should be called inside lock
+
+- (void)insertEntryAtHead:(SDDiskCacheIndexEntry *)entry {
+    entry->_prev = nil;
+    entry->_next = _head;
+    if (_head) {
+        _head->_prev = entry;
+    }
+    _head = entry;
+    if (!_tail) {
+        _tail = entry;
+    }
+}
+
+- (void)unlinkEntry:(SDDiskCacheIndexEntry *)entry {
+    if (entry->_prev) entry->_prev->_next = entry->_next;
+    if (entry->_next) entry->_next->_prev = entry->_prev;
+    if (_head == entry) _head = entry->_next;
+    if (_tail == entry) _tail = entry->_prev;
+    entry->_prev = nil;
+    entry->_next = nil;
+}
+
+- (void)bringEntryToHead:(SDDiskCacheIndexEntry *)entry {
+    if (_head == entry) {
+        return;
+    }
+    [self unlinkEntry:entry];
+    [self insertEntryAtHead:entry];
+}
+
+/// The replayed or scanned entries are not in date order, sort once after load
+- (void)sortEntries {
+    BOOL orderByAccessDate = self.orderByAccessDate;
+    NSArray<SDDiskCacheIndexEntry *> *sortedEntries = [self.entries.allValues sortedArrayUsingComparator:^NSComparisonResult(SDDiskCacheIndexEntry *entry1, SDDiskCacheIndexEntry *entry2) {
+        NSTimeInterval date1 = orderByAccessDate ? entry1.accessDate : entry1.writeDate;
+        NSTimeInterval date2 = orderByAccessDate ? entry2.accessDate : entry2.writeDate;
+        return date1 < date2 ? NSOrderedAscending : (date1 > date2 ? NSOrderedDescending : NSOrderedSame);
+    }];
+    _head = _tail = nil;
+    // Oldest first, so the newest is at head finally
+    for (SDDiskCacheIndexEntry *entry in sortedEntries) {
+        [self insertEntryAtHead:entry];
+    }
+}
+
+- (void)scanDirectory {
+    [self.entries removeAllObjects];
+    _head = _tail = nil;
+    _totalSize = 0;
+    NSURL *directoryURL = [NSURL fileURLWithPath:self.directory isDirectory:YES];
+    NSArray<NSURLResourceKey> *resourceKeys = @[NSURLIsDirectoryKey, NSURLFileSizeKey, NSURLContentModificationDateKey, NSURLContentAccessDateKey];
+    NSDirectoryEnumerator<NSURL *> *fileEnumerator = [self.fileManager enumeratorAtURL:directoryURL
+                                                            includingPropertiesForKeys:resourceKeys
+                                                                               options:NSDirectoryEnumerationSkipsHiddenFiles | NSDirectoryEnumerationSkipsSubdirectoryDescendants
+                                                                          errorHandler:NULL];
+    for (NSURL *fileURL in fileEnumerator) {
+        @autoreleasepool {
+            NSDictionary<NSURLResourceKey, id> *resourceValues = [fileURL resourceValuesForKeys:resourceKeys error:nil];
+            if (!resourceValues || [resourceValues[NSURLIsDirectoryKey] boolValue]) {
+                continue;
+            }
+            NSUInteger size = [resourceValues[NSURLFileSizeKey] unsignedIntegerValue];
+            NSTimeInterval writeDate = [resourceValues[NSURLContentModificationDateKey] timeIntervalSince1970];
+            NSTimeInterval accessDate = [resourceValues[NSURLContentAccessDateKey] timeIntervalSince1970];
+            [self applySetWithFileName:fileURL.lastPathComponent size:size writeDate:writeDate accessDate:MAX(writeDate, accessDate)];
+        }
+    }
+}
+
+- (BOOL)replayJournal {
+    NSData *data = [NSData dataWithContentsOfFile:self.journalPath options:NSDataReadingMappedIfSafe error:nil];
+    if (data.length < sizeof(uint32_t) * 2) {
+        return NO;
+    }
+    const uint8_t *bytes = data.bytes;
+    const uint8_t *end = bytes + data.length;
+    uint32_t magic, version;
+    memcpy(&magic, bytes, sizeof(uint32_t));
+    memcpy(&version, bytes + sizeof(uint32_t), sizeof(uint32_t));
+    if (magic != kSDDiskCacheIndexMagic || version != kSDDiskCacheIndexVersion) {
+        return NO;
+    }
+    const uint8_t *p = bytes + sizeof(uint32_t) * 2;
+    [self.entries removeAllObjects];
+    _head = _tail = nil;
+    _totalSize = 0;
+    // The files began to write, but not finished with a set record
+    NSMutableSet<NSString *> *pendingFileNames = [NSMutableSet set];
+    BOOL stop = NO;
+    while (p < end && !stop) {
+        @autoreleasepool {
+            uint8_t op;
+            uint16_t nameLength;
+            if (end - p < (ptrdiff_t)(sizeof(uint8_t) + sizeof(uint16_t))) {
+                break; // partial written
+            }
+            memcpy(&op, p, sizeof(uint8_t)); p += sizeof(uint8_t);
+            memcpy(&nameLength, p, sizeof(uint16_t)); p += sizeof(uint16_t);
+            size_t payloadLength = 0;
+            switch (op) {
+                case SDDiskCacheIndexOpSet: payloadLength = sizeof(uint64_t) + sizeof(double) * 2; break;
+                case SDDiskCacheIndexOpTouch: payloadLength = sizeof(double); break;
+                case SDDiskCacheIndexOpRemove: payloadLength = 0; break;
+                case SDDiskCacheIndexOpBegin: payloadLength = 0; break;
+                default: stop = YES; continue; // unknown record, stop replay and keep what we have
+            }
+            if (end - p < (ptrdiff_t)(nameLength + payloadLength)) {
+                break; // partial written
+            }
+            NSString *fileName = [[NSString alloc] initWithBytes:p length:nameLength encoding:NSUTF8StringEncoding];
+            p += nameLength;
+            if (!fileName) {
+                p += payloadLength;
+                continue;
+            }
+            if (op == SDDiskCacheIndexOpSet) {
+                uint64_t size;
+                double writeDate, accessDate;
+                memcpy(&size, p, sizeof(uint64_t)); p += sizeof(uint64_t);
+                memcpy(&writeDate, p, sizeof(double)); p += sizeof(double);
+                memcpy(&accessDate, p, sizeof(double)); p += sizeof(double);
+                [self applySetWithFileName:fileName size:(NSUInteger)size writeDate:writeDate accessDate:accessDate];
+                [pendingFileNames removeObject:fileName];
+            } else if (op == SDDiskCacheIndexOpTouch) {
+                double accessDate;
+                memcpy(&accessDate, p, sizeof(double)); p += sizeof(double);
+                self.entries[fileName].accessDate = accessDate;
+            } else if (op == SDDiskCacheIndexOpRemove) {
+                [self applyRemoveWithFileName:fileName];
+                [pendingFileNames removeObject:fileName];
+            } else if (op == SDDiskCacheIndexOpBegin) {
+                [pendingFileNames addObject:fileName];
+            }
+        }
+    }
+    [self reconcilePendingFileNames:pendingFileNames];
+    return YES;
+}
+
+/// Crashed between the data write and the set record, check the file itself
+- (void)reconcilePendingFileNames:(NSSet<NSString *> *)pendingFileNames {
+    for (NSString *fileName in pendingFileNames) {
+        NSString *filePath = [self.directory stringByAppendingPathComponent:fileName];
+        NSDictionary<NSFileAttributeKey, id> *attributes = [self.fileManager attributesOfItemAtPath:filePath error:nil];
+        if (!attributes) {
+            [self applyRemoveWithFileName:fileName];
+            continue;
+        }
+        NSTimeInterval writeDate = [attributes[NSFileModificationDate] timeIntervalSince1970];
+        [self applySetWithFileName:fileName size:[attributes[NSFileSize] unsignedIntegerValue] writeDate:writeDate accessDate:writeDate];
+    }
+}
+
+- (void)appendRecordWithOp:(SDDiskCacheIndexOp)op entry:(SDDiskCacheIndexEntry *)entry {
+    if (!_journal) {
+        return;
+    }
+    NSData *nameData = [entry.fileName dataUsingEncoding:NSUTF8StringEncoding];
+    if (nameData.length > UINT16_MAX) {
+        return;
+    }
+    uint16_t nameLength = (uint16_t)nameData.length;
+    fwrite(&op, sizeof(uint8_t), 1, _journal);
+    fwrite(&nameLength, sizeof(uint16_t), 1, _journal);
+    fwrite(nameData.bytes, 1, nameLength, _journal);
+    if (op == SDDiskCacheIndexOpSet) {
+        uint64_t size = entry.size;
+        double writeDate = entry.writeDate;
+        double accessDate = entry.accessDate;
+        fwrite(&size, sizeof(uint64_t), 1, _journal);
+        fwrite(&writeDate, sizeof(double), 1, _journal);
+        fwrite(&accessDate, sizeof(double), 1, _journal);
+    } else if (op == SDDiskCacheIndexOpTouch) {
+        double accessDate = entry.accessDate;
+        fwrite(&accessDate, sizeof(double), 1, _journal);
+    }
+    _journalRecordCount++;
+}
+
+- (void)compactIfNeeded {
+    if (_journalRecordCount > kSDDiskCacheIndexMinCompactRecordCount && _journalRecordCount > self.entries.count * 2) {
+        [self writeSnapshot];
+    }
+}
+
+/// Write all entries into a new journal file atomically, and reopen the journal for append
+- (void)writeSnapshot {
+    if (_journal) {
+        fclose(_journal);
+        _journal = NULL;
+    }
+    _journalRecordCount = 0;
+    if (![self.fileManager fileExistsAtPath:self.directory]) {
+        return;
+    }
+    NSString *tempPath = [self.journalPath stringByAppendingPathExtension:@"tmp"];
+    _journal = fopen(tempPath.fileSystemRepresentation, "wb");
+    if (!_journal) {
+        return;
+    }
+    uint32_t header[2] = {kSDDiskCacheIndexMagic, kSDDiskCacheIndexVersion};
+    fwrite(header, sizeof(uint32_t), 2, _journal);
+    for (SDDiskCacheIndexEntry *entry in self.entries.objectEnumerator) {
+        [self appendRecordWithOp:SDDiskCacheIndexOpSet entry:entry];
+    }
+    fclose(_journal);
+    _journal = NULL;
+    if (rename(tempPath.fileSystemRepresentation, self.journalPath.fileSystemRepresentation) != 0) {
+        SD_LOG("SDDiskCacheIndex failed to write journal at path: %@", self.journalPath);
+        return;
+    }
+    _journal = fopen(self.journalPath.fileSystemRepresentation, "ab");
+}
+
+@end
@@ -20,6 +20,12 @@
 
 + (nonnull instancetype)displayLinkWithTarget:(nonnull id)target selector:(nonnull SEL)sel;
 
+/// Create a display link driven by the shared scheduler. All the shared display links in the same runloop mode are fired by one underlying display link, in a single main thread callback. Always use main runloop
++ (nonnull instancetype)sharedDisplayLinkWithTarget:(nonnull id)target selector:(nonnull SEL)sel;
+
+/// The minimum time in seconds between two callbacks, used to skip the refresh for content which does not need to update on every refresh. Only works for shared display link. Default is 0, means every refresh
+@property (nonatomic, assign) NSTimeInterval preferredFrameInterval;
+
 - (void)addToRunLoop:(nonnull NSRunLoop *)runloop forMode:(nonnull NSRunLoopMode)mode;
 - (void)removeFromRunLoop:(nonnull NSRunLoop *)runloop forMode:(nonnull NSRunLoopMode)mode;
 
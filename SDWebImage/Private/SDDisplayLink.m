@@ -8,6 +8,7 @@
 
 #import "SDDisplayLink.h"
 #import "SDWeakProxy.h"
+#import "SDInternalMacros.h"
 #if SD_MAC
 #import <CoreVideo/CoreVideo.h>
 #elif SD_UIKIT
@@ -25,8 +26,26 @@ static BOOL kSDDisplayLinkUseTargetTimestamp = NO; // Use `next` fire time, or `
 
 #define kSDDisplayLinkInterval 1.0 / 60
 
+// One underlying display link for each runloop mode, which fan out to all the shared display links
+@interface SDDisplayLinkScheduler : NSObject
+
++ (nonnull instancetype)schedulerForRunLoopMode:(nonnull NSRunLoopMode)mode;
+- (void)addDisplayLink:(nonnull SDDisplayLink *)displayLink;
+- (void)removeDisplayLink:(nonnull SDDisplayLink *)displayLink;
+
+@end
+
 @interface SDDisplayLink ()
 
+// Shared display link, driven by `SDDisplayLinkScheduler`
+@property (nonatomic, assign, getter=isShared) BOOL shared;
+@property (nonatomic, assign) BOOL sharedRunning;
+@property (nonatomic, assign) NSTimeInterval sharedElapsedTime; // elapsed time since previous callback
+@property (nonatomic, assign) NSTimeInterval sharedDuration; // elapsed time of current callback
+@property (nonatomic, copy) NSRunLoopMode sharedRunloopMode;
+
+- (void)sharedDisplayLinkDidRefreshWithDuration:(NSTimeInterval)duration;
+
 @property (nonatomic, assign) NSTimeInterval previousFireTime;
 @property (nonatomic, assign) NSTimeInterval nextFireTime;
 
@@ -93,9 +112,27 @@ static BOOL kSDDisplayLinkUseTargetTimestamp = NO; // Use `next` fire time, or `
     return displayLink;
 }
 
+- (instancetype)initSharedWithTarget:(id)target selector:(SEL)sel {
+    self = [super init];
+    if (self) {
+        _target = target;
+        _selector = sel;
+        _shared = YES;
+    }
+    return self;
+}
+
++ (instancetype)sharedDisplayLinkWithTarget:(id)target selector:(SEL)sel {
+    SDDisplayLink *displayLink = [[SDDisplayLink alloc] initSharedWithTarget:target selector:sel];
+    return displayLink;
+}
+
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wunguarded-availability"
 - (NSTimeInterval)duration {
+    if (self.isShared) {
+        return self.sharedRunning ? self.sharedDuration : 0;
+    }
     NSTimeInterval duration = 0;
 #if SD_MAC
     CVTimeStamp outputTime = self.outputTime;
@@ -162,6 +199,9 @@ static BOOL kSDDisplayLinkUseTargetTimestamp = NO; // Use `next` fire time, or `
 #pragma clang diagnostic pop
 
 - (BOOL)isRunning {
+    if (self.isShared) {
+        return self.sharedRunning;
+    }
 #if SD_MAC
     return CVDisplayLinkIsRunning(self.displayLink);
 #elif SD_UIKIT
@@ -175,6 +215,16 @@ static BOOL kSDDisplayLinkUseTargetTimestamp = NO; // Use `next` fire time, or `
     if  (!runloop || !mode) {
         return;
     }
+    if (self.isShared) {
+        if (self.sharedRunning && self.sharedRunloopMode) {
+            [[SDDisplayLinkScheduler schedulerForRunLoopMode:self.sharedRunloopMode] removeDisplayLink:self];
+        }
+        self.sharedRunloopMode = mode;
+        if (self.sharedRunning) {
+            [[SDDisplayLinkScheduler schedulerForRunLoopMode:mode] addDisplayLink:self];
+        }
+        return;
+    }
 #if SD_MAC
     self.runloopMode = mode;
 #elif SD_UIKIT
@@ -198,6 +248,13 @@ static BOOL kSDDisplayLinkUseTargetTimestamp = NO; // Use `next` fire time, or `
     if  (!runloop || !mode) {
         return;
     }
+    if (self.isShared) {
+        if (self.sharedRunning && [self.sharedRunloopMode isEqualToString:mode]) {
+            [[SDDisplayLinkScheduler schedulerForRunLoopMode:mode] removeDisplayLink:self];
+        }
+        self.sharedRunloopMode = nil;
+        return;
+    }
 #if SD_MAC
     self.runloopMode = nil;
 #elif SD_UIKIT
@@ -218,6 +275,18 @@ static BOOL kSDDisplayLinkUseTargetTimestamp = NO; // Use `next` fire time, or `
 }
 
 - (void)start {
+    if (self.isShared) {
+        if (self.sharedRunning) {
+            return;
+        }
+        self.sharedRunning = YES;
+        self.sharedElapsedTime = 0;
+        self.sharedDuration = 0;
+        if (self.sharedRunloopMode) {
+            [[SDDisplayLinkScheduler schedulerForRunLoopMode:self.sharedRunloopMode] addDisplayLink:self];
+        }
+        return;
+    }
 #if SD_MAC
     CVDisplayLinkStart(self.displayLink);
 #elif SD_UIKIT
@@ -234,6 +303,15 @@ static BOOL kSDDisplayLinkUseTargetTimestamp = NO; // Use `next` fire time, or `
 }
 
 - (void)stop {
+    if (self.isShared) {
+        if (self.sharedRunning && self.sharedRunloopMode) {
+            [[SDDisplayLinkScheduler schedulerForRunLoopMode:self.sharedRunloopMode] removeDisplayLink:self];
+        }
+        self.sharedRunning = NO;
+        self.sharedElapsedTime = 0;
+        self.sharedDuration = 0;
+        return;
+    }
 #if SD_MAC
     CVDisplayLinkStop(self.displayLink);
 #elif SD_UIKIT
@@ -265,6 +343,101 @@ static BOOL kSDDisplayLinkUseTargetTimestamp = NO; // Use `next` fire time, or `
 }
 #pragma clang diagnostic pop
 
+// Called by scheduler on main thread for each refresh
+- (void)sharedDisplayLinkDidRefreshWithDuration:(NSTimeInterval)duration {
+    if (!self.sharedRunning) {
+        return;
+    }
+    NSTimeInterval elapsedTime = self.sharedElapsedTime + duration;
+    // Fire if the next refresh is later than the preferred interval for more than half refresh
+    if (elapsedTime + duration / 2 < self.preferredFrameInterval) {
+        self.sharedElapsedTime = elapsedTime;
+        return;
+    }
+    self.sharedElapsedTime = 0;
+    self.sharedDuration = elapsedTime;
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Warc-performSelector-leaks"
+    [_target performSelector:_selector withObject:self];
+#pragma clang diagnostic pop
+}
+
+@end
+
+// Lock to ensure atomic behavior
+SD_LOCK_DECLARE_STATIC(_schedulersLock);
+
+@implementation SDDisplayLinkScheduler {
+    SDDisplayLink *_displayLink;
+    NSHashTable<SDDisplayLink *> *_displayLinks;
+}
+
++ (void)initialize {
+    SD_LOCK_INIT(_schedulersLock);
+}
+
++ (instancetype)schedulerForRunLoopMode:(NSRunLoopMode)mode {
+    static NSMutableDictionary<NSRunLoopMode, SDDisplayLinkScheduler *> *schedulers;
+    SD_LOCK(_schedulersLock);
+    if (!schedulers) {
+        schedulers = [NSMutableDictionary dictionary];
+    }
+    SDDisplayLinkScheduler *scheduler = schedulers[mode];
+    if (!scheduler) {
+        scheduler = [[SDDisplayLinkScheduler alloc] initWithRunLoopMode:mode];
+        schedulers[mode] = scheduler;
+    }
+    SD_UNLOCK(_schedulersLock);
+    return scheduler;
+}
+
+- (instancetype)initWithRunLoopMode:(NSRunLoopMode)mode {
+    self = [super init];
+    if (self) {
+        _displayLinks = [NSHashTable weakObjectsHashTable];
+        _displayLink = [SDDisplayLink displayLinkWithTarget:self selector:@selector(displayLinkDidRefresh:)];
+        [_displayLink addToRunLoop:[NSRunLoop mainRunLoop] forMode:mode];
+        [_displayLink stop];
+    }
+    return self;
+}
+
+- (void)addDisplayLink:(SDDisplayLink *)displayLink {
+    @synchronized (_displayLinks) {
+        [_displayLinks addObject:displayLink];
+    }
+    if (!_displayLink.isRunning) {
+        [_displayLink start];
+    }
+}
+
+- (void)removeDisplayLink:(SDDisplayLink *)displayLink {
+    BOOL isEmpty;
+    @synchronized (_displayLinks) {
+        [_displayLinks removeObject:displayLink];
+        isEmpty = _displayLinks.count == 0;
+    }
+    if (isEmpty) {
+        [_displayLink stop];
+    }
+}
+
+- (void)displayLinkDidRefresh:(SDDisplayLink *)displayLink {
+    NSTimeInterval duration = displayLink.duration;
+    NSArray<SDDisplayLink *> *displayLinks;
+    @synchronized (_displayLinks) {
+        displayLinks = _displayLinks.allObjects;
+    }
+    if (displayLinks.count == 0) {
+        // All shared display links are released
+        [_displayLink stop];
+        return;
+    }
+    for (SDDisplayLink *sharedDisplayLink in displayLinks) {
+        [sharedDisplayLink sharedDisplayLinkDidRefreshWithDuration:duration];
+    }
+}
+
 @end
 
 #if SD_MAC
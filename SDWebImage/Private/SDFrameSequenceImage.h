@@ -0,0 +1,33 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDWebImageCompat.h"
+
+#if SD_UIKIT || SD_WATCH
+
+@class SDImageFrame;
+
+/// A variable-duration animated image which store each distinct frame only once, with a duration table. Created by `+[SDImageCoderHelper animatedImageWithFrames:]`.
+/// UIKit's `UIImage animatedImageWithImages:duration:` only supports the same duration for each frame, so the frames have to be repeated by the GCD of all durations. This class keep the frames as it is, and answer `images` (the repeated frames array) lazily for UIKit compatibility, like `UIImageView` animation.
+/// The UIKit transforms (rendering mode, tint color, resizable cap insets, alignment insets and RTL flip) return the image created by `animatedImageWithImages:duration:` with the repeated frames, which UIKit keep the animation for.
+@interface SDFrameSequenceImage : UIImage
+
+/// The distinct frames with its duration
+@property (nonatomic, copy, readonly, nonnull) NSArray<SDImageFrame *> *frames;
+
+/// Create the image with frames, the first frame is used as the static image content
+/// @param frames The animated frames
+- (nullable instancetype)initWithFrames:(nonnull NSArray<SDImageFrame *> *)frames;
+
+/// Repeat each frame image by the GCD of all frame durations, which can be used for `UIImage animatedImageWithImages:duration:`
+/// @param frames The animated frames
++ (nonnull NSArray<UIImage *> *)imagesWithFrames:(nonnull NSArray<SDImageFrame *> *)frames;
+
+@end
+
+#endif
@@ -0,0 +1,211 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDFrameSequenceImage.h"
+
+#if SD_UIKIT || SD_WATCH
+
+#import "SDImageFrame.h"
+#import "UIImage+Metadata.h"
+#import "SDInternalMacros.h"
+
+static NSUInteger gcd(NSUInteger a, NSUInteger b) {
+    NSUInteger c;
+    while (a != 0) {
+        c = a;
+        a = b % a;
+        b = c;
+    }
+    return b;
+}
+
+static NSUInteger gcdArray(size_t const count, NSUInteger const * const values) {
+    if (count == 0) {
+        return 0;
+    }
+    NSUInteger result = values[0];
+    for (size_t i = 1; i < count; ++i) {
+        result = gcd(values[i], result);
+    }
+    return result;
+}
+
+@interface SDFrameSequenceImage () {
+    SD_LOCK_DECLARE(_lock);
+}
+
+@property (nonatomic, copy, readwrite) NSArray<SDImageFrame *> *frames;
+@property (nonatomic, assign) NSTimeInterval totalDuration;
+@property (nonatomic, copy) NSArray<UIImage *> *expandedImages;
+
+@end
+
+@implementation SDFrameSequenceImage
+
+- (instancetype)initWithFrames:(NSArray<SDImageFrame *> *)frames {
+    UIImage *posterImage = frames.firstObject.image;
+    if (!posterImage) {
+        return nil;
+    }
+    if (posterImage.CGImage) {
+        self = [super initWithCGImage:posterImage.CGImage scale:posterImage.scale orientation:posterImage.imageOrientation];
+    }
+#if SD_UIKIT
+    else if (posterImage.CIImage) {
+        self = [super initWithCIImage:posterImage.CIImage scale:posterImage.scale orientation:posterImage.imageOrientation];
+    }
+#endif
+    else {
+        return nil;
+    }
+    if (self) {
+        _frames = [frames copy];
+        NSTimeInterval totalDuration = 0;
+        for (SDImageFrame *frame in frames) {
+            totalDuration += frame.duration;
+        }
+        _totalDuration = totalDuration;
+        SD_LOCK_INIT(_lock);
+    }
+    return self;
+}
+
++ (NSArray<UIImage *> *)imagesWithFrames:(NSArray<SDImageFrame *> *)frames {
+    NSUInteger frameCount = frames.count;
+    if (frameCount == 0) {
+        return @[];
+    }
+    NSUInteger durations[frameCount];
+    for (size_t i = 0; i < frameCount; i++) {
+        durations[i] = frames[i].duration * 1000;
+    }
+    NSUInteger const gcd = gcdArray(frameCount, durations);
+    NSMutableArray<UIImage *> *animatedImages = [NSMutableArray arrayWithCapacity:frameCount];
+    for (size_t i = 0; i < frameCount; i++) {
+        UIImage *image = frames[i].image;
+        NSUInteger repeatCount;
+        if (gcd) {
+            repeatCount = durations[i] / gcd;
+        } else {
+            repeatCount = 1;
+        }
+        for (size_t j = 0; j < repeatCount; ++j) {
+            [animatedImages addObject:image];
+        }
+    }
+    return [animatedImages copy];
+}
+
+#pragma mark - UIImage
+
+- (NSArray<UIImage *> *)images {
+    if (self.frames.count == 0) {
+        // Not created from frames, such as unarchived
+        return [super images];
+    }
+    // Only build the repeated frames when UIKit ask for it, like `UIImageView` animation
+    SD_LOCK(_lock);
+    NSArray<UIImage *> *images = self.expandedImages;
+    if (!images) {
+        images = [self.class imagesWithFrames:self.frames];
+        self.expandedImages = images;
+    }
+    SD_UNLOCK(_lock);
+    return images;
+}
+
+- (NSTimeInterval)duration {
+    if (self.frames.count == 0) {
+        return [super duration];
+    }
+    return self.totalDuration;
+}
+
+#if SD_UIKIT
+#pragma mark - UIKit Transform
+
+// UIKit keep the animation for these transforms only when the image is created by `animatedImageWithImages:duration:`, which has the real frames
+- (UIImage *)systemAnimatedImage {
+    return [UIImage animatedImageWithImages:self.images duration:self.duration];
+}
+
+- (UIImage *)imageWithRenderingMode:(UIImageRenderingMode)renderingMode {
+    if (self.frames.count == 0) {
+        return [super imageWithRenderingMode:renderingMode];
+    }
+    return [self.systemAnimatedImage imageWithRenderingMode:renderingMode];
+}
+
+- (UIImage *)imageWithTintColor:(UIColor *)color {
+    if (self.frames.count == 0) {
+        return [super imageWithTintColor:color];
+    }
+    if (@available(iOS 13, tvOS 13, *)) {
+        return [self.systemAnimatedImage imageWithTintColor:color];
+    }
+    return [super imageWithTintColor:color];
+}
+
+- (UIImage *)imageWithTintColor:(UIColor *)color renderingMode:(UIImageRenderingMode)renderingMode {
+    if (self.frames.count == 0) {
+        return [super imageWithTintColor:color renderingMode:renderingMode];
+    }
+    if (@available(iOS 13, tvOS 13, *)) {
+        return [self.systemAnimatedImage imageWithTintColor:color renderingMode:renderingMode];
+    }
+    return [super imageWithTintColor:color renderingMode:renderingMode];
+}
+
+- (UIImage *)resizableImageWithCapInsets:(UIEdgeInsets)capInsets {
+    if (self.frames.count == 0) {
+        return [super resizableImageWithCapInsets:capInsets];
+    }
+    return [self.systemAnimatedImage resizableImageWithCapInsets:capInsets];
+}
+
+- (UIImage *)resizableImageWithCapInsets:(UIEdgeInsets)capInsets resizingMode:(UIImageResizingMode)resizingMode {
+    if (self.frames.count == 0) {
+        return [super resizableImageWithCapInsets:capInsets resizingMode:resizingMode];
+    }
+    return [self.systemAnimatedImage resizableImageWithCapInsets:capInsets resizingMode:resizingMode];
+}
+
+- (UIImage *)imageWithAlignmentRectInsets:(UIEdgeInsets)alignmentInsets {
+    if (self.frames.count == 0) {
+        return [super imageWithAlignmentRectInsets:alignmentInsets];
+    }
+    return [self.systemAnimatedImage imageWithAlignmentRectInsets:alignmentInsets];
+}
+
+- (UIImage *)imageFlippedForRightToLeftLayoutDirection {
+    if (self.frames.count == 0) {
+        return [super imageFlippedForRightToLeftLayoutDirection];
+    }
+    return [self.systemAnimatedImage imageFlippedForRightToLeftLayoutDirection];
+}
+#endif
+
+#pragma mark - Metadata
+
+- (BOOL)sd_isAnimated {
+    if (self.frames.count == 0) {
+        return [super sd_isAnimated];
+    }
+    return YES;
+}
+
+- (NSUInteger)sd_imageFrameCount {
+    if (self.frames.count == 0) {
+        return [super sd_imageFrameCount];
+    }
+    return self.frames.count;
+}
+
+@end
+
+#endif
@@ -12,21 +12,47 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
-/// A per-provider (provider means, AnimatedImage object) based frame pool, each player who use the same provider share the same frame buffer
+/// A per-provider (provider means, AnimatedImage object) and per-size based frame pool, each player who use the same provider and the same thumbnail size share the same frame buffer
 @interface SDImageFramePool : NSObject
 
-/// Register and return back a frame pool, also increase reference count
+/// Register and return back a frame pool for full size frames, also increase reference count
 + (instancetype)registerProvider:(id<SDAnimatedImageProvider>)provider;
-/// Unregister a frame pool, also decrease reference count, if zero dealloc the frame pool
+/// Unregister a frame pool for full size frames, also decrease reference count, if zero dealloc the frame pool
 + (void)unregisterProvider:(id<SDAnimatedImageProvider>)provider;
+/// Register and return back a frame pool which decode frames with thumbnail size, also increase reference count. Zero size means full size
++ (instancetype)registerProvider:(id<SDAnimatedImageProvider>)provider thumbnailSize:(CGSize)thumbnailSize;
+/// Unregister a frame pool which decode frames with thumbnail size, also decrease reference count, if zero dealloc the frame pool
++ (void)unregisterProvider:(id<SDAnimatedImageProvider>)provider thumbnailSize:(CGSize)thumbnailSize;
 
 /// Prefetch the current frame, query using `frameAtIndex:` by caller to check whether finished.
 - (void)prefetchFrameAtIndex:(NSUInteger)index;
 
-/// Control the max buffer count for current frame pool, used for RAM/CPU balance, default unlimited
+/// Prefetch the frames from index along the playback direction concurrently, up to `maxConcurrentCount` frames are decoding at the same time. The frames already buffered or decoding are skipped.
+/// @param index The first frame index to prefetch, typically the next frame
+/// @param count The lookahead frame count, limited by `maxBufferCount` (minus one when the play head frame is buffered outside the window)
+- (void)prefetchFramesFromIndex:(NSUInteger)index count:(NSUInteger)count;
+
+/// Update the current play head and the playback direction. The frames are kept by the distance from play head along the playback direction, frames behind the play head are evicted first.
+/// @param index The current frame index
+/// @param reversed Whether the playback is going backward currently
+/// @param bounce Whether the playback bounce at the first and last frame
+- (void)setPlayHeadIndex:(NSUInteger)index reversed:(BOOL)reversed bounce:(BOOL)bounce;
+
+/// Control the max buffer count for current frame pool, used for RAM/CPU balance, default unlimited. This is the capacity of the ring buffer
 @property (nonatomic, assign) NSUInteger maxBufferCount;
 /// Control the max concurrent fetch queue operation count, used for CPU balance, default 1
 @property (nonatomic, assign) NSUInteger maxConcurrentCount;
+/// Control the max count of frames decoding at the same time across all the frame pools, used by `SDAnimatedImageGovernor` to enforce the global CPU budget, default 0
+/// `0` means unlimited, each frame pool is limited only by its `maxConcurrentCount`
+/// @note The decode which can not get a slot does not block the fetch queue worker thread, it waits in FIFO order and is enqueued again when a slot is free
+@property (nonatomic, class, assign) NSUInteger globalMaxConcurrentCount;
+/// The thumbnail size which the frame pool is registered with
+@property (nonatomic, assign, readonly) CGSize preferredThumbnailSize;
+/// Decode the frames with limited pixel size if provider supports `animatedImageFrameAtIndex:thumbnailSize:`, used for lowering decode cost, the same as `preferredThumbnailSize`
+/// @note The frame pool is shared by players, a player which need another size should register the frame pool with that size instead
+@property (nonatomic, assign, readonly) CGSize thumbnailSize;
+/// The average decode duration of recent frames, in seconds
+@property (nonatomic, readonly) NSTimeInterval averageDecodeDuration;
 
 // Frame Operations
 @property (nonatomic, readonly) NSUInteger currentFrameCount;
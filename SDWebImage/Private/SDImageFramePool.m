@@ -10,14 +10,28 @@
 #import "SDInternalMacros.h"
 #import "objc/runtime.h"
 
-@interface SDImageFramePool ()
+@interface SDImageFramePool () {
+    // The ring of frame slots, frame at index `i` is stored in slot `i`, no boxing or hashing for lookup
+    __strong UIImage **_frames;
+    NSUInteger _frameCount;
+    NSUInteger _bufferedCount;
+    // The frames which are decoding in fetch queue
+    NSMutableIndexSet *_fetchingIndexes;
+    // The decodes enqueued in fetch queue, or waiting for a global decode slot
+    NSUInteger _pendingDecodeCount;
+    // Exponential moving average of decode duration
+    NSTimeInterval _averageDecodeDuration;
+    // Playback state for eviction
+    NSUInteger _playHeadIndex;
+    BOOL _reversed;
+    BOOL _bounce;
+}
 
 @property (class, readonly) NSMapTable *providerFramePoolMap;
 
 @property (weak) id<SDAnimatedImageProvider> provider;
 @property (atomic) NSUInteger registerCount;
 
-@property (nonatomic, strong) NSMutableDictionary<NSNumber *, UIImage *> *frameBuffer;
 @property (nonatomic, strong) NSOperationQueue *fetchQueue;
 
 @end
@@ -25,6 +39,12 @@
 // Lock to ensure atomic behavior
 SD_LOCK_DECLARE_STATIC(_providerFramePoolMapLock);
 
+// The global decode slots shared by all the frame pools, which limit can be changed at any time. The decodes can not get a slot wait in FIFO order without blocking the worker thread, and are dispatched to their fetch queue when a slot is free
+SD_LOCK_DECLARE_STATIC(_globalDecodeLock);
+static NSMutableArray<dispatch_block_t> *_globalWaitingDecodes;
+static NSUInteger _globalMaxConcurrentCount = 0;
+static NSUInteger _globalDecodingCount = 0;
+
 @implementation SDImageFramePool
 
 + (NSMapTable *)providerFramePoolMap {
@@ -41,7 +61,7 @@ SD_LOCK_DECLARE_STATIC(_providerFramePoolMapLock);
 - (instancetype)init {
     self = [super init];
     if (self) {
-        _frameBuffer = [NSMutableDictionary dictionary];
+        _fetchingIndexes = [NSMutableIndexSet indexSet];
         _fetchQueue = [[NSOperationQueue alloc] init];
         _fetchQueue.maxConcurrentOperationCount = 1;
         _fetchQueue.name = @"com.hackemist.SDImageFramePool.fetchQueue";
@@ -56,6 +76,7 @@ SD_LOCK_DECLARE_STATIC(_providerFramePoolMapLock);
 #if SD_UIKIT
     [[NSNotificationCenter defaultCenter] removeObserver:self name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
 #endif
+    [self freeBuffer];
 }
 
 - (void)didReceiveMemoryWarning:(NSNotification *)notification {
@@ -65,104 +86,406 @@ SD_LOCK_DECLARE_STATIC(_providerFramePoolMapLock);
 + (void)initialize {
     // Lock to ensure atomic behavior
     SD_LOCK_INIT(_providerFramePoolMapLock);
+    if (self == [SDImageFramePool class]) {
+        SD_LOCK_INIT(_globalDecodeLock);
+        _globalWaitingDecodes = [NSMutableArray array];
+    }
+}
+
++ (NSUInteger)globalMaxConcurrentCount {
+    SD_LOCK(_globalDecodeLock);
+    NSUInteger globalMaxConcurrentCount = _globalMaxConcurrentCount;
+    SD_UNLOCK(_globalDecodeLock);
+    return globalMaxConcurrentCount;
+}
+
++ (void)setGlobalMaxConcurrentCount:(NSUInteger)globalMaxConcurrentCount {
+    NSMutableArray<dispatch_block_t> *admittedDecodes = [NSMutableArray array];
+    SD_LOCK(_globalDecodeLock);
+    _globalMaxConcurrentCount = globalMaxConcurrentCount;
+    // The new limit may have free slots for the waiting decodes
+    while (_globalWaitingDecodes.count > 0 && (_globalMaxConcurrentCount == 0 || _globalDecodingCount < _globalMaxConcurrentCount)) {
+        _globalDecodingCount++;
+        [admittedDecodes addObject:_globalWaitingDecodes.firstObject];
+        [_globalWaitingDecodes removeObjectAtIndex:0];
+    }
+    SD_UNLOCK(_globalDecodeLock);
+    for (dispatch_block_t admittedDecode in admittedDecodes) {
+        admittedDecode();
+    }
+}
+
+// Take a free global decode slot, or put the decode into waiting list and return NO, it's called with the slot taken when another decode release its slot
++ (BOOL)acquireGlobalDecodeSlotOrWait:(dispatch_block_t)waitingDecode {
+    BOOL acquired = NO;
+    SD_LOCK(_globalDecodeLock);
+    if (_globalMaxConcurrentCount == 0 || _globalDecodingCount < _globalMaxConcurrentCount) {
+        _globalDecodingCount++;
+        acquired = YES;
+    } else {
+        [_globalWaitingDecodes addObject:waitingDecode];
+    }
+    SD_UNLOCK(_globalDecodeLock);
+    return acquired;
+}
+
++ (void)releaseGlobalDecodeSlot {
+    dispatch_block_t admittedDecode;
+    SD_LOCK(_globalDecodeLock);
+    if (_globalWaitingDecodes.count > 0 && (_globalMaxConcurrentCount == 0 || _globalDecodingCount <= _globalMaxConcurrentCount)) {
+        // Hand over the slot to the earliest waiting decode
+        admittedDecode = _globalWaitingDecodes.firstObject;
+        [_globalWaitingDecodes removeObjectAtIndex:0];
+    } else {
+        _globalDecodingCount--;
+    }
+    SD_UNLOCK(_globalDecodeLock);
+    if (admittedDecode) {
+        admittedDecode();
+    }
 }
 
 + (instancetype)registerProvider:(id<SDAnimatedImageProvider>)provider {
+    return [self registerProvider:provider thumbnailSize:CGSizeZero];
+}
+
++ (void)unregisterProvider:(id<SDAnimatedImageProvider>)provider {
+    [self unregisterProvider:provider thumbnailSize:CGSizeZero];
+}
+
++ (instancetype)registerProvider:(id<SDAnimatedImageProvider>)provider thumbnailSize:(CGSize)thumbnailSize {
+    NSValue *sizeKey = [NSValue valueWithBytes:&thumbnailSize objCType:@encode(CGSize)];
     // Lock to ensure atomic behavior
     SD_LOCK(_providerFramePoolMapLock);
-    SDImageFramePool *framePool = [self.providerFramePoolMap objectForKey:provider];
+    NSMutableDictionary<NSValue *, SDImageFramePool *> *framePools = [self.providerFramePoolMap objectForKey:provider];
+    if (!framePools) {
+        framePools = [NSMutableDictionary dictionary];
+        [self.providerFramePoolMap setObject:framePools forKey:provider];
+    }
+    SDImageFramePool *framePool = framePools[sizeKey];
     if (!framePool) {
         framePool = [[SDImageFramePool alloc] init];
         framePool.provider = provider;
-        [self.providerFramePoolMap setObject:framePool forKey:provider];
+        framePool->_preferredThumbnailSize = thumbnailSize;
+        framePool->_thumbnailSize = thumbnailSize;
+        framePools[sizeKey] = framePool;
     }
     framePool.registerCount += 1;
     SD_UNLOCK(_providerFramePoolMapLock);
     return framePool;
 }
 
-+ (void)unregisterProvider:(id<SDAnimatedImageProvider>)provider {
++ (void)unregisterProvider:(id<SDAnimatedImageProvider>)provider thumbnailSize:(CGSize)thumbnailSize {
+    NSValue *sizeKey = [NSValue valueWithBytes:&thumbnailSize objCType:@encode(CGSize)];
     // Lock to ensure atomic behavior
     SD_LOCK(_providerFramePoolMapLock);
-    SDImageFramePool *framePool = [self.providerFramePoolMap objectForKey:provider];
+    NSMutableDictionary<NSValue *, SDImageFramePool *> *framePools = [self.providerFramePoolMap objectForKey:provider];
+    SDImageFramePool *framePool = framePools[sizeKey];
     if (!framePool) {
         SD_UNLOCK(_providerFramePoolMapLock);
         return;
     }
     framePool.registerCount -= 1;
     if (framePool.registerCount == 0) {
-        [self.providerFramePoolMap removeObjectForKey:provider];
+        [framePools removeObjectForKey:sizeKey];
+        if (framePools.count == 0) {
+            [self.providerFramePoolMap removeObjectForKey:provider];
+        }
     }
     SD_UNLOCK(_providerFramePoolMapLock);
 }
 
 - (void)prefetchFrameAtIndex:(NSUInteger)index {
+    NSUInteger pendingDecodeCount;
     @synchronized (self) {
-        NSUInteger frameCount = self.frameBuffer.count;
-        if (frameCount > self.maxBufferCount) {
-            // Remove the frame buffer if need
-            // TODO, use LRU or better algorithm to detect which frames to clear
-            self.frameBuffer[@(index - 1)] = nil;
-            self.frameBuffer[@(index + 1)] = nil;
-        }
+        pendingDecodeCount = _pendingDecodeCount;
     }
-    
-    if (self.fetchQueue.operationCount == 0) {
+    if (pendingDecodeCount == 0) {
         // Prefetch next frame in background queue
         @weakify(self);
-        NSOperation *operation = [NSBlockOperation blockOperationWithBlock:^{
+        [self addDecodeOperationWithBlock:^{
             @strongify(self);
             if (!self) {
                 return;
             }
-            id<SDAnimatedImageProvider> animatedProvider = self.provider;
-            if (!animatedProvider) {
-                return;
-            }
-            UIImage *frame = [animatedProvider animatedImageFrameAtIndex:index];
+            UIImage *frame = [self decodeFrameAtIndex:index];
             
             [self setFrame:frame atIndex:index];
         }];
-        [self.fetchQueue addOperation:operation];
+    }
+}
+
+- (void)prefetchFramesFromIndex:(NSUInteger)index count:(NSUInteger)count {
+    NSMutableIndexSet *fetchIndexes = [NSMutableIndexSet indexSet];
+    NSMutableArray<NSNumber *> *orderedIndexes = [NSMutableArray arrayWithCapacity:count];
+    @synchronized (self) {
+        if (_frameCount == 0) {
+            [self resizeBufferWithFrameCount:self.provider.animatedImageFrameCount];
+        }
+        NSUInteger frameCount = _frameCount;
+        if (frameCount == 0 || index >= frameCount) {
+            return;
+        }
+        // Respect the memory budget, the lookahead window can not exceed the buffer
+        if (_maxBufferCount > 0) {
+            NSUInteger capacity = _maxBufferCount;
+            if (index != _playHeadIndex && _playHeadIndex < frameCount && _frames[_playHeadIndex]) {
+                // The play head frame is always kept and takes one slot, the frames beyond would be decoded and dropped
+                capacity -= 1;
+            }
+            count = MIN(count, capacity);
+        }
+        count = MIN(count, frameCount);
+        // Walk along the playback direction, the same as player
+        BOOL reversed = _reversed;
+        for (NSUInteger i = 0; i < count; i++) {
+            if (!_frames[index] && ![_fetchingIndexes containsIndex:index] && ![fetchIndexes containsIndex:index]) {
+                [fetchIndexes addIndex:index];
+                [orderedIndexes addObject:@(index)];
+            }
+            if (_bounce) {
+                if (index == 0) {
+                    reversed = NO;
+                } else if (index == frameCount - 1) {
+                    reversed = YES;
+                }
+            }
+            index = reversed ? (index + frameCount - 1) % frameCount : (index + 1) % frameCount;
+        }
+        [_fetchingIndexes addIndexes:fetchIndexes];
+    }
+    
+    // Enqueue in playback order, the nearer frame start decoding first
+    for (NSNumber *fetchIndex in orderedIndexes) {
+        NSUInteger frameIndex = fetchIndex.unsignedIntegerValue;
+        @weakify(self);
+        [self addDecodeOperationWithBlock:^{
+            @strongify(self);
+            if (!self) {
+                return;
+            }
+            UIImage *frame = [self decodeFrameAtIndex:frameIndex];
+            @synchronized (self) {
+                [self->_fetchingIndexes removeIndex:frameIndex];
+            }
+            if (frame) {
+                [self setFrame:frame atIndex:frameIndex];
+            }
+        }];
+    }
+}
+
+// Run the decode in fetch queue with a global decode slot. When there is no free slot, the operation finish immediately instead of blocking the worker thread, and the decode is enqueued again when a slot is handed over
+- (void)addDecodeOperationWithBlock:(dispatch_block_t)block {
+    @synchronized (self) {
+        _pendingDecodeCount++;
+    }
+    NSOperationQueue *fetchQueue = self.fetchQueue;
+    @weakify(self);
+    dispatch_block_t decode = ^{
+        block();
+        [SDImageFramePool releaseGlobalDecodeSlot];
+        @strongify(self);
+        if (!self) {
+            return;
+        }
+        @synchronized (self) {
+            self->_pendingDecodeCount--;
+        }
+    };
+    dispatch_block_t waitingDecode = ^{
+        // The slot is already taken for it
+        [fetchQueue addOperationWithBlock:decode];
+    };
+    [fetchQueue addOperationWithBlock:^{
+        if ([SDImageFramePool acquireGlobalDecodeSlotOrWait:waitingDecode]) {
+            decode();
+        }
+    }];
+}
+
+// Decode frame from provider and measure the decode duration, called in fetch queue
+- (UIImage *)decodeFrameAtIndex:(NSUInteger)index {
+    id<SDAnimatedImageProvider> animatedProvider = self.provider;
+    if (!animatedProvider) {
+        return nil;
+    }
+    CGSize thumbnailSize = self.thumbnailSize;
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    UIImage *frame;
+    if (thumbnailSize.width > 0 && thumbnailSize.height > 0 && [animatedProvider respondsToSelector:@selector(animatedImageFrameAtIndex:thumbnailSize:)]) {
+        frame = [animatedProvider animatedImageFrameAtIndex:index thumbnailSize:thumbnailSize];
+    } else {
+        frame = [animatedProvider animatedImageFrameAtIndex:index];
+    }
+    NSTimeInterval decodeDuration = CFAbsoluteTimeGetCurrent() - startTime;
+    @synchronized (self) {
+        if (_averageDecodeDuration == 0) {
+            _averageDecodeDuration = decodeDuration;
+        } else {
+            _averageDecodeDuration = _averageDecodeDuration * 0.75 + decodeDuration * 0.25;
+        }
+    }
+    return frame;
+}
+
+- (NSTimeInterval)averageDecodeDuration {
+    NSTimeInterval averageDecodeDuration;
+    @synchronized (self) {
+        averageDecodeDuration = _averageDecodeDuration;
+    }
+    return averageDecodeDuration;
+}
+
+- (void)setPlayHeadIndex:(NSUInteger)index reversed:(BOOL)reversed bounce:(BOOL)bounce {
+    @synchronized (self) {
+        _playHeadIndex = index;
+        _reversed = reversed;
+        _bounce = bounce;
+    }
+}
+
+- (void)setMaxBufferCount:(NSUInteger)maxBufferCount {
+    @synchronized (self) {
+        _maxBufferCount = maxBufferCount;
+        // Evict frames behind the play head until within the new limit
+        while (_maxBufferCount > 0 && _bufferedCount > _maxBufferCount) {
+            if (![self evictFrameBeforeIndex:_playHeadIndex]) {
+                break;
+            }
+        }
     }
 }
 
 - (void)setMaxConcurrentCount:(NSUInteger)maxConcurrentCount {
+    _maxConcurrentCount = maxConcurrentCount;
     self.fetchQueue.maxConcurrentOperationCount = maxConcurrentCount;
 }
 
 - (NSUInteger)currentFrameCount {
     NSUInteger frameCount = 0;
     @synchronized (self) {
-        frameCount = self.frameBuffer.count;
+        frameCount = _bufferedCount;
     }
     return frameCount;
 }
 
 - (void)setFrame:(UIImage *)frame atIndex:(NSUInteger)index {
     @synchronized (self) {
-        self.frameBuffer[@(index)] = frame;
+        if (!frame) {
+            [self clearFrameAtIndex:index];
+            return;
+        }
+        if (index >= _frameCount) {
+            // Frame count may grow for progressive animated image
+            [self resizeBufferWithFrameCount:MAX(self.provider.animatedImageFrameCount, index + 1)];
+        }
+        if (!_frames[index] && _maxBufferCount > 0 && _bufferedCount >= _maxBufferCount) {
+            // Buffer is full, evict one frame which is farther than this one from play head
+            if (![self evictFrameBeforeIndex:index]) {
+                return;
+            }
+        }
+        if (!_frames[index]) {
+            _bufferedCount++;
+        }
+        _frames[index] = frame;
     }
 }
 
 - (UIImage *)frameAtIndex:(NSUInteger)index {
     UIImage *frame;
     @synchronized (self) {
-        frame = self.frameBuffer[@(index)];
+        if (index < _frameCount) {
+            frame = _frames[index];
+        }
     }
     return frame;
 }
 
 - (void)removeFrameAtIndex:(NSUInteger)index {
     @synchronized (self) {
-        self.frameBuffer[@(index)] = nil;
+        [self clearFrameAtIndex:index];
     }
 }
 
 - (void)removeAllFrames {
     @synchronized (self) {
-        [self.frameBuffer removeAllObjects];
+        for (NSUInteger i = 0; i < _frameCount; i++) {
+            _frames[i] = nil;
+        }
+        _bufferedCount = 0;
+    }
+}
+
+#pragma mark - Ring Buffer (Should be called inside lock)
+
+// The frame index in eviction order, rank 0 is the farthest frame from play head along the playback direction (the one just played), rank `frameCount - 2` is the next frame to play
+- (NSUInteger)frameIndexAtEvictionRank:(NSUInteger)rank {
+    NSUInteger head = _playHeadIndex;
+    NSUInteger frameCount = _frameCount;
+    if (!_bounce) {
+        return _reversed ? (head + 1 + rank) % frameCount : (head + frameCount - 1 - rank) % frameCount;
+    }
+    // Bounce, the frames behind play head are played after reaching the first or last frame
+    if (_reversed) {
+        NSUInteger aheadCount = frameCount - 1 - head;
+        return rank < aheadCount ? (frameCount - 1 - rank) : (rank - aheadCount);
+    } else {
+        return rank < head ? rank : (frameCount - 1 - (rank - head));
+    }
+}
+
+// Evict the farthest frame which is farther than `index` from play head, return NO if no such frame
+- (BOOL)evictFrameBeforeIndex:(NSUInteger)index {
+    if (_playHeadIndex >= _frameCount) {
+        _playHeadIndex = 0;
+    }
+    for (NSUInteger rank = 0; rank + 1 < _frameCount; rank++) {
+        NSUInteger evictIndex = [self frameIndexAtEvictionRank:rank];
+        if (evictIndex == index) {
+            break;
+        }
+        if (_frames[evictIndex]) {
+            [self clearFrameAtIndex:evictIndex];
+            return YES;
+        }
+    }
+    if (index == _playHeadIndex) {
+        // The play head frame is always kept
+        return _bufferedCount < _maxBufferCount;
+    }
+    return NO;
+}
+
+- (void)clearFrameAtIndex:(NSUInteger)index {
+    if (index >= _frameCount || !_frames[index]) {
+        return;
+    }
+    _frames[index] = nil;
+    _bufferedCount--;
+}
+
+- (void)resizeBufferWithFrameCount:(NSUInteger)frameCount {
+    __strong UIImage **frames = (__strong UIImage **)calloc(frameCount, sizeof(UIImage *));
+    for (NSUInteger i = 0; i < _frameCount; i++) {
+        frames[i] = _frames[i];
+    }
+    NSUInteger bufferedCount = _bufferedCount;
+    [self freeBuffer];
+    _frames = frames;
+    _frameCount = frameCount;
+    _bufferedCount = bufferedCount;
+}
+
+- (void)freeBuffer {
+    for (NSUInteger i = 0; i < _frameCount; i++) {
+        _frames[i] = nil;
     }
+    free(_frames);
+    _frames = NULL;
+    _frameCount = 0;
+    _bufferedCount = 0;
 }
 
 @end
@@ -0,0 +1,13 @@
+/*
+* This file is part of the SDWebImage package.
+* (c) Olivier Poitrey <rs@dailymotion.com>
+*
+* For the full copyright and license information, please view the LICENSE
+* file that was distributed with this source code.
+*/
+
+#import "SDWebImageCompat.h"
+#import "UIImage+Transform.h"
+
+/// Helper method for image geometry, the draw rect of the size inside rect for scale mode
+FOUNDATION_EXPORT CGRect SDCGRectFitWithScaleMode(CGRect rect, CGSize size, SDImageScaleMode scaleMode);
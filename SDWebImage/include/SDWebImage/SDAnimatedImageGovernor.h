@@ -0,0 +1 @@
+../../Core/SDAnimatedImageGovernor.h
\ No newline at end of file
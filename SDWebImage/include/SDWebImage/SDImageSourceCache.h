@@ -0,0 +1 @@
+../../Core/SDImageSourceCache.h
\ No newline at end of file
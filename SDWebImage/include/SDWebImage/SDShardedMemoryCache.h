@@ -0,0 +1 @@
+../../Core/SDShardedMemoryCache.h
\ No newline at end of file
@@ -50,6 +50,64 @@ static BOOL _isCalled;
 
 @end
 
+// The frames decoding at the same time across all the slow providers
+static NSUInteger SDSlowAnimatedImageDecodingCount = 0;
+static NSUInteger SDSlowAnimatedImageMaxDecodingCount = 0;
+
+// Provider which decode slower than the frame rate
+@interface SDSlowAnimatedImageProvider : NSObject <SDAnimatedImageProvider>
+
+@property (nonatomic, strong) SDAnimatedImage *image;
+@property (nonatomic, assign) NSTimeInterval decodeDelay;
+@property (atomic, assign) BOOL thumbnailDecodeCalled;
+@property (atomic, assign) NSUInteger decodeCount;
+
+@end
+
+@implementation SDSlowAnimatedImageProvider
+
+- (NSData *)animatedImageData {
+    return self.image.animatedImageData;
+}
+
+- (NSUInteger)animatedImageFrameCount {
+    return self.image.animatedImageFrameCount;
+}
+
+- (NSUInteger)animatedImageLoopCount {
+    return 0;
+}
+
+- (NSTimeInterval)animatedImageDurationAtIndex:(NSUInteger)index {
+    return 0.02;
+}
+
+- (UIImage *)animatedImageFrameAtIndex:(NSUInteger)index {
+    @synchronized (self) {
+        self.decodeCount += 1;
+    }
+    @synchronized (SDSlowAnimatedImageProvider.class) {
+        SDSlowAnimatedImageDecodingCount += 1;
+        SDSlowAnimatedImageMaxDecodingCount = MAX(SDSlowAnimatedImageMaxDecodingCount, SDSlowAnimatedImageDecodingCount);
+    }
+    [NSThread sleepForTimeInterval:self.decodeDelay];
+    @synchronized (SDSlowAnimatedImageProvider.class) {
+        SDSlowAnimatedImageDecodingCount -= 1;
+    }
+    return [self.image animatedImageFrameAtIndex:index];
+}
+
+- (UIImage *)animatedImageFrameAtIndex:(NSUInteger)index thumbnailSize:(CGSize)thumbnailSize {
+    self.thumbnailDecodeCalled = YES;
+    @synchronized (self) {
+        self.decodeCount += 1;
+    }
+    [NSThread sleepForTimeInterval:self.decodeDelay];
+    return [self.image animatedImageFrameAtIndex:index thumbnailSize:thumbnailSize];
+}
+
+@end
+
 // Internal header
 @interface SDAnimatedImageView ()
 
@@ -61,6 +119,10 @@ static BOOL _isCalled;
 @interface SDAnimatedImagePlayer ()
 
 @property (nonatomic, strong) SDImageFramePool *framePool;
+@property (nonatomic, strong, readwrite) UIImage *currentFrame;
+@property (nonatomic, assign) NSUInteger consecutiveSkippedFrameCount;
+
+- (void)reduceDecodeResolutionIfNeeded;
 
 @end
 
@@ -816,6 +878,425 @@ static BOOL _isCalled;
     expect(scaledImage).notTo.equal(image);
 }
 
+- (void)test38FramePoolForwardPlaybackWithTightBuffer {
+    [self checkFramePoolPlaybackWithReverse:NO bounce:NO];
+}
+
+- (void)test39FramePoolReversePlaybackWithTightBuffer {
+    [self checkFramePoolPlaybackWithReverse:YES bounce:NO];
+}
+
+- (void)test40FramePoolBouncePlaybackWithTightBuffer {
+    [self checkFramePoolPlaybackWithReverse:NO bounce:YES];
+    [self checkFramePoolPlaybackWithReverse:YES bounce:YES];
+}
+
+- (void)test41FramePoolLookaheadPrefetchConcurrently {
+    SDAnimatedImage *image = [SDAnimatedImage imageWithData:[self testAPNGPData]];
+    NSUInteger frameCount = image.animatedImageFrameCount;
+    expect(frameCount).beGreaterThan(4);
+    SDImageFramePool *framePool = [SDImageFramePool registerProvider:image];
+    [framePool removeAllFrames];
+    framePool.maxConcurrentCount = 3;
+    framePool.maxBufferCount = 3;
+    [framePool setPlayHeadIndex:0 reversed:NO bounce:NO];
+    // Lookahead window is limited by buffer count
+    [framePool prefetchFramesFromIndex:1 count:4];
+    
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:kAsyncTestTimeout];
+    while (framePool.currentFrameCount < 3 && [deadline timeIntervalSinceNow] > 0) {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    expect(framePool.currentFrameCount).equal(3);
+    expect([framePool frameAtIndex:1]).notTo.beNil();
+    expect([framePool frameAtIndex:2]).notTo.beNil();
+    expect([framePool frameAtIndex:3]).notTo.beNil();
+    expect([framePool frameAtIndex:4]).beNil();
+    
+    [framePool removeAllFrames];
+    [SDImageFramePool unregisterProvider:image];
+}
+
+- (void)test42AnimatedImagePlayerLookaheadPlayInOrder {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"test SDAnimatedImagePlayer lookahead play in order"];
+    
+    SDAnimatedImage *image = [SDAnimatedImage imageWithData:[self testAPNGPData]];
+    SDAnimatedImagePlayer *player = [SDAnimatedImagePlayer playerWithProvider:image];
+    player.lookaheadFrameCount = 4;
+    
+    __block NSUInteger i = 0;
+    __weak SDAnimatedImagePlayer *wplayer = player;
+    [player setAnimationFrameHandler:^(NSUInteger index, UIImage * _Nonnull frame) {
+        expect(index).equal(i);
+        expect(frame).notTo.beNil();
+        if (index == wplayer.totalFrameCount - 1) {
+            double bufferMissesPerSecond = wplayer.bufferMissesPerSecond;
+            NSLog(@"Lookahead playback buffer misses per second: %.2f", bufferMissesPerSecond);
+            expect(bufferMissesPerSecond).beGreaterThanOrEqualTo(0);
+            [wplayer stopPlaying];
+            expect(wplayer.bufferMissesPerSecond).equal(0);
+            [expectation fulfill];
+            return;
+        }
+        i++;
+    }];
+    
+    [player startPlaying];
+    
+    [self waitForExpectationsWithTimeout:15 handler:nil];
+}
+
+- (void)test43AnimatedImagePlayerRealTimePlaybackSkipFrames {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"test SDAnimatedImagePlayer real-time playback skip frames"];
+    
+    SDSlowAnimatedImageProvider *provider = [SDSlowAnimatedImageProvider new];
+    provider.image = [SDAnimatedImage imageWithData:[self testAPNGPData]];
+    provider.decodeDelay = 0.1; // 5 times slower than frame duration
+    SDAnimatedImagePlayer *player = [SDAnimatedImagePlayer playerWithProvider:provider];
+    player.realTimePlayback = YES;
+    
+    NSMutableArray<NSNumber *> *indexes = [NSMutableArray array];
+    [player setAnimationFrameHandler:^(NSUInteger index, UIImage * _Nonnull frame) {
+        [indexes addObject:@(index)];
+    }];
+    [player startPlaying];
+    
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(2 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        // Play head follows wall-clock time, not the decoding speed
+        expect(player.skippedFrameCount).beGreaterThan(0);
+        BOOL hasSkippedIndex = NO;
+        for (NSUInteger i = 1; i < indexes.count; i++) {
+            if (indexes[i].unsignedIntegerValue > indexes[i - 1].unsignedIntegerValue + 1) {
+                hasSkippedIndex = YES;
+            }
+        }
+        expect(hasSkippedIndex).beTruthy();
+        // Sustained buffer miss lower the decode resolution
+        expect(provider.thumbnailDecodeCalled).beTruthy();
+        [player stopPlaying];
+        expect(player.skippedFrameCount).equal(0);
+        [expectation fulfill];
+    });
+    
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)test44AnimatedImagePlayerSharedDisplayLinkBenchmark {
+    NSData *data = [self testGIFData];
+    for (NSNumber *count in @[@1, @10, @40]) {
+        NSMutableArray<SDAnimatedImagePlayer *> *players = [NSMutableArray array];
+        __block NSUInteger frameChangeCount = 0;
+        for (NSUInteger i = 0; i < count.unsignedIntegerValue; i++) {
+            SDAnimatedImagePlayer *player = [SDAnimatedImagePlayer playerWithProvider:[SDAnimatedImage imageWithData:data]];
+            player.animationFrameHandler = ^(NSUInteger index, UIImage * _Nonnull frame) {
+                frameChangeCount++;
+            };
+            [players addObject:player];
+            [player startPlaying];
+        }
+        // Measure the main thread CPU time, which all display link callbacks run on
+        struct timespec start, end;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+        [[NSRunLoop mainRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:1]];
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &end);
+        double mainThreadTime = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1000000.0;
+        NSLog(@"Shared display link with %@ players: main thread %.2f ms per second, %lu frame changes", count, mainThreadTime, (unsigned long)frameChangeCount);
+        expect(frameChangeCount).beGreaterThan(0);
+        for (SDAnimatedImagePlayer *player in players) {
+            [player stopPlaying];
+        }
+    }
+}
+
+- (void)test45AnimatedImageGovernorSplitBudget {
+    SDAnimatedImageGovernor *governor = [SDAnimatedImageGovernor new];
+    governor.maxMemoryCost = 1000;
+    governor.maxConcurrentDecodeCount = 4;
+    // Player 1 and 2 share the same frame pool
+    SDAnimatedImage *image1 = [SDAnimatedImage imageWithData:[self testGIFData]];
+    SDAnimatedImage *image2 = [SDAnimatedImage imageWithData:[self testGIFData]];
+    SDAnimatedImagePlayer *player1 = [SDAnimatedImagePlayer playerWithProvider:image1];
+    SDAnimatedImagePlayer *player2 = [SDAnimatedImagePlayer playerWithProvider:image1];
+    SDAnimatedImagePlayer *player3 = [SDAnimatedImagePlayer playerWithProvider:image2];
+    expect(player1.framePool).equal(player2.framePool);
+    [governor registerPlayer:player1 visibleArea:100];
+    [governor registerPlayer:player2 visibleArea:100];
+    [governor registerPlayer:player3 visibleArea:200];
+    
+    NSArray<SDAnimatedImageBudgetAllocation *> *allocations = governor.allocations;
+    expect(allocations.count).equal(3);
+    expect(allocations[0].player).equal(player1);
+    expect(allocations[0].frameRate).beGreaterThan(0);
+    expect(allocations[0].memoryCost).equal(500);
+    expect(allocations[1].memoryCost).equal(500);
+    expect(allocations[2].memoryCost).equal(500);
+    expect(allocations[2].concurrentDecodeCount).equal(2);
+    
+    // Rebalance when the playback rate changed
+    double frameRate = allocations[2].frameRate;
+    player3.playbackRate = 2;
+    allocations = governor.allocations;
+    expect(allocations[2].frameRate).beCloseToWithin(frameRate * 2, 0.001);
+    expect(allocations[2].memoryCost).beGreaterThan(500);
+    
+    // Rebalance when detached
+    [governor unregisterPlayer:player3];
+    allocations = governor.allocations;
+    expect(allocations.count).equal(2);
+    expect(allocations[0].memoryCost).equal(1000);
+    expect(allocations[0].concurrentDecodeCount).equal(4);
+}
+
+- (void)test46AnimatedImageViewRegisterGovernorWhenMoveToWindow {
+    SDAnimatedImageView *imageView = [[SDAnimatedImageView alloc] initWithFrame:CGRectMake(0, 0, 100, 100)];
+    imageView.image = [SDAnimatedImage imageWithData:[self testGIFData]];
+    SDAnimatedImagePlayer *player = imageView.player;
+    expect(player).notTo.beNil();
+    SDAnimatedImageBudgetAllocation * (^registeredAllocation)(void) = ^SDAnimatedImageBudgetAllocation * {
+        for (SDAnimatedImageBudgetAllocation *allocation in SDAnimatedImageGovernor.sharedGovernor.allocations) {
+            if (allocation.player == player) {
+                return allocation;
+            }
+        }
+        return nil;
+    };
+    expect(registeredAllocation()).beNil();
+#if SD_UIKIT
+    [self.window addSubview:imageView];
+#else
+    [self.window.contentView addSubview:imageView];
+#endif
+    expect(registeredAllocation().visibleArea).equal(100 * 100);
+    [imageView removeFromSuperview];
+    expect(registeredAllocation()).beNil();
+    
+    // Only the part not clipped by superview is visible
+    UIView *containerView = [[UIView alloc] initWithFrame:CGRectMake(0, 0, 100, 50)];
+#if SD_UIKIT
+    containerView.clipsToBounds = YES;
+    [self.window addSubview:containerView];
+#else
+    containerView.wantsLayer = YES;
+    containerView.layer.masksToBounds = YES;
+    [self.window.contentView addSubview:containerView];
+#endif
+    [containerView addSubview:imageView];
+    expect(registeredAllocation().visibleArea).equal(100 * 50);
+    [containerView removeFromSuperview];
+    expect(registeredAllocation()).beNil();
+}
+
+- (void)test47AnimatedImagePlayerDecodeAtThumbnailPixelSize {
+    SDAnimatedImage *image = [SDAnimatedImage imageWithData:[self testGIFData]];
+    SDAnimatedImagePlayer *player1 = [SDAnimatedImagePlayer playerWithProvider:image];
+    SDAnimatedImagePlayer *player2 = [SDAnimatedImagePlayer playerWithProvider:image];
+    SDAnimatedImagePlayer *player3 = [SDAnimatedImagePlayer playerWithProvider:image];
+    player1.thumbnailPixelSize = CGSizeMake(20, 20);
+    player2.thumbnailPixelSize = CGSizeMake(20, 20);
+    // Frame pool is shared only for the same pixel size
+    expect(player1.framePool).equal(player2.framePool);
+    expect(player1.framePool).notTo.equal(player3.framePool);
+    expect(player1.framePool.thumbnailSize).equal(CGSizeMake(20, 20));
+    expect(player3.framePool.thumbnailSize).equal(CGSizeZero);
+    
+    SDImageFramePool *framePool = player1.framePool;
+    [framePool prefetchFrameAtIndex:1];
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:kAsyncTestTimeout];
+    while (![framePool frameAtIndex:1] && [deadline timeIntervalSinceNow] > 0) {
+        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    UIImage *frame = [framePool frameAtIndex:1];
+    expect(frame).notTo.beNil();
+    // Decoded at thumbnail pixel size instead of the full pixel size
+    CGSize pixelSize = CGSizeMake(frame.size.width * frame.scale, frame.size.height * frame.scale);
+    expect(pixelSize.width).beLessThanOrEqualTo(20);
+    expect(pixelSize.height).beLessThanOrEqualTo(20);
+    
+    // Back to full size
+    player2.thumbnailPixelSize = CGSizeZero;
+    expect(player2.framePool).equal(player3.framePool);
+    expect(player2.framePool).notTo.equal(framePool);
+}
+
+- (void)test48AnimatedImageViewDecodeAtDisplaySize {
+    SDAnimatedImageView *imageView = [[SDAnimatedImageView alloc] initWithFrame:CGRectMake(0, 0, 10, 10)];
+    imageView.decodeAtDisplaySize = YES;
+#if SD_UIKIT
+    imageView.contentMode = UIViewContentModeScaleAspectFit;
+#else
+    imageView.imageScaling = NSImageScaleProportionallyUpOrDown;
+#endif
+    // TestImage.gif is 50x50 pixels
+    imageView.image = [SDAnimatedImage imageWithData:[self testGIFData]];
+    expect(imageView.player.thumbnailPixelSize).equal(CGSizeZero);
+#if SD_UIKIT
+    [self.window addSubview:imageView];
+    CGFloat screenScale = self.window.screen.scale;
+#else
+    [self.window.contentView addSubview:imageView];
+    CGFloat screenScale = self.window.backingScaleFactor;
+#endif
+    // Rounded up to the size bucket, never below the rendered pixel size
+    CGSize pixelSize = imageView.player.thumbnailPixelSize;
+    expect(pixelSize.width).beGreaterThanOrEqualTo(ceil(10 * screenScale));
+    expect(pixelSize.width).beLessThan(50);
+    expect(pixelSize.height).equal(pixelSize.width);
+    expect(imageView.player.framePool.thumbnailSize).equal(pixelSize);
+    
+    // Small bounds change in the same size bucket, keep the frame pool
+    SDImageFramePool *framePool = imageView.player.framePool;
+    imageView.frame = CGRectMake(0, 0, 10.5, 10.5);
+    [self layoutImageView:imageView];
+    expect(imageView.player.framePool).equal(framePool);
+    
+    // Not smaller than the image, decode full size
+    imageView.frame = CGRectMake(0, 0, 100, 100);
+    [self layoutImageView:imageView];
+    expect(imageView.player.thumbnailPixelSize).equal(CGSizeZero);
+    
+    // Stretched, each axis need to cover the bounds
+    imageView.frame = CGRectMake(0, 0, 40 / screenScale, 10 / screenScale);
+#if SD_UIKIT
+    imageView.contentMode = UIViewContentModeScaleToFill;
+#else
+    imageView.imageScaling = NSImageScaleAxesIndependently;
+#endif
+    [self layoutImageView:imageView];
+    pixelSize = imageView.player.thumbnailPixelSize;
+    expect(pixelSize.width).beGreaterThanOrEqualTo(40);
+    expect(pixelSize.height).beGreaterThanOrEqualTo(10);
+    
+    // Not scaled, draw at natural size
+#if SD_UIKIT
+    imageView.contentMode = UIViewContentModeCenter;
+#else
+    imageView.imageScaling = NSImageScaleNone;
+#endif
+    expect(imageView.player.thumbnailPixelSize).equal(CGSizeZero);
+    
+    imageView.frame = CGRectMake(0, 0, 10, 10);
+    imageView.decodeAtDisplaySize = NO;
+    expect(imageView.player.thumbnailPixelSize).equal(CGSizeZero);
+    [imageView removeFromSuperview];
+}
+
+- (void)test49FramePoolLookaheadKeepSlotForPlayHeadFrame {
+    SDSlowAnimatedImageProvider *provider = [SDSlowAnimatedImageProvider new];
+    provider.image = [SDAnimatedImage imageWithData:[self testAPNGPData]];
+    expect(provider.animatedImageFrameCount).beGreaterThan(4);
+    SDImageFramePool *framePool = [SDImageFramePool registerProvider:provider];
+    framePool.maxConcurrentCount = 3;
+    framePool.maxBufferCount = 3;
+    [framePool setPlayHeadIndex:0 reversed:NO bounce:NO];
+    // The play head frame is on screen, it takes one slot of the buffer
+    [framePool setFrame:[provider.image animatedImageFrameAtIndex:0] atIndex:0];
+    [framePool prefetchFramesFromIndex:1 count:4];
+    
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:kAsyncTestTimeout];
+    while (framePool.currentFrameCount < 3 && [deadline timeIntervalSinceNow] > 0) {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    // Wait a little more, to catch the frames decoded but dropped
+    [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.1]];
+    expect(framePool.currentFrameCount).equal(3);
+    expect([framePool frameAtIndex:0]).notTo.beNil();
+    expect([framePool frameAtIndex:1]).notTo.beNil();
+    expect([framePool frameAtIndex:2]).notTo.beNil();
+    expect([framePool frameAtIndex:3]).beNil();
+    // Only the frames which fit into the buffer are decoded
+    expect(provider.decodeCount).equal(2);
+    
+    [framePool removeAllFrames];
+    [SDImageFramePool unregisterProvider:provider];
+}
+
+- (void)test50AnimatedImagePlayerReduceResolutionNotAffectSharedFramePool {
+    SDAnimatedImage *image = [SDAnimatedImage imageWithData:[self testGIFData]];
+    SDAnimatedImagePlayer *player1 = [SDAnimatedImagePlayer playerWithProvider:image];
+    SDAnimatedImagePlayer *player2 = [SDAnimatedImagePlayer playerWithProvider:image];
+    SDImageFramePool *sharedFramePool = player1.framePool;
+    expect(player2.framePool).equal(sharedFramePool);
+    
+    // Sustained buffer miss on player1, TestImage.gif is 50x50 pixels
+    player1.currentFrame = [image animatedImageFrameAtIndex:0];
+    player1.consecutiveSkippedFrameCount = 10;
+    [player1 reduceDecodeResolutionIfNeeded];
+    expect(player1.framePool).notTo.equal(sharedFramePool);
+    expect(player1.framePool.thumbnailSize).equal(CGSizeMake(25, 25));
+    // Other player keep the full resolution
+    expect(player2.framePool).equal(sharedFramePool);
+    expect(sharedFramePool.thumbnailSize).equal(CGSizeZero);
+    
+    // Back to the shared frame pool after reset
+    [player1 stopPlaying];
+    expect(player1.framePool).equal(sharedFramePool);
+    
+    // Change thumbnail size when reduced, back to the frame pool of that size
+    player1.currentFrame = [image animatedImageFrameAtIndex:0];
+    player1.consecutiveSkippedFrameCount = 10;
+    [player1 reduceDecodeResolutionIfNeeded];
+    player1.thumbnailPixelSize = CGSizeMake(20, 20);
+    expect(player1.framePool.thumbnailSize).equal(CGSizeMake(20, 20));
+    player1.thumbnailPixelSize = CGSizeZero;
+    expect(player1.framePool).equal(sharedFramePool);
+}
+
+- (void)test51AnimatedImageGovernorEnforceGlobalDecodeLimit {
+    SDAnimatedImageGovernor *governor = [SDAnimatedImageGovernor new];
+    governor.maxConcurrentDecodeCount = 2;
+    NSData *data = [self testAPNGPData];
+    NSMutableArray<SDAnimatedImagePlayer *> *players = [NSMutableArray array];
+    // 4 frame pools, each one is allocated the minimum one worker
+    for (NSUInteger i = 0; i < 4; i++) {
+        SDSlowAnimatedImageProvider *provider = [SDSlowAnimatedImageProvider new];
+        provider.image = [SDAnimatedImage imageWithData:data];
+        provider.decodeDelay = 0.05;
+        SDAnimatedImagePlayer *player = [SDAnimatedImagePlayer playerWithProvider:provider];
+        player.lookaheadFrameCount = 4;
+        [governor registerPlayer:player visibleArea:100];
+        [players addObject:player];
+    }
+    expect(SDImageFramePool.globalMaxConcurrentCount).equal(2);
+    @synchronized (SDSlowAnimatedImageProvider.class) {
+        SDSlowAnimatedImageMaxDecodingCount = 0;
+    }
+    for (SDAnimatedImagePlayer *player in players) {
+        expect(player.framePool.maxConcurrentCount).equal(1);
+        [player.framePool prefetchFramesFromIndex:0 count:2];
+    }
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:kAsyncTestTimeout];
+    BOOL (^allDecoded)(void) = ^BOOL {
+        for (SDAnimatedImagePlayer *player in players) {
+            if (player.framePool.currentFrameCount < 2) {
+                return NO;
+            }
+        }
+        return YES;
+    };
+    while (!allDecoded() && [deadline timeIntervalSinceNow] > 0) {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    expect(allDecoded()).beTruthy();
+    // The sum of the workers is 4, but the frames decoding at the same time never exceed the budget
+    @synchronized (SDSlowAnimatedImageProvider.class) {
+        expect(SDSlowAnimatedImageMaxDecodingCount).beGreaterThan(0);
+        expect(SDSlowAnimatedImageMaxDecodingCount).beLessThanOrEqualTo(2);
+    }
+    
+    // Lookahead not specified by user, use the allocated concurrent decode count
+    for (SDAnimatedImagePlayer *player in players) {
+        [governor unregisterPlayer:player];
+    }
+    expect(SDImageFramePool.globalMaxConcurrentCount).equal(0);
+    SDAnimatedImagePlayer *player = players.firstObject;
+    player.lookaheadFrameCount = 0;
+    governor.maxConcurrentDecodeCount = 4;
+    [governor registerPlayer:player visibleArea:100];
+    expect(player.framePool.maxConcurrentCount).equal(MIN(4, NSProcessInfo.processInfo.activeProcessorCount));
+    [governor unregisterPlayer:player];
+    expect(player.framePool.maxConcurrentCount).equal(1);
+}
+
 - (void)testAnimationTransformerWorks {
     XCTestExpectation *expectation = [self expectationWithDescription:@"test SDAnimatedImageView animationTransformer works"];
     SDAnimatedImageView *imageView = [SDAnimatedImageView new];
@@ -852,6 +1333,69 @@ static BOOL _isCalled;
 
 #pragma mark - Helper
 
+// Simulate the player, walk the play head for 3 loops and fill the look-ahead window, check the frames behind play head are evicted
+- (void)checkFramePoolPlaybackWithReverse:(BOOL)reverse bounce:(BOOL)bounce {
+    SDAnimatedImage *image = [SDAnimatedImage imageWithData:[self testGIFData]];
+    NSUInteger frameCount = image.animatedImageFrameCount;
+    expect(frameCount).beGreaterThan(3);
+    SDImageFramePool *framePool = [SDImageFramePool registerProvider:image];
+    NSUInteger lookAheadCount = 3;
+    framePool.maxBufferCount = lookAheadCount;
+    
+    NSUInteger head = reverse ? frameCount - 1 : 0;
+    BOOL shouldReverse = reverse;
+    for (NSUInteger step = 0; step < frameCount * 3; step++) {
+        if (bounce) {
+            if (head == 0) {
+                shouldReverse = NO;
+            } else if (head == frameCount - 1) {
+                shouldReverse = YES;
+            }
+        }
+        [framePool setPlayHeadIndex:head reversed:shouldReverse bounce:bounce];
+        // Fill the look-ahead window in playback order
+        NSMutableArray<NSNumber *> *window = [NSMutableArray array];
+        NSUInteger index = head;
+        BOOL windowReverse = shouldReverse;
+        for (NSUInteger i = 0; i < lookAheadCount; i++) {
+            [window addObject:@(index)];
+            if (![framePool frameAtIndex:index]) {
+                [framePool setFrame:[image animatedImageFrameAtIndex:index] atIndex:index];
+            }
+            if (bounce && index == frameCount - 1) {
+                windowReverse = YES;
+            } else if (bounce && index == 0) {
+                windowReverse = NO;
+            }
+            index = windowReverse ? (index + frameCount - 1) % frameCount : (index + 1) % frameCount;
+        }
+        expect(framePool.currentFrameCount).beLessThanOrEqualTo(lookAheadCount);
+        for (NSNumber *windowIndex in window) {
+            expect([framePool frameAtIndex:windowIndex.unsignedIntegerValue]).notTo.beNil();
+        }
+        if (!bounce && step > 0) {
+            // The frame just played is evicted
+            NSUInteger previous = shouldReverse ? (head + 1) % frameCount : (head + frameCount - 1) % frameCount;
+            expect([framePool frameAtIndex:previous]).beNil();
+        }
+        head = [window[1] unsignedIntegerValue];
+    }
+    
+    [framePool removeAllFrames];
+    expect(framePool.currentFrameCount).equal(0);
+    [SDImageFramePool unregisterProvider:image];
+}
+
+- (void)layoutImageView:(SDAnimatedImageView *)imageView {
+#if SD_UIKIT
+    [imageView setNeedsLayout];
+    [imageView layoutIfNeeded];
+#else
+    imageView.needsLayout = YES;
+    [imageView layoutSubtreeIfNeeded];
+#endif
+}
+
 - (NSString *)testGIFPath {
     NSBundle *testBundle = [NSBundle bundleForClass:[self class]];
     NSString *testPath = [testBundle pathForResource:@"TestImage" ofType:@"gif"];
@@ -10,6 +10,7 @@
 #import "SDWebImageTestCoder.h"
 #import "SDMockFileManager.h"
 #import "SDWebImageTestCache.h"
+#import <mach/mach.h>
 
 static NSString *kTestImageKeyJPEG = @"TestImageKey.jpg";
 static NSString *kTestImageKeyPNG = @"TestImageKey.png";
@@ -630,6 +631,193 @@ static NSString *kTestImageKeyPNG = @"TestImageKey.png";
     [self waitForExpectationsWithTimeout:5 handler:nil];
 }
 
+- (void)test45DiskCacheIndex {
+    NSString *cachePath = [[self userCacheDirectory] stringByAppendingPathComponent:@"diskIndex"];
+    SDImageCacheConfig *config = [[SDImageCacheConfig alloc] init];
+    config.shouldUseDiskCacheIndex = YES;
+    SDDiskCache *diskCache = [[SDDiskCache alloc] initWithCachePath:cachePath config:config];
+    [diskCache removeAllData];
+    expect(diskCache.totalSize).equal(0);
+    expect(diskCache.totalCount).equal(0);
+    NSData *data1 = [@"Index1" dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *data2 = [@"Index22" dataUsingEncoding:NSUTF8StringEncoding];
+    [diskCache setData:data1 forKey:@"Index1.png"];
+    [diskCache setData:data2 forKey:@"Index2.png"];
+    expect([diskCache containsDataForKey:@"Index1.png"]).beTruthy();
+    expect([diskCache containsDataForKey:@"Index3.png"]).beFalsy();
+    expect([diskCache dataForKey:@"Index2.png"]).equal(data2);
+    expect([diskCache dataForKey:@"Index3.png"]).beNil();
+    expect(diskCache.totalSize).equal(data1.length + data2.length);
+    expect(diskCache.totalCount).equal(2);
+    [diskCache removeDataForKey:@"Index1.png"];
+    expect([diskCache containsDataForKey:@"Index1.png"]).beFalsy();
+    expect(diskCache.totalCount).equal(1);
+    
+    // Crash after the data write, before the set record
+    NSData *data3 = [@"Index333" dataUsingEncoding:NSUTF8StringEncoding];
+    NSString *filePath3 = [diskCache cachePathForKey:@"Index3.png"];
+    NSData *nameData3 = [filePath3.lastPathComponent dataUsingEncoding:NSUTF8StringEncoding];
+    NSMutableData *beginRecord = [NSMutableData data];
+    uint8_t op = 4;
+    uint16_t nameLength = (uint16_t)nameData3.length;
+    [beginRecord appendBytes:&op length:sizeof(op)];
+    [beginRecord appendBytes:&nameLength length:sizeof(nameLength)];
+    [beginRecord appendData:nameData3];
+    NSFileHandle *journalHandle = [NSFileHandle fileHandleForWritingAtPath:[cachePath stringByAppendingPathComponent:@".SDDiskCacheIndex"]];
+    [journalHandle seekToEndOfFile];
+    [journalHandle writeData:beginRecord];
+    [journalHandle closeFile];
+    [data3 writeToFile:filePath3 atomically:NO];
+    
+    // Load from journal
+    SDDiskCache *diskCache2 = [[SDDiskCache alloc] initWithCachePath:cachePath config:config];
+    expect(diskCache2.totalSize).equal(data2.length + data3.length);
+    expect(diskCache2.totalCount).equal(2);
+    expect([diskCache2 dataForKey:@"Index2.png"]).equal(data2);
+    expect([diskCache2 containsDataForKey:@"Index3.png"]).beTruthy();
+    
+    // Expire with index
+    config.maxDiskAge = 0;
+    [diskCache2 removeExpiredData];
+    expect(diskCache2.totalCount).equal(0);
+    expect([diskCache2 containsDataForKey:@"Index2.png"]).beFalsy();
+    NSString *filePath = [diskCache2 cachePathForKey:@"Index2.png"];
+    expect([[NSFileManager defaultManager] fileExistsAtPath:filePath]).beFalsy();
+    [diskCache2 removeAllData];
+}
+
+- (void)test45DiskCacheIncrementalEviction {
+    NSString *cachePath = [[self userCacheDirectory] stringByAppendingPathComponent:@"diskEviction"];
+    SDImageCacheConfig *config = [[SDImageCacheConfig alloc] init];
+    config.shouldUseDiskCacheIndex = YES;
+    config.maxDiskSize = 100;
+    config.maxDiskEvictionCount = 2;
+    SDDiskCache *diskCache = [[SDDiskCache alloc] initWithCachePath:cachePath config:config];
+    [diskCache removeAllData];
+    NSUInteger length = 20;
+    void *bytes = calloc(length, 1);
+    NSData *data = [NSData dataWithBytes:bytes length:length];
+    free(bytes);
+    for (NSUInteger i = 0; i < 10; i++) {
+        NSString *key = [NSString stringWithFormat:@"Eviction%@", @(i)];
+        [diskCache setData:data forKey:key];
+        // Keep the first one recently used
+        expect([diskCache dataForKey:@"Eviction0"]).notTo.beNil();
+        // Always under high-water mark
+        expect(diskCache.totalSize).beLessThanOrEqualTo(config.maxDiskSize);
+    }
+    // Oldest removed first, recently used kept
+    expect([diskCache containsDataForKey:@"Eviction0"]).beTruthy();
+    expect([diskCache containsDataForKey:@"Eviction1"]).beFalsy();
+    expect([diskCache containsDataForKey:@"Eviction9"]).beTruthy();
+    
+    // Expire in bounded pass
+    config.maxDiskAge = 0;
+    NSUInteger count = diskCache.totalCount;
+    [diskCache removeExpiredData];
+    expect(diskCache.totalCount).equal(count - config.maxDiskEvictionCount);
+    [diskCache removeAllData];
+}
+
+- (void)test45PackedDiskCache {
+    NSString *cachePath = [[self userCacheDirectory] stringByAppendingPathComponent:@"diskPacked"];
+    SDImageCacheConfig *config = [[SDImageCacheConfig alloc] init];
+    SDPackedDiskCache *diskCache = [[SDPackedDiskCache alloc] initWithCachePath:cachePath config:config];
+    diskCache.maxPackedDataSize = 16;
+    [diskCache removeAllData];
+    expect(diskCache.totalCount).equal(0);
+    NSData *data1 = [@"Packed1" dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *data2 = [@"Packed22" dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *largeData = [@"PackedLargeDataMoreThan16Bytes" dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *extendedData = [@"Extended" dataUsingEncoding:NSUTF8StringEncoding];
+    [diskCache setData:data1 forKey:@"Packed1.png"];
+    [diskCache setData:data2 forKey:@"Packed2.png"];
+    [diskCache setExtendedData:extendedData forKey:@"Packed2.png"];
+    [diskCache setData:largeData forKey:@"PackedLarge.png"];
+    expect([diskCache containsDataForKey:@"Packed1.png"]).beTruthy();
+    expect([diskCache containsDataForKey:@"Packed3.png"]).beFalsy();
+    expect([diskCache dataForKey:@"Packed2.png"]).equal(data2);
+    expect([diskCache extendedDataForKey:@"Packed2.png"]).equal(extendedData);
+    expect([diskCache dataForKey:@"PackedLarge.png"]).equal(largeData);
+    expect(diskCache.totalCount).equal(3);
+    expect(diskCache.segmentCount).equal(1);
+    // Packed data is extracted to file when query path, large data already is
+    NSUInteger segmentSize = diskCache.totalSize;
+    NSString *packedPath = [diskCache cachePathForKey:@"Packed1.png"];
+    expect([NSData dataWithContentsOfFile:packedPath]).equal(data1);
+    expect([diskCache dataForKey:@"Packed1.png"]).equal(data1);
+    expect(diskCache.totalCount).equal(3);
+    expect(diskCache.totalSize).equal(segmentSize);
+    expect([[NSFileManager defaultManager] fileExistsAtPath:[diskCache cachePathForKey:@"PackedLarge.png"]]).beTruthy();
+    [diskCache removeDataForKey:@"Packed1.png"];
+    expect([diskCache containsDataForKey:@"Packed1.png"]).beFalsy();
+
+    // Rebuild from segments
+    SDPackedDiskCache *diskCache2 = [[SDPackedDiskCache alloc] initWithCachePath:cachePath config:config];
+    expect(diskCache2.totalCount).equal(2);
+    expect([diskCache2 containsDataForKey:@"Packed1.png"]).beFalsy();
+    expect([diskCache2 dataForKey:@"Packed2.png"]).equal(data2);
+    expect([diskCache2 extendedDataForKey:@"Packed2.png"]).equal(extendedData);
+
+    // Overwrite into new segments, then compact the old one
+    diskCache2.maxSegmentSize = 1;
+    for (NSUInteger i = 0; i < 3; i++) {
+        [diskCache2 setData:data1 forKey:@"Packed2.png"];
+    }
+    [diskCache2 compact];
+    expect(diskCache2.segmentCount).beLessThanOrEqualTo(2);
+    expect([diskCache2 dataForKey:@"Packed2.png"]).equal(data1);
+    expect([diskCache2 extendedDataForKey:@"Packed2.png"]).beNil();
+
+    // Packed data and large files share the size limit
+    config.maxDiskSize = largeData.length + 2;
+    [diskCache2 removeExpiredData];
+    expect(diskCache2.totalCount).equal(1);
+    expect([diskCache2 dataForKey:@"PackedLarge.png"]).equal(largeData);
+    config.maxDiskSize = 0;
+
+    // Expire
+    config.maxDiskAge = 0;
+    [diskCache2 removeExpiredData];
+    expect(diskCache2.totalCount).equal(0);
+    [diskCache2 removeAllData];
+}
+
+- (void)test45PackedDiskCachePerformance {
+    NSString *cachePath = [[self userCacheDirectory] stringByAppendingPathComponent:@"diskPackedPerformance"];
+    SDImageCacheConfig *config = [[SDImageCacheConfig alloc] init];
+    NSArray<id<SDDiskCache>> *diskCaches = @[
+        [[SDDiskCache alloc] initWithCachePath:[cachePath stringByAppendingPathComponent:@"file"] config:config],
+        [[SDPackedDiskCache alloc] initWithCachePath:[cachePath stringByAppendingPathComponent:@"packed"] config:config]
+    ];
+    // 1000 small images write then read
+    void *bytes = calloc(4096, 1);
+    NSData *data = [NSData dataWithBytes:bytes length:4096];
+    free(bytes);
+    NSMutableDictionary<NSString *, NSNumber *> *durations = [NSMutableDictionary dictionary];
+    for (id<SDDiskCache> diskCache in diskCaches) {
+        [diskCache removeAllData];
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        for (NSUInteger i = 0; i < 1000; i++) {
+            [diskCache setData:data forKey:[NSString stringWithFormat:@"Small%@", @(i)]];
+        }
+        for (NSUInteger i = 0; i < 1000; i++) {
+            expect([diskCache dataForKey:[NSString stringWithFormat:@"Small%@", @(i)]]).equal(data);
+        }
+        durations[NSStringFromClass(diskCache.class)] = @(CFAbsoluteTimeGetCurrent() - start);
+        expect(diskCache.totalCount).equal(1000);
+        if ([diskCache isKindOfClass:SDPackedDiskCache.class]) {
+            // All packed into the default 4 MB segments, no standalone file
+            SDPackedDiskCache *packedDiskCache = (SDPackedDiskCache *)diskCache;
+            expect(packedDiskCache.segmentCount).beLessThanOrEqualTo((1000 * (data.length + 64)) / packedDiskCache.maxSegmentSize + 1);
+        }
+        [diskCache removeAllData];
+    }
+    NSLog(@"Small images write and read duration: %@", durations);
+    // Packing avoid the per-file open and close syscalls
+    expect(durations[NSStringFromClass(SDPackedDiskCache.class)].doubleValue).beLessThan(durations[NSStringFromClass(SDDiskCache.class)].doubleValue);
+}
+
 #if SD_UIKIT
 - (void)test46MemoryCacheWeakCache {
     SDMemoryCache *memoryCache = [[SDMemoryCache alloc] init];
@@ -654,6 +842,101 @@ static NSString *kTestImageKeyPNG = @"TestImageKey.png";
 }
 #endif
 
+- (void)test46ShardedMemoryCacheLRUEviction {
+    SDImageCacheConfig *config = [[SDImageCacheConfig alloc] init];
+    config.maxMemoryCost = 30;
+    // Single shard to make the whole cache a strict LRU
+    SDShardedMemoryCache *memoryCache = [[SDShardedMemoryCache alloc] initWithConfig:config shardCount:1];
+    expect(memoryCache.shardCount).equal(1);
+    NSObject *object1 = [NSObject new];
+    NSObject *object2 = [NSObject new];
+    NSObject *object3 = [NSObject new];
+    [memoryCache setObject:object1 forKey:@"1" cost:10];
+    [memoryCache setObject:object2 forKey:@"2" cost:10];
+    [memoryCache setObject:object3 forKey:@"3" cost:10];
+    expect(memoryCache.totalCost).equal(30);
+    expect(memoryCache.totalCount).equal(3);
+    // Touch 1, so 2 is the least recently used
+    expect([memoryCache objectForKey:@"1"]).equal(object1);
+    [memoryCache setObject:[NSObject new] forKey:@"4" cost:10];
+    expect([memoryCache objectForKey:@"2"]).beNil();
+    expect([memoryCache objectForKey:@"1"]).equal(object1);
+    expect([memoryCache objectForKey:@"3"]).equal(object3);
+    expect(memoryCache.totalCost).equal(30);
+    // Large cost evict more
+    [memoryCache setObject:[NSObject new] forKey:@"5" cost:25];
+    expect(memoryCache.totalCount).equal(1);
+    // Limit change take effect
+    config.maxMemoryCost = 0;
+    config.maxMemoryCount = 2;
+    [memoryCache setObject:object1 forKey:@"1" cost:10];
+    [memoryCache setObject:object2 forKey:@"2" cost:10];
+    expect(memoryCache.totalCount).equal(2);
+    [memoryCache removeObjectForKey:@"1"];
+    expect([memoryCache objectForKey:@"1"]).beNil();
+    [memoryCache removeAllObjects];
+    expect(memoryCache.totalCost).equal(0);
+    expect(memoryCache.totalCount).equal(0);
+}
+
+- (void)test46ShardedMemoryCacheGlobalLimit {
+    SDImageCacheConfig *config = [[SDImageCacheConfig alloc] init];
+    config.maxMemoryCost = 100;
+    config.maxMemoryCount = 3;
+    SDShardedMemoryCache *memoryCache = [[SDShardedMemoryCache alloc] initWithConfig:config shardCount:8];
+    expect(memoryCache.shardCount).equal(8);
+    // The limit is for the whole cache, an object larger than `maxMemoryCost / shardCount` is kept
+    NSObject *largeObject = [NSObject new];
+    [memoryCache setObject:largeObject forKey:@"Large" cost:60];
+    expect([memoryCache objectForKey:@"Large"]).equal(largeObject);
+    // Count limit less than shard count, evict across segments, not only the hash collision one
+    NSMutableArray<NSObject *> *objects = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 5; i++) {
+        NSObject *object = [NSObject new];
+        [objects addObject:object];
+        [memoryCache setObject:object forKey:@(i).stringValue cost:1];
+    }
+    expect(memoryCache.totalCount).equal(3);
+    expect([memoryCache objectForKey:@"4"]).equal(objects[4]);
+    // The key is copied, mutate the original key does not affect the cache
+    NSMutableString *mutableKey = [NSMutableString stringWithString:@"Mutable"];
+    NSObject *mutableKeyObject = [NSObject new];
+    [memoryCache setObject:mutableKeyObject forKey:mutableKey cost:1];
+    [mutableKey appendString:@"Changed"];
+    expect([memoryCache objectForKey:@"Mutable"]).equal(mutableKeyObject);
+    // The object just stored is never evicted by its own insertion, even larger than the whole limit
+    NSObject *hugeObject = [NSObject new];
+    [memoryCache setObject:hugeObject forKey:@"Huge" cost:150];
+    expect([memoryCache objectForKey:@"Huge"]).equal(hugeObject);
+    expect(memoryCache.totalCount).equal(1);
+    expect(memoryCache.totalCost).equal(150);
+    // Trim to cost across segments
+    [memoryCache setObject:[NSObject new] forKey:@"Small" cost:10];
+    expect([memoryCache objectForKey:@"Huge"]).beNil();
+    expect(memoryCache.totalCost).equal(10);
+    [memoryCache trimToCost:0];
+    expect(memoryCache.totalCount).equal(0);
+}
+
+- (void)test46ShardedMemoryCacheWithImageCache {
+    SDImageCacheConfig *config = [[SDImageCacheConfig alloc] init];
+    config.memoryCacheClass = [SDShardedMemoryCache class];
+    SDImageCache *cache = [[SDImageCache alloc] initWithNamespace:@"ShardedMemoryCache" diskCacheDirectory:nil config:config];
+    SDShardedMemoryCache *memoryCache = (SDShardedMemoryCache *)cache.memoryCache;
+    expect([memoryCache isKindOfClass:[SDShardedMemoryCache class]]).beTruthy();
+    expect(memoryCache.shardCount).beGreaterThanOrEqualTo(2);
+    UIImage *image = [self testJPEGImage];
+    // Concurrent access from multiple threads
+    dispatch_apply(100, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+        NSString *key = [NSString stringWithFormat:@"ShardedKey%@", @(i)];
+        [cache storeImageToMemory:image forKey:key];
+        expect([cache imageFromMemoryCacheForKey:key]).equal(image);
+    });
+    expect(memoryCache.totalCount).equal(100);
+    [cache clearMemory];
+    expect(memoryCache.totalCount).equal(0);
+}
+
 - (void)test47DiskCacheExtendedData {
     XCTestExpectation *expectation = [self expectationWithDescription:@"SDImageCache extended data read/write works"];
     UIImage *image = [self testPNGImage];
@@ -967,8 +1250,261 @@ static NSString *kTestImageKeyPNG = @"TestImageKey.png";
     expect(cacheFiles.count).equal(0);
 }
 
+- (void)test59CacheDecodeOutsideIOQueue {
+    expect(SDImageCacheConfig.defaultCacheConfig.maxConcurrentDecodeCount).equal(NSProcessInfo.processInfo.activeProcessorCount);
+    SDImageCacheConfig *config = [[SDImageCacheConfig alloc] init];
+    config.maxConcurrentDecodeCount = 2;
+    SDImageCache *cache = [[SDImageCache alloc] initWithNamespace:@"DecodeQueue" diskCacheDirectory:nil config:config];
+    NSData *imageData = [NSData dataWithContentsOfFile:[self testJPEGPath]];
+    NSUInteger count = 10;
+    NSMutableArray<XCTestExpectation *> *expectations = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        NSString *key = [NSString stringWithFormat:@"DecodeQueue%@", @(i)];
+        [cache storeImageDataToDisk:imageData forKey:key];
+        XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"Query decode queue %@", @(i)]];
+        [expectations addObject:expectation];
+        [cache queryCacheOperationForKey:key options:0 context:nil cacheType:SDImageCacheTypeDisk done:^(UIImage * _Nullable image, NSData * _Nullable data, SDImageCacheType cacheType) {
+            expect(image).notTo.beNil();
+            expect(data).equal(imageData);
+            expect(cacheType).equal(SDImageCacheTypeDisk);
+            [expectation fulfill];
+        }];
+    }
+    expect(cache.pendingDiskReadCount + cache.pendingDecodeCount).beLessThanOrEqualTo(count);
+    [self waitForExpectations:expectations timeout:kAsyncTestTimeout];
+    expect(cache.pendingDiskReadCount).equal(0);
+    expect(cache.pendingDecodeCount).equal(0);
+    [cache clearDiskOnCompletion:nil];
+}
+
+- (void)test60DiskCacheMappedDataBenchmark {
+    NSBundle *testBundle = [NSBundle bundleForClass:[self class]];
+    NSArray<NSString *> *testPaths = @[
+        [testBundle pathForResource:@"TestImageLarge" ofType:@"jpg"],
+        [testBundle pathForResource:@"TestImage" ofType:@"heic"],
+        [testBundle pathForResource:@"TestImage" ofType:@"gif"]
+    ];
+    for (NSNumber *shouldMap in @[@NO, @YES]) {
+        SDImageCacheConfig *config = [[SDImageCacheConfig alloc] init];
+        config.shouldCacheImagesInMemory = NO;
+        config.shouldMapDiskCacheData = shouldMap.boolValue;
+        SDImageCache *cache = [[SDImageCache alloc] initWithNamespace:@"MappedData" diskCacheDirectory:nil config:config];
+        for (NSString *testPath in testPaths) {
+            NSData *imageData = [NSData dataWithContentsOfFile:testPath];
+            NSString *key = testPath.lastPathComponent;
+            [cache storeImageDataToDisk:imageData forKey:key];
+            // Same bytes, no matter mapped or not
+            expect([cache diskImageDataForKey:key]).equal(imageData);
+            
+            XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"Mapped disk hit %@", key]];
+            uint64_t footprint = [self currentMemoryFootprint];
+            CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+            [cache queryCacheOperationForKey:key options:0 context:nil cacheType:SDImageCacheTypeDisk done:^(UIImage * _Nullable image, NSData * _Nullable data, SDImageCacheType cacheType) {
+                CFAbsoluteTime duration = CFAbsoluteTimeGetCurrent() - start;
+                int64_t footprintDelta = (int64_t)[self currentMemoryFootprint] - (int64_t)footprint;
+                expect(image).notTo.beNil();
+                expect(cacheType).equal(SDImageCacheTypeDisk);
+                NSLog(@"Disk hit %@ (mapped: %@), latency: %.2fms, footprint delta: %lldKB", key, shouldMap, duration * 1000, footprintDelta / 1024);
+                [expectation fulfill];
+            }];
+            [self waitForExpectationsWithCommonTimeout];
+        }
+        [cache clearDiskOnCompletion:nil];
+    }
+}
+
+- (void)test61CacheBatchQuery {
+    SDImageCache *cache = [[SDImageCache alloc] initWithNamespace:@"BatchQuery"];
+    [cache clearMemory];
+    [cache clearDiskOnCompletion:nil];
+    NSData *imageData = [NSData dataWithContentsOfFile:[self testJPEGPath]];
+    [cache storeImageToMemory:[self testJPEGImage] forKey:@"BatchMemory"];
+    NSUInteger diskCount = 10;
+    NSMutableArray<NSString *> *keys = [NSMutableArray arrayWithObjects:@"BatchMemory", @"BatchMiss", nil];
+    for (NSUInteger i = 0; i < diskCount; i++) {
+        NSString *key = [NSString stringWithFormat:@"BatchDisk%@", @(i)];
+        [cache storeImageDataToDisk:imageData forKey:key];
+        [keys addObject:key];
+    }
+    // The extended data is read on ioQueue together with disk data
+    NSDictionary *extendedObject = @{@"Test" : @"Object"};
+    NSData *extendedData = [NSKeyedArchiver archivedDataWithRootObject:extendedObject requiringSecureCoding:NO error:nil];
+    [cache.diskCache setExtendedData:extendedData forKey:@"BatchDisk0"];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Batch query streams all keys"];
+    NSMutableSet<NSString *> *answeredKeys = [NSMutableSet set];
+    __block BOOL isSync = YES;
+    [cache queryCacheOperationForKeys:keys options:0 context:nil cacheType:SDImageCacheTypeAll done:^(NSString * _Nonnull key, UIImage * _Nullable image, NSData * _Nullable data, SDImageCacheType cacheType) {
+        expect([answeredKeys containsObject:key]).beFalsy();
+        [answeredKeys addObject:key];
+        if ([key isEqualToString:@"BatchMemory"]) {
+            // Memory hit is answered synchronously
+            expect(isSync).beTruthy();
+            expect(cacheType).equal(SDImageCacheTypeMemory);
+        } else if ([key isEqualToString:@"BatchMiss"]) {
+            // Same as the single key query
+            expect(image).beNil();
+            expect(cacheType).equal(SDImageCacheTypeDisk);
+        } else {
+            expect(image).notTo.beNil();
+            expect(data).equal(imageData);
+            expect(cacheType).equal(SDImageCacheTypeDisk);
+            if ([key isEqualToString:@"BatchDisk0"]) {
+                expect(image.sd_extendedObject).equal(extendedObject);
+            }
+        }
+        if (answeredKeys.count == keys.count) {
+            [expectation fulfill];
+        }
+    }];
+    isSync = NO;
+    [self waitForExpectationsWithCommonTimeout];
+    [cache clearDiskOnCompletion:nil];
+}
+
+- (void)test61CacheBatchQueryDecideSyncForEachKey {
+    SDImageCache *cache = [[SDImageCache alloc] initWithNamespace:@"BatchQuerySync"];
+    NSData *imageData = [NSData dataWithContentsOfFile:[self testJPEGPath]];
+    [cache storeImageToMemory:[self testJPEGImage] forKey:@"BatchSyncMemory"];
+    [cache storeImageDataToDisk:imageData forKey:@"BatchSyncMemory"];
+    [cache storeImageDataToDisk:imageData forKey:@"BatchSyncDisk"];
+    
+    // Same as the single key query, memory hit use `MemoryDataSync`, memory miss use `DiskDataSync`
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Batch query decide sync for each key"];
+    NSMutableSet<NSString *> *answeredKeys = [NSMutableSet set];
+    __block BOOL isSync = YES;
+    SDImageCacheOptions options = SDImageCacheQueryMemoryData | SDImageCacheQueryDiskDataSync;
+    [cache queryCacheOperationForKeys:@[@"BatchSyncMemory", @"BatchSyncDisk"] options:options context:nil cacheType:SDImageCacheTypeAll done:^(NSString * _Nonnull key, UIImage * _Nullable image, NSData * _Nullable data, SDImageCacheType cacheType) {
+        [answeredKeys addObject:key];
+        expect(image).notTo.beNil();
+        expect(data).notTo.beNil();
+        if ([key isEqualToString:@"BatchSyncMemory"]) {
+            expect(isSync).beFalsy();
+        } else {
+            expect(isSync).beTruthy();
+        }
+        if (answeredKeys.count == 2) {
+            [expectation fulfill];
+        }
+    }];
+    isSync = NO;
+    [self waitForExpectationsWithCommonTimeout];
+    [cache clearDiskOnCompletion:nil];
+}
+
+- (void)test61CachesManagerBatchQuery {
+    SDImageCachesManager *cachesManager = [[SDImageCachesManager alloc] init];
+    SDImageCache *cache1 = [[SDImageCache alloc] initWithNamespace:@"BatchQuery1"];
+    SDImageCache *cache2 = [[SDImageCache alloc] initWithNamespace:@"BatchQuery2"];
+    cachesManager.caches = @[cache1, cache2];
+    [cache1 storeImageToMemory:[self testJPEGImage] forKey:@"BatchCache1"];
+    [cache2 storeImageToMemory:[self testPNGImage] forKey:@"BatchCache2"];
+    NSArray<NSString *> *keys = @[@"BatchCache1", @"BatchCache2", @"BatchNone"];
+    
+    for (NSNumber *policy in @[@(SDImageCachesManagerOperationPolicySerial), @(SDImageCachesManagerOperationPolicyConcurrent)]) {
+        cachesManager.queryOperationPolicy = policy.unsignedIntegerValue;
+        XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"Batch query with policy %@", policy]];
+        NSMutableDictionary<NSString *, NSNumber *> *results = [NSMutableDictionary dictionary];
+        [cachesManager queryImagesForKeys:keys options:0 context:nil cacheType:SDImageCacheTypeAll completion:^(NSString * _Nonnull key, UIImage * _Nullable image, NSData * _Nullable data, SDImageCacheType cacheType) {
+            expect(results[key]).beNil();
+            results[key] = @(image != nil);
+            if (results.count == keys.count) {
+                expect(results[@"BatchCache1"]).equal(@YES);
+                expect(results[@"BatchCache2"]).equal(@YES);
+                expect(results[@"BatchNone"]).equal(@NO);
+                [expectation fulfill];
+            }
+        }];
+        [self waitForExpectationsWithCommonTimeout];
+    }
+    [cache1 clearMemory];
+    [cache2 clearMemory];
+}
+
+- (void)test62CacheRegionQuery {
+    SDImageCache *cache = [[SDImageCache alloc] initWithNamespace:@"RegionQuery"];
+    NSString *key = @"RegionImage";
+    NSData *imageData = [NSData dataWithContentsOfFile:[self testJPEGPath]];
+    [cache storeImageDataToDisk:imageData forKey:key];
+    
+    CGRect region = CGRectMake(10, 10, 40, 40);
+    CGSize pixelSize = CGSizeMake(20, 20);
+    UIImage *tile = [cache imageFromCacheForKey:key region:region pixelSize:pixelSize];
+    expect(tile).notTo.beNil();
+    expect(CGImageGetWidth(tile.CGImage)).equal(20);
+    expect(CGImageGetHeight(tile.CGImage)).equal(20);
+    // The tile is stored with the derived key, not the original key
+    NSString *regionKey = SDRegionedKeyForKey(key, region, pixelSize);
+    expect([cache imageFromMemoryCacheForKey:regionKey]).equal(tile);
+    expect([cache imageFromMemoryCacheForKey:key]).beNil();
+    // Second query hit the memory cache
+    expect([cache imageFromCacheForKey:key region:region pixelSize:pixelSize]).equal(tile);
+    
+    // Miss
+    expect([cache imageFromCacheForKey:@"RegionMiss" region:region pixelSize:pixelSize]).beNil();
+    
+    // Replace the disk data, the new region decode from the new data
+    [cache storeImageDataToDisk:[NSData dataWithContentsOfFile:[self testPNGPath]] forKey:key];
+    UIImage *replacedTile = [cache imageFromCacheForKey:key region:CGRectMake(0, 0, 20, 20) pixelSize:CGSizeZero];
+    expect(replacedTile.sd_imageFormat).equal(SDImageFormatPNG);
+    // The tile decoded from the previous data is not served any more
+    UIImage *replacedSameTile = [cache imageFromCacheForKey:key region:region pixelSize:pixelSize];
+    expect(replacedSameTile).notTo.equal(tile);
+    expect(replacedSameTile.sd_imageFormat).equal(SDImageFormatPNG);
+    
+    // Remove from disk, the tiles are not served any more
+    [cache removeImageFromDiskForKey:key];
+    expect([cache imageFromCacheForKey:key region:region pixelSize:pixelSize]).beNil();
+    [cache storeImageDataToDisk:imageData forKey:key];
+    
+    // Clear disk, the region decode does not use the stale data
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Region query after clear disk"];
+    [cache clearDiskOnCompletion:^{
+        expect([cache imageFromCacheForKey:key region:CGRectMake(0, 0, 10, 10) pixelSize:CGSizeZero]).beNil();
+        [cache clearMemory];
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)test63CacheClearDiskOnlyRemoveItsImageSources {
+    SDImageSourceCache *sourceCache = SDImageSourceCache.sharedCache;
+    sourceCache.totalCostLimit = 10 * 1024 * 1024;
+    [sourceCache removeAllImageSources];
+    SDImageCache *cache1 = [[SDImageCache alloc] initWithNamespace:@"ImageSource1"];
+    SDImageCache *cache2 = [[SDImageCache alloc] initWithNamespace:@"ImageSource2"];
+    NSData *imageData = [NSData dataWithContentsOfFile:[self testJPEGPath]];
+    [cache1 storeImageDataToDisk:imageData forKey:@"ImageSource1"];
+    [cache2 storeImageDataToDisk:imageData forKey:@"ImageSource2"];
+    expect([cache1 imageFromDiskCacheForKey:@"ImageSource1"]).notTo.beNil();
+    expect([cache2 imageFromDiskCacheForKey:@"ImageSource2"]).notTo.beNil();
+    expect([sourceCache containsImageSourceForKey:@"ImageSource1"]).beTruthy();
+    expect([sourceCache containsImageSourceForKey:@"ImageSource2"]).beTruthy();
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Clear disk only remove its image sources"];
+    [cache1 clearDiskOnCompletion:^{
+        expect([sourceCache containsImageSourceForKey:@"ImageSource1"]).beFalsy();
+        expect([sourceCache containsImageSourceForKey:@"ImageSource2"]).beTruthy();
+        [cache2 clearDiskOnCompletion:^{
+            expect([sourceCache containsImageSourceForKey:@"ImageSource2"]).beFalsy();
+            sourceCache.totalCostLimit = 0;
+            [expectation fulfill];
+        }];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+}
+
 #pragma mark Helper methods
 
+- (uint64_t)currentMemoryFootprint {
+    task_vm_info_data_t info;
+    mach_msg_type_number_t count = TASK_VM_INFO_COUNT;
+    if (task_info(mach_task_self(), TASK_VM_INFO, (task_info_t)&info, &count) != KERN_SUCCESS) {
+        return 0;
+    }
+    return info.phys_footprint;
+}
+
 - (UIImage *)testJPEGImage {
     static UIImage *reusableImage = nil;
     if (!reusableImage) {
@@ -9,6 +9,7 @@
 
 #import "SDTestCase.h"
 #import "UIColor+SDHexString.h"
+#import "SDImageIOAnimatedCoderInternal.h"
 
 @interface SDWebImageDecoderTests : SDTestCase
 
@@ -118,6 +119,62 @@
     expect(testColor2.sd_hexString).equal(imageColor.sd_hexString);
 }
 
+- (void)test07ThatDecodeAndScaleDownConcurrentlyBenchmark {
+    SDImageCoderDecodeSolution decodeSolution = SDImageCoderHelper.defaultDecodeSolution;
+    NSUInteger concurrentCount = SDImageCoderHelper.defaultScaleDownConcurrentCount;
+    // Force to use the CoreGraphics tiles rendering
+    SDImageCoderHelper.defaultDecodeSolution = SDImageCoderDecodeSolutionCoreGraphics;
+    NSArray<NSString *> *testPaths = @[
+        [[NSBundle bundleForClass:[self class]] pathForResource:@"TestImageLarge" ofType:@"jpg"],
+        [[NSBundle bundleForClass:[self class]] pathForResource:@"TestImageLarge" ofType:@"png"]
+    ];
+    for (NSString *testPath in testPaths) {
+        UIImage *image = [[UIImage alloc] initWithContentsOfFile:testPath];
+        NSUInteger limitBytes = image.size.width * image.size.height; // 1/4 pixels
+        
+        SDImageCoderHelper.defaultScaleDownConcurrentCount = 1;
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        UIImage *serialImage = [SDImageCoderHelper decodedAndScaledDownImageWithImage:image limitBytes:limitBytes];
+        CFAbsoluteTime serialDuration = CFAbsoluteTimeGetCurrent() - start;
+        
+        SDImageCoderHelper.defaultScaleDownConcurrentCount = NSProcessInfo.processInfo.activeProcessorCount;
+        start = CFAbsoluteTimeGetCurrent();
+        UIImage *concurrentImage = [SDImageCoderHelper decodedAndScaledDownImageWithImage:image limitBytes:limitBytes];
+        CFAbsoluteTime concurrentDuration = CFAbsoluteTimeGetCurrent() - start;
+        
+        // Same output size
+        expect(concurrentImage.size).equal(serialImage.size);
+        expect(concurrentImage.size.width * concurrentImage.size.height).beLessThanOrEqualTo(limitBytes / 4);
+        // Same RGB as the serial output on every row, so a missing, duplicated or misplaced band is caught
+        size_t width = CGImageGetWidth(serialImage.CGImage);
+        size_t height = CGImageGetHeight(serialImage.CGImage);
+        expect(CGImageGetWidth(concurrentImage.CGImage)).equal(width);
+        expect(CGImageGetHeight(concurrentImage.CGImage)).equal(height);
+        NSData *serialPixels = [self RGBAPixelsWithImage:serialImage];
+        NSData *concurrentPixels = [self RGBAPixelsWithImage:concurrentImage];
+        expect(serialPixels).notTo.beNil();
+        expect(concurrentPixels).notTo.beNil();
+        const uint8_t *serialBytes = serialPixels.bytes;
+        const uint8_t *concurrentBytes = concurrentPixels.bytes;
+        NSUInteger mismatchCount = 0;
+        for (size_t y = 0; y < height; y++) {
+            for (size_t i = 0; i <= 8; i++) {
+                size_t x = MIN(width * i / 8, width - 1);
+                size_t offset = (y * width + x) * 4;
+                for (size_t c = 0; c < 3; c++) {
+                    if (abs((int)serialBytes[offset + c] - (int)concurrentBytes[offset + c]) > 12) {
+                        mismatchCount++;
+                    }
+                }
+            }
+        }
+        expect(mismatchCount).equal(0);
+        NSLog(@"Scale down %@ (%.0fx%.0f), serial: %.2fms, concurrent (%lu): %.2fms", testPath.lastPathComponent, image.size.width, image.size.height, serialDuration * 1000, (unsigned long)SDImageCoderHelper.defaultScaleDownConcurrentCount, concurrentDuration * 1000);
+    }
+    SDImageCoderHelper.defaultDecodeSolution = decodeSolution;
+    SDImageCoderHelper.defaultScaleDownConcurrentCount = concurrentCount;
+}
+
 - (void)test08ThatEncodeAlphaImageToJPGWithBackgroundColor {
     NSString *testImagePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"TestImage" ofType:@"png"];
     UIImage *image = [[UIImage alloc] initWithContentsOfFile:testImagePath];
@@ -454,11 +511,35 @@
     expect(data).notTo.beNil();
 
 #if SD_MAC
-    // Test implementation use SDAnimatedImageRep
+    // Test implementation use frame-backed SDAnimatedImageRep
     SDAnimatedImageRep *rep = (SDAnimatedImageRep *)animatedImage.representations.firstObject;
-    expect([rep isKindOfClass:SDAnimatedImageRep.class]);
-    expect(rep.animatedImageData).equal(data);
+    expect([rep isKindOfClass:SDAnimatedImageRep.class]).beTruthy();
+    expect([SDImageCoderHelper framesFromAnimatedImage:animatedImage]).equal(frames);
+    expect(animatedImage.sd_imageFrameCount).equal(frameCount);
+    [rep setProperty:NSImageCurrentFrame withValue:@(2)];
+    expect([[rep valueForProperty:NSImageCurrentFrame] unsignedIntegerValue]).equal(2);
+    expect([[rep valueForProperty:NSImageCurrentFrameDuration] doubleValue]).equal(0.1);
+    expect(rep.CGImage).equal(frames[2].image.CGImage);
+    // GIF is encoded only when asked, and only once
     expect(rep.animatedImageFormat).equal(SDImageFormatGIF);
+    expect([NSData sd_imageFormatForImageData:rep.animatedImageData]).equal(SDImageFormatGIF);
+    expect(rep.animatedImageData).beIdenticalTo(rep.animatedImageData);
+    // Keep the loop count of the GIF without loop count metadata
+    expect([[rep valueForProperty:NSImageLoopCount] unsignedIntegerValue]).equal(1);
+    expect([SDImageGIFCoder.sharedCoder decodedImageWithData:rep.animatedImageData options:nil].sd_imageLoopCount).equal(1);
+    
+    // AppKit render the current frame, not the poster frame
+    expect([rep CGImageForProposedRect:NULL context:nil hints:nil]).equal(frames[2].image.CGImage);
+    size_t renderWidth = 10, renderHeight = 10;
+    CGContextRef renderContext = CGBitmapContextCreate(NULL, renderWidth, renderHeight, 8, 0, [SDImageCoderHelper colorSpaceGetDeviceRGB], kCGImageAlphaPremultipliedLast | kCGBitmapByteOrder32Big);
+    [NSGraphicsContext saveGraphicsState];
+    NSGraphicsContext.currentContext = [NSGraphicsContext graphicsContextWithCGContext:renderContext flipped:NO];
+    [animatedImage drawInRect:NSMakeRect(0, 0, renderWidth, renderHeight)];
+    [NSGraphicsContext restoreGraphicsState];
+    const uint8_t *pixels = CGBitmapContextGetData(renderContext);
+    // Frame 2 is filled with red 0.5, the poster frame is red 1.0
+    expect(pixels[0]).beCloseToWithin(128, 8);
+    CGContextRelease(renderContext);
 #endif
     
     // Test new API
@@ -761,6 +842,249 @@
     }
 }
 
+- (void)test35ThatAnimatedCoderTimeToFirstFrameBenchmark {
+    NSBundle *testBundle = [NSBundle bundleForClass:[self class]];
+    NSMutableArray<NSArray *> *corpus = [NSMutableArray arrayWithArray:@[
+        @[[testBundle pathForResource:@"1@2x" ofType:@"gif"], SDImageGIFCoder.class],
+        @[[testBundle pathForResource:@"TestImageAnimated" ofType:@"apng"], SDImageAPNGCoder.class],
+    ]];
+    NSData *webpData = [NSData dataWithContentsOfFile:[testBundle pathForResource:@"TestAnimatedImageMemory" ofType:@"webp"]];
+    if ([SDImageAWebPCoder.sharedCoder canDecodeFromData:webpData]) {
+        [corpus addObject:@[[testBundle pathForResource:@"TestAnimatedImageMemory" ofType:@"webp"], SDImageAWebPCoder.class]];
+    }
+    for (NSArray *item in corpus) {
+        NSString *testPath = item[0];
+        Class coderClass = item[1];
+        NSData *data = [NSData dataWithContentsOfFile:testPath];
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        id<SDAnimatedImageCoder> coder = [[coderClass alloc] initWithAnimatedImageData:data options:nil];
+        UIImage *firstFrame = [coder animatedImageFrameAtIndex:0];
+        CFAbsoluteTime timeToFirstFrame = CFAbsoluteTimeGetCurrent() - start;
+        expect(firstFrame).notTo.beNil();
+        
+        // The lazily scanned durations match the frame table
+        NSUInteger frameCount = coder.animatedImageFrameCount;
+        expect(frameCount).beGreaterThan(1);
+        CGImageSourceRef source = CGImageSourceCreateWithData((__bridge CFDataRef)data, NULL);
+        start = CFAbsoluteTimeGetCurrent();
+        for (NSUInteger i = 0; i < frameCount; i++) {
+            NSTimeInterval duration = [coderClass frameDurationAtIndex:i source:source];
+            expect([coder animatedImageDurationAtIndex:i]).equal(duration);
+        }
+        CFAbsoluteTime fullScanDuration = CFAbsoluteTimeGetCurrent() - start;
+        CFRelease(source);
+        NSLog(@"Time to first frame %@ (%lu frames): %.2fms, full frame table scan: %.2fms", testPath.lastPathComponent, (unsigned long)frameCount, timeToFirstFrame * 1000, fullScanDuration * 1000);
+    }
+}
+
+- (void)test36ThatAnimatedImageWithMismatchedDelaysBenchmark {
+#if SD_UIKIT
+    // GIF which mix 10ms and 1000ms delays, the GCD is 10ms
+    NSMutableArray<SDImageFrame *> *frames = [NSMutableArray array];
+    NSUInteger frameCount = 50;
+    CGSize size = CGSizeMake(10, 10);
+    for (size_t i = 0; i < frameCount; i++) {
+        SDGraphicsImageRenderer *renderer = [[SDGraphicsImageRenderer alloc] initWithSize:size];
+        UIImage *image = [renderer imageWithActions:^(CGContextRef  _Nonnull context) {
+            CGContextSetRGBFillColor(context, (CGFloat)i / frameCount, 0.0, 0.0, 1.0);
+            CGContextFillRect(context, CGRectMake(0, 0, size.width, size.height));
+        }];
+        [frames addObject:[SDImageFrame frameWithImage:image duration:i % 2 == 0 ? 0.01 : 1]];
+    }
+    NSUInteger expandedCount = frameCount / 2 + frameCount / 2 * 100;
+    
+    // Each frame is stored once, and the repeated images is built only when UIKit ask for it
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    UIImage *animatedImage = [SDImageCoderHelper animatedImageWithFrames:frames];
+    expect(animatedImage.sd_imageFrameCount).equal(frameCount);
+    NSUInteger memoryCost = animatedImage.sd_memoryCost;
+    NSArray<SDImageFrame *> *decodedFrames = [SDImageCoderHelper framesFromAnimatedImage:animatedImage];
+    CFAbsoluteTime deduplicatedDuration = CFAbsoluteTimeGetCurrent() - start;
+    expect(animatedImage.sd_isAnimated).beTruthy();
+    expect(decodedFrames.count).equal(frameCount);
+    expect(decodedFrames[1].duration).equal(1);
+    CGImageRef imageRef = animatedImage.CGImage;
+    expect(memoryCost).equal(CGImageGetBytesPerRow(imageRef) * CGImageGetHeight(imageRef) * frameCount);
+    expect(animatedImage.duration).beCloseToWithin(frameCount / 2 * 1.01, 0.001);
+    expect(animatedImage.images.count).equal(expandedCount);
+    
+    // Compare to the repeated frames array
+    start = CFAbsoluteTimeGetCurrent();
+    UIImage *repeatedImage = [UIImage animatedImageWithImages:animatedImage.images duration:animatedImage.duration];
+    expect(repeatedImage.sd_imageFrameCount).equal(frameCount);
+    expect(repeatedImage.sd_memoryCost).equal(memoryCost);
+    expect([SDImageCoderHelper framesFromAnimatedImage:repeatedImage].count).equal(frameCount);
+    CFAbsoluteTime repeatedDuration = CFAbsoluteTimeGetCurrent() - start;
+    NSLog(@"Animated image with mismatched delays (%lu frames, %lu repeated), deduplicated: %.2fms, repeated: %.2fms", (unsigned long)frameCount, (unsigned long)expandedCount, deduplicatedDuration * 1000, repeatedDuration * 1000);
+#endif
+}
+
+- (void)test37ThatRegionDecodeWorks {
+    NSString *testImagePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"TestImageLarge" ofType:@"jpg"];
+    NSData *testImageData = [NSData dataWithContentsOfFile:testImagePath];
+    SDImageIOCoder *coder = [[SDImageIOCoder alloc] init];
+    
+    // Full level of detail
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    UIImage *tile = [coder decodedImageWithData:testImageData region:CGRectMake(1000, 2000, 256, 256) pixelSize:CGSizeZero options:nil];
+    CFAbsoluteTime tileDuration = CFAbsoluteTimeGetCurrent() - start;
+    expect(tile).notTo.beNil();
+    expect(tile.sd_isDecoded).beTruthy();
+    expect(tile.sd_imageFormat).equal(SDImageFormatJPEG);
+    expect(CGImageGetWidth(tile.CGImage)).equal(256);
+    expect(CGImageGetHeight(tile.CGImage)).equal(256);
+    
+    // Zoom out, the whole image into one tile, the region is clipped to image bounds
+    start = CFAbsoluteTimeGetCurrent();
+    UIImage *zoomedTile = [coder decodedImageWithData:testImageData region:CGRectMake(0, 0, 4000, 6000) pixelSize:CGSizeMake(345, 525) options:nil];
+    CFAbsoluteTime zoomedTileDuration = CFAbsoluteTimeGetCurrent() - start;
+    expect(CGImageGetWidth(zoomedTile.CGImage)).equal(345);
+    expect(CGImageGetHeight(zoomedTile.CGImage)).equal(525);
+    
+    // The tiles in the same zoomed out level share one subsampled level image
+    start = CFAbsoluteTimeGetCurrent();
+    for (NSUInteger i = 0; i < 4; i++) {
+        UIImage *levelTile = [coder decodedImageWithData:testImageData region:CGRectMake(i * 1000, 0, 1000, 1000) pixelSize:CGSizeMake(250, 250) options:nil];
+        expect(CGImageGetWidth(levelTile.CGImage)).equal(250);
+        expect(CGImageGetHeight(levelTile.CGImage)).equal(250);
+    }
+    CFAbsoluteTime levelTilesDuration = CFAbsoluteTimeGetCurrent() - start;
+    NSLog(@"Region decode, 4 tiles in the same level: %.2fms", levelTilesDuration * 1000);
+    
+    // Out of bounds
+    expect([coder decodedImageWithData:testImageData region:CGRectMake(4000, 6000, 100, 100) pixelSize:CGSizeZero options:nil]).beNil();
+    
+    // Coders manager pick the region coder
+    UIImage *managerTile = [SDImageCodersManager.sharedManager decodedImageWithData:testImageData region:CGRectMake(0, 0, 512, 512) pixelSize:CGSizeMake(128, 128) options:@{SDImageCoderDecodeScaleFactor : @(2)}];
+    expect(managerTile.scale).equal(2);
+    expect(managerTile.size).equal(CGSizeMake(64, 64));
+    
+    // Compare to full decode
+    start = CFAbsoluteTimeGetCurrent();
+    UIImage *fullImage = [coder decodedImageWithData:testImageData options:nil];
+    [SDImageCoderHelper decodedImageWithImage:fullImage];
+    CFAbsoluteTime fullDuration = CFAbsoluteTimeGetCurrent() - start;
+    NSLog(@"Region decode, tile: %.2fms, zoomed out tile: %.2fms, full image: %.2fms", tileDuration * 1000, zoomedTileDuration * 1000, fullDuration * 1000);
+}
+
+- (void)test38ThatImageSourceCacheReuseImageSource {
+    NSString *testImagePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"TestImageLarge" ofType:@"jpg"];
+    NSData *testImageData = [NSData dataWithContentsOfFile:testImagePath];
+    NSString *testImageKey = @"TestImageLarge.jpg";
+    SDImageSourceCache *sourceCache = SDImageSourceCache.sharedCache;
+    NSArray<NSValue *> *thumbnailSizes = @[@(CGSizeMake(100, 100)), @(CGSizeMake(200, 200)), @(CGSizeMake(400, 400))];
+    
+    // Disabled by default
+    expect(sourceCache.totalCostLimit).equal(0);
+    [SDImageIOCoder.sharedCoder decodedImageWithData:testImageData options:@{SDImageCoderDecodeImageSourceCacheKey : testImageKey}];
+    expect(sourceCache.count).equal(0);
+    
+    // Photo grid ask for 3 thumbnail sizes of the same image
+    sourceCache.totalCostLimit = 10 * 1024 * 1024;
+    [sourceCache removeAllImageSources];
+    [sourceCache resetStatistics];
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    for (NSValue *thumbnailSize in thumbnailSizes) {
+        // Different data instance with the same content, like reading from disk each time
+        NSData *data = [testImageData mutableCopy];
+        UIImage *thumbnail = [SDImageIOCoder.sharedCoder decodedImageWithData:data options:@{SDImageCoderDecodeThumbnailPixelSize : thumbnailSize, SDImageCoderDecodeImageSourceCacheKey : testImageKey}];
+        expect(thumbnail).notTo.beNil();
+    }
+    CFAbsoluteTime cachedDuration = CFAbsoluteTimeGetCurrent() - start;
+    expect(sourceCache.missCount).equal(1);
+    expect(sourceCache.hitCount).equal(2);
+    expect(sourceCache.hitRate).beCloseToWithin(2.0 / 3, 0.001);
+    expect(sourceCache.count).equal(1);
+    expect(sourceCache.totalCost).equal(testImageData.length);
+    
+    // Without key, does not touch the cache
+    [SDImageIOCoder.sharedCoder decodedImageWithData:testImageData options:nil];
+    expect(sourceCache.missCount).equal(1);
+    expect(sourceCache.count).equal(1);
+    
+    // Metadata query of animated coder hit the cache as well
+    NSData *gifData = [NSData dataWithContentsOfFile:[[NSBundle bundleForClass:[self class]] pathForResource:@"TestImage" ofType:@"gif"]];
+    NSString *gifKey = @"TestImage.gif";
+    [SDImageGIFCoder.sharedCoder decodedImageWithData:gifData options:@{SDImageCoderDecodeFirstFrameOnly : @(YES), SDImageCoderDecodeImageSourceCacheKey : gifKey}];
+    SDImageGIFCoder *animatedCoder = [[SDImageGIFCoder alloc] initWithAnimatedImageData:gifData options:@{SDImageCoderDecodeImageSourceCacheKey : gifKey}];
+    expect(animatedCoder.animatedImageFrameCount).equal(5);
+    expect([animatedCoder animatedImageFrameAtIndex:1]).notTo.beNil();
+    expect(sourceCache.hitCount).equal(3);
+    
+    // The replaced image for the same key is not matched
+    [SDImageIOCoder.sharedCoder decodedImageWithData:gifData options:@{SDImageCoderDecodeImageSourceCacheKey : testImageKey}];
+    expect(sourceCache.missCount).equal(3);
+    expect(sourceCache.totalCost).equal(gifData.length * 2);
+    
+    // The refreshed image with the same length is not matched as well
+    NSMutableData *refreshedData = [gifData mutableCopy];
+    ((uint8_t *)refreshedData.mutableBytes)[refreshedData.length - 2] ^= 0xFF;
+    [SDImageIOCoder.sharedCoder decodedImageWithData:refreshedData options:@{SDImageCoderDecodeImageSourceCacheKey : testImageKey}];
+    expect(sourceCache.missCount).equal(4);
+    expect(sourceCache.totalCost).equal(gifData.length * 2);
+    
+    // Evict the least recently used by bytes
+    sourceCache.totalCostLimit = gifData.length;
+    expect(sourceCache.count).equal(1);
+    [sourceCache removeImageSourceForKey:testImageKey];
+    expect(sourceCache.count).equal(0);
+    expect(sourceCache.totalCost).equal(0);
+    
+    // Compare to parse each time
+    sourceCache.totalCostLimit = 0;
+    start = CFAbsoluteTimeGetCurrent();
+    for (NSValue *thumbnailSize in thumbnailSizes) {
+        [SDImageIOCoder.sharedCoder decodedImageWithData:testImageData options:@{SDImageCoderDecodeThumbnailPixelSize : thumbnailSize, SDImageCoderDecodeImageSourceCacheKey : testImageKey}];
+    }
+    CFAbsoluteTime uncachedDuration = CFAbsoluteTimeGetCurrent() - start;
+    expect(sourceCache.count).equal(0);
+    NSLog(@"Image source cache, 3 thumbnail sizes, cached: %.2fms, uncached: %.2fms, hit rate: %.2f", cachedDuration * 1000, uncachedDuration * 1000, sourceCache.hitRate);
+    [sourceCache resetStatistics];
+}
+
+- (void)test39ThatAnimatedImageWithFramesKeepAnimationInUIKit {
+#if SD_UIKIT
+    NSMutableArray<SDImageFrame *> *frames = [NSMutableArray array];
+    CGSize size = CGSizeMake(10, 10);
+    for (size_t i = 0; i < 3; i++) {
+        SDGraphicsImageRenderer *renderer = [[SDGraphicsImageRenderer alloc] initWithSize:size];
+        UIImage *image = [renderer imageWithActions:^(CGContextRef  _Nonnull context) {
+            CGContextSetRGBFillColor(context, (CGFloat)i / 3, 0.0, 0.0, 1.0);
+            CGContextFillRect(context, CGRectMake(0, 0, size.width, size.height));
+        }];
+        [frames addObject:[SDImageFrame frameWithImage:image duration:i == 0 ? 0.2 : 0.1]];
+    }
+    UIImage *animatedImage = [SDImageCoderHelper animatedImageWithFrames:frames];
+    expect(animatedImage.images.count).equal(4);
+    
+    // UIImageView animate it
+    UIImageView *imageView = [[UIImageView alloc] initWithFrame:CGRectMake(0, 0, 10, 10)];
+    [self.window addSubview:imageView];
+    imageView.image = animatedImage;
+    [imageView startAnimating];
+    expect(imageView.isAnimating).beTruthy();
+    [imageView stopAnimating];
+    [imageView removeFromSuperview];
+    
+    // UIKit transforms keep the animation
+    void (^checkAnimated)(UIImage *) = ^(UIImage *image) {
+        expect(image.images.count).equal(4);
+        expect(image.duration).beCloseToWithin(0.4, 0.001);
+        expect(image.sd_isAnimated).beTruthy();
+    };
+    checkAnimated([animatedImage imageWithRenderingMode:UIImageRenderingModeAlwaysTemplate]);
+    UIImage *resizableImage = [animatedImage resizableImageWithCapInsets:UIEdgeInsetsMake(1, 1, 1, 1)];
+    checkAnimated(resizableImage);
+    expect(resizableImage.capInsets).equal(UIEdgeInsetsMake(1, 1, 1, 1));
+    checkAnimated([animatedImage resizableImageWithCapInsets:UIEdgeInsetsMake(1, 1, 1, 1) resizingMode:UIImageResizingModeStretch]);
+    checkAnimated([animatedImage imageWithAlignmentRectInsets:UIEdgeInsetsMake(1, 1, 1, 1)]);
+    if (@available(iOS 13, tvOS 13, *)) {
+        checkAnimated([animatedImage imageWithTintColor:UIColor.blueColor]);
+        checkAnimated([animatedImage imageWithTintColor:UIColor.blueColor renderingMode:UIImageRenderingModeAlwaysOriginal]);
+    }
+#endif
+}
+
 #pragma mark - Utils
 
 - (void)verifyCoder:(id<SDImageCoder>)coder
@@ -904,6 +1228,26 @@ withLocalImageURL:(NSURL *)imageUrl
 }
 
 #pragma mark - Utils
+// Draw the image into RGBA8888 bitmap at its pixel size, row by row without padding
+- (NSData *)RGBAPixelsWithImage:(UIImage *)image {
+    CGImageRef imageRef = image.CGImage;
+    if (!imageRef) {
+        return nil;
+    }
+    size_t width = CGImageGetWidth(imageRef);
+    size_t height = CGImageGetHeight(imageRef);
+    NSMutableData *pixels = [NSMutableData dataWithLength:width * height * 4];
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGContextRef context = CGBitmapContextCreate(pixels.mutableBytes, width, height, 8, width * 4, colorSpace, kCGImageAlphaPremultipliedLast | kCGBitmapByteOrder32Big);
+    CGColorSpaceRelease(colorSpace);
+    if (!context) {
+        return nil;
+    }
+    CGContextDrawImage(context, CGRectMake(0, 0, width, height), imageRef);
+    CGContextRelease(context);
+    return pixels;
+}
+
 - (CGRect)boxRectFromPDFData:(nonnull NSData *)data {
     CGDataProviderRef provider = CGDataProviderCreateWithCFData((__bridge CFDataRef)data);
     if (!provider) {
@@ -431,6 +431,98 @@ static void SDAssertCGImageFirstComponentWhite(CGImageRef image, OSType pixelTyp
 
 #pragma mark - Coder Helper
 
+- (void)test11PipelineTransformerFusedRenderingMatchUnfused {
+    [self test11PipelineTransformerFusedRenderingMatchUnfusedWithBlendMode:kCGBlendModeSourceIn];
+    [self test11PipelineTransformerFusedRenderingMatchUnfusedWithBlendMode:kCGBlendModeMultiply];
+}
+
+- (void)test11PipelineTransformerFusedRenderingMatchUnfusedWithBlendMode:(CGBlendMode)blendMode {
+#if SD_UIKIT
+    SDRectCorner corners = UIRectCornerAllCorners;
+#else
+    SDRectCorner corners = SDRectCornerAllCorners;
+#endif
+    NSArray<id<SDImageTransformer>> *transformers = @[
+        [SDImageCroppingTransformer transformerWithRect:CGRectMake(20, 20, 200, 200)],
+        [SDImageResizingTransformer transformerWithSize:CGSizeMake(100, 80) scaleMode:SDImageScaleModeAspectFill],
+        [SDImageRotationTransformer transformerWithAngle:M_PI_2 fitSize:YES],
+        [SDImageFlippingTransformer transformerWithHorizontal:YES vertical:NO],
+        [SDImageRoundCornerTransformer transformerWithRadius:20 corners:corners borderWidth:2 borderColor:UIColor.redColor],
+        [SDImageTintTransformer transformerWithColor:[UIColor colorWithRed:0 green:0 blue:1 alpha:0.5] blendMode:blendMode]
+    ];
+    SDImagePipelineTransformer *pipelineTransformer = [SDImagePipelineTransformer transformerWithTransformers:transformers];
+    // The cache key does not change
+    expect(pipelineTransformer.transformerKey).equal([[transformers valueForKey:@"transformerKey"] componentsJoinedByString:@"-"]);
+    
+    UIImage *fusedImage = [pipelineTransformer transformedImageWithImage:self.testImageCG forKey:@"Test"];
+    UIImage *unfusedImage = [self unfusedImageWithImage:self.testImageCG transformers:transformers];
+    expect(fusedImage).notTo.beNil();
+    expect(fusedImage.size).equal(unfusedImage.size);
+    expect(fusedImage.scale).equal(unfusedImage.scale);
+    // Compare the pixels with tolerance for resampling difference, skip the anti-aliasing edges
+    NSArray<NSValue *> *points = @[@(CGPointMake(2, 2)), @(CGPointMake(40, 50)), @(CGPointMake(20, 30)), @(CGPointMake(60, 70)), @(CGPointMake(40, 1))];
+    for (NSValue *pointValue in points) {
+#if SD_MAC
+        CGPoint point = pointValue.pointValue;
+#else
+        CGPoint point = pointValue.CGPointValue;
+#endif
+        CGFloat r1 = 0, g1 = 0, b1 = 0, a1 = 0, r2 = 0, g2 = 0, b2 = 0, a2 = 0;
+        [[fusedImage sd_colorAtPoint:point] getRed:&r1 green:&g1 blue:&b1 alpha:&a1];
+        [[unfusedImage sd_colorAtPoint:point] getRed:&r2 green:&g2 blue:&b2 alpha:&a2];
+        expect(r1).beCloseToWithin(r2, 0.05);
+        expect(g1).beCloseToWithin(g2, 0.05);
+        expect(b1).beCloseToWithin(b2, 0.05);
+        expect(a1).beCloseToWithin(a2, 0.05);
+    }
+}
+
+- (void)test12PipelineTransformerFusedRenderingBenchmark {
+    // 12 MP source
+    CGSize size = CGSizeMake(4000, 3000);
+    SDGraphicsImageRendererFormat *format = [[SDGraphicsImageRendererFormat alloc] init];
+    format.scale = 1;
+    SDGraphicsImageRenderer *renderer = [[SDGraphicsImageRenderer alloc] initWithSize:size format:format];
+    UIImage *image = [renderer imageWithActions:^(CGContextRef  _Nonnull context) {
+        CGContextSetFillColorWithColor(context, UIColor.greenColor.CGColor);
+        CGContextFillRect(context, CGRectMake(0, 0, size.width, size.height));
+        CGContextSetFillColorWithColor(context, UIColor.blueColor.CGColor);
+        CGContextFillRect(context, CGRectMake(0, 0, size.width / 2, size.height / 2));
+    }];
+#if SD_UIKIT
+    SDRectCorner corners = UIRectCornerAllCorners;
+#else
+    SDRectCorner corners = SDRectCornerAllCorners;
+#endif
+    NSArray<id<SDImageTransformer>> *transformers = @[
+        [SDImageFlippingTransformer transformerWithHorizontal:YES vertical:NO],
+        [SDImageRoundCornerTransformer transformerWithRadius:200 corners:corners borderWidth:10 borderColor:UIColor.blackColor],
+        [SDImageTintTransformer transformerWithColor:[UIColor colorWithRed:1 green:0 blue:0 alpha:0.5]],
+        [SDImageResizingTransformer transformerWithSize:CGSizeMake(400, 300) scaleMode:SDImageScaleModeAspectFit]
+    ];
+    SDImagePipelineTransformer *pipelineTransformer = [SDImagePipelineTransformer transformerWithTransformers:transformers];
+    
+    // Unfused: each stage has its own bitmap, the peak is the input and output bitmap of one stage
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    UIImage *unfusedImage = image;
+    size_t unfusedPeakBytes = 0;
+    for (id<SDImageTransformer> transformer in transformers) {
+        UIImage *newImage = [transformer transformedImageWithImage:unfusedImage forKey:@"Test"];
+        unfusedPeakBytes = MAX(unfusedPeakBytes, [self bitmapBytesOfImage:unfusedImage] + [self bitmapBytesOfImage:newImage]);
+        unfusedImage = newImage;
+    }
+    CFAbsoluteTime unfusedDuration = CFAbsoluteTimeGetCurrent() - startTime;
+    
+    // Fused: no intermediate bitmap for each stage
+    startTime = CFAbsoluteTimeGetCurrent();
+    UIImage *fusedImage = [pipelineTransformer transformedImageWithImage:image forKey:@"Test"];
+    CFAbsoluteTime fusedDuration = CFAbsoluteTimeGetCurrent() - startTime;
+    
+    expect(fusedImage.size).equal(unfusedImage.size);
+    expect(fusedDuration).beLessThan(unfusedDuration);
+    NSLog(@"Pipeline transformer 12MP, unfused: %.2fms, peak bitmap %.2fMB; fused: %.2fms", unfusedDuration * 1000, unfusedPeakBytes / 1024.0 / 1024.0, fusedDuration * 1000);
+}
+
 - (void)test20CGImageCreateDecodedWithOrientation {
     // Test EXIF orientation tag, you can open this image with `Preview.app`, open inspector (Command+I) and rotate (Command+L/R) to check
     UIImage *image = [[UIImage alloc] initWithContentsOfFile:[self testPNGPathForName:@"TestEXIF"]];
@@ -697,6 +789,19 @@ static void SDAssertCGImageFirstComponentWhite(CGImageRef image, OSType pixelTyp
 
 #pragma mark - Helper
 
+- (UIImage *)unfusedImageWithImage:(UIImage *)image transformers:(NSArray<id<SDImageTransformer>> *)transformers {
+    UIImage *transformedImage = image;
+    for (id<SDImageTransformer> transformer in transformers) {
+        transformedImage = [transformer transformedImageWithImage:transformedImage forKey:@"Test"];
+    }
+    return transformedImage;
+}
+
+- (size_t)bitmapBytesOfImage:(UIImage *)image {
+    CGImageRef imageRef = image.CGImage;
+    return imageRef ? CGImageGetBytesPerRow(imageRef) * CGImageGetHeight(imageRef) : 0;
+}
+
 - (UIImage *)testImageCG {
     if (!_testImageCG) {
         _testImageCG = [[UIImage alloc] initWithContentsOfFile:[self testPNGPathForName:@"TestImage"]];
@@ -9,6 +9,7 @@
 
 #import "SDTestCase.h"
 #import "SDWeakProxy.h"
+#import "SDChunkedData.h"
 #import "SDDisplayLink.h"
 #import "SDInternalMacros.h"
 #import "SDFileAttributeHelper.h"
@@ -17,6 +18,9 @@
 @interface SDUtilsTests : SDTestCase
 
 @property (nonatomic) NSTimeInterval duration;
+@property (nonatomic) NSUInteger sharedFastCount;
+@property (nonatomic) NSUInteger sharedSlowCount;
+@property (nonatomic) NSTimeInterval sharedSlowDuration;
 
 @end
 
@@ -46,6 +50,36 @@
     expect([proxy.debugDescription isEqualToString:object.debugDescription]).beTruthy();
 }
 
+- (void)testSDChunkedData {
+    SDChunkedData *chunkedData = [[SDChunkedData alloc] init];
+    expect(chunkedData.length).equal(0);
+    expect([chunkedData data].length).equal(0);
+    NSMutableData *expectedData = [NSMutableData data];
+    for (uint8_t i = 0; i < 10; i++) {
+        uint8_t bytes[100];
+        memset(bytes, i, sizeof(bytes));
+        NSData *chunk = [NSData dataWithBytes:bytes length:sizeof(bytes)];
+        [chunkedData appendData:chunk];
+        [expectedData appendData:chunk];
+    }
+    [chunkedData appendData:[NSData data]];
+    expect(chunkedData.length).equal(1000);
+    expect(chunkedData.chunkCount).equal(10);
+    expect([chunkedData data]).equal(expectedData);
+    // Join into one chunk
+    NSData *contiguousData = [chunkedData contiguousData];
+    expect(contiguousData).equal(expectedData);
+    expect(chunkedData.chunkCount).equal(1);
+    // No new chunk, reuse the joined buffer
+    expect([chunkedData contiguousData].bytes == contiguousData.bytes).beTruthy();
+    // Append after join
+    [chunkedData appendData:[@"SD" dataUsingEncoding:NSUTF8StringEncoding]];
+    expect(chunkedData.chunkCount).equal(2);
+    expect([[[chunkedData data] subdataWithRange:NSMakeRange(1000, 2)] isEqualToData:[@"SD" dataUsingEncoding:NSUTF8StringEncoding]]).beTruthy();
+    // The previous snapshot is immutable
+    expect(contiguousData.length).equal(1000);
+}
+
 - (void)testSDDisplayLink {
     XCTestExpectation *expectation1 = [self expectationWithDescription:@"Display Link Stop"];
     XCTestExpectation *expectation2 = [self expectationWithDescription:@"Display Link Start"];
@@ -77,6 +111,40 @@
     self.duration += duration;
 }
 
+- (void)testSDSharedDisplayLinkCadence {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Shared Display Link Cadence"];
+    SDDisplayLink *fastDisplayLink = [SDDisplayLink sharedDisplayLinkWithTarget:self selector:@selector(sharedFastDisplayLinkDidRefresh:)];
+    SDDisplayLink *slowDisplayLink = [SDDisplayLink sharedDisplayLinkWithTarget:self selector:@selector(sharedSlowDisplayLinkDidRefresh:)];
+    slowDisplayLink.preferredFrameInterval = 0.1; // 10 FPS
+    [fastDisplayLink addToRunLoop:NSRunLoop.mainRunLoop forMode:NSRunLoopCommonModes];
+    [slowDisplayLink addToRunLoop:NSRunLoop.mainRunLoop forMode:NSRunLoopCommonModes];
+    [fastDisplayLink start];
+    [slowDisplayLink start];
+    expect(fastDisplayLink.isRunning).beTruthy();
+    expect(slowDisplayLink.isRunning).beTruthy();
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(1 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        // The slow one is not woken up on every refresh, but the elapsed time is still accurate
+        expect(self.sharedSlowCount).beInTheRangeOf(5, 12);
+        expect(self.sharedFastCount).beGreaterThan(self.sharedSlowCount * 2);
+        expect(self.sharedSlowDuration).beCloseToWithin(1, 0.2);
+        [slowDisplayLink stop];
+        expect(slowDisplayLink.isRunning).beFalsy();
+        expect(fastDisplayLink.isRunning).beTruthy();
+        [fastDisplayLink stop];
+        [expectation fulfill];
+    });
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)sharedFastDisplayLinkDidRefresh:(SDDisplayLink *)displayLink {
+    self.sharedFastCount++;
+}
+
+- (void)sharedSlowDisplayLinkDidRefresh:(SDDisplayLink *)displayLink {
+    self.sharedSlowCount++;
+    self.sharedSlowDuration += displayLink.duration;
+}
+
 - (void)testSDFileAttributeHelper {
     NSData *fileData = [@"File Data" dataUsingEncoding:NSUTF8StringEncoding];
     NSData *extendedData = [@"Extended Data" dataUsingEncoding:NSUTF8StringEncoding];
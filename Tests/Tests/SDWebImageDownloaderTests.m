@@ -11,6 +11,7 @@
 #import "SDWebImageTestDownloadOperation.h"
 #import "SDWebImageTestCoder.h"
 #import "SDWebImageTestLoader.h"
+#import "SDChunkedData.h"
 #import <compression.h>
 
 #define kPlaceholderTestURLTemplate @"https://placehold.co/10000x%d.png"
@@ -27,6 +28,93 @@
 @end
 
 
+/**
+ *  A local stub protocol which serve the registered data in small chunks without `Content-Length`, like a chunked transfer encoding response
+ */
+@interface SDWebImageTestChunkedURLProtocol : NSURLProtocol
+@property (class, nonatomic, strong, readonly) NSMutableDictionary<NSURL *, NSData *> *responseDatas;
+@end
+
+@implementation SDWebImageTestChunkedURLProtocol
+
++ (NSMutableDictionary<NSURL *, NSData *> *)responseDatas {
+    static NSMutableDictionary *responseDatas;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        responseDatas = [NSMutableDictionary dictionary];
+    });
+    return responseDatas;
+}
+
++ (BOOL)canInitWithRequest:(NSURLRequest *)request {
+    return [request.URL.scheme isEqualToString:@"sdchunked"];
+}
+
++ (NSURLRequest *)canonicalRequestForRequest:(NSURLRequest *)request {
+    return request;
+}
+
+- (void)startLoading {
+    NSData *data;
+    @synchronized (SDWebImageTestChunkedURLProtocol.class) {
+        data = SDWebImageTestChunkedURLProtocol.responseDatas[self.request.URL];
+    }
+    NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:self.request.URL statusCode:200 HTTPVersion:@"HTTP/1.1" headerFields:@{@"Content-Type" : @"image/png", @"Transfer-Encoding" : @"chunked"}];
+    [self.client URLProtocol:self didReceiveResponse:response cacheStoragePolicy:NSURLCacheStorageNotAllowed];
+    const NSUInteger chunkSize = 16 * 1024;
+    for (NSUInteger offset = 0; offset < data.length; offset += chunkSize) {
+        NSData *chunk = [data subdataWithRange:NSMakeRange(offset, MIN(chunkSize, data.length - offset))];
+        [self.client URLProtocol:self didLoadData:chunk];
+    }
+    [self.client URLProtocolDidFinishLoading:self];
+}
+
+- (void)stopLoading {}
+
+@end
+
+/**
+ *  A coder which decode slowly with the built-in ImageIO coder, and record the time range of each decoding
+ */
+@interface SDWebImageTestSlowCoder : NSObject <SDImageCoder>
+@property (nonatomic, strong, readonly) NSMutableArray<NSArray<NSNumber *> *> *decodeTimeRanges; // CFAbsoluteTime start and end
+@end
+
+@implementation SDWebImageTestSlowCoder
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _decodeTimeRanges = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (BOOL)canDecodeFromData:(NSData *)data {
+    return [SDImageIOCoder.sharedCoder canDecodeFromData:data];
+}
+
+- (UIImage *)decodedImageWithData:(NSData *)data options:(SDImageCoderOptions *)options {
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    [NSThread sleepForTimeInterval:0.5];
+    UIImage *image = [SDImageIOCoder.sharedCoder decodedImageWithData:data options:options];
+    CFAbsoluteTime end = CFAbsoluteTimeGetCurrent();
+    @synchronized (self.decodeTimeRanges) {
+        [self.decodeTimeRanges addObject:@[@(start), @(end)]];
+    }
+    return image;
+}
+
+- (BOOL)canEncodeToFormat:(SDImageFormat)format {
+    return NO;
+}
+
+- (NSData *)encodedDataWithImage:(UIImage *)image format:(SDImageFormat)format options:(SDImageCoderOptions *)options {
+    return nil;
+}
+
+@end
+
 @interface SDWebImageDownloaderTests : SDTestCase
 
 @property (nonatomic, strong) NSMutableArray<NSURL *> *executionOrderURLs;
@@ -856,6 +944,174 @@
     [self waitForExpectations:expectations timeout:kAsyncTestTimeout * 2];
 }
 
+- (void)test32ThatThumbnailVariantsDecodeInSharedDecodeQueue {
+    NSOperationQueue *decodeQueue = SDWebImageDownloaderOperation.decodeQueue;
+    expect(decodeQueue).equal(SDWebImageDownloaderOperation.decodeQueue);
+    expect(decodeQueue.maxConcurrentOperationCount).equal(NSProcessInfo.processInfo.activeProcessorCount);
+    
+    NSURL *url = [NSURL fileURLWithPath:[self testPNGPath]];
+    NSMutableArray<XCTestExpectation *> *expectations = [NSMutableArray array];
+    // Same size twice, which share the same decoding
+    NSArray<NSNumber *> *sizes = @[@(100), @(50), @(25), @(50)];
+    for (NSNumber *size in sizes) {
+        CGSize thumbnailSize = CGSizeMake(size.doubleValue, size.doubleValue);
+        XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"Thumbnail variant %@ callback", size]];
+        [expectations addObject:expectation];
+        [SDWebImageDownloader.sharedDownloader downloadImageWithURL:url options:0 context:@{SDWebImageContextImageThumbnailPixelSize : @(thumbnailSize)} progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, BOOL finished) {
+            expect(image).notTo.beNil();
+            CGSize pixelSize = CGSizeMake(image.size.width * image.scale, image.size.height * image.scale);
+            expect(MAX(pixelSize.width, pixelSize.height)).beLessThanOrEqualTo(size.doubleValue);
+            [expectation fulfill];
+        }];
+    }
+    
+    [self waitForExpectations:expectations timeout:kAsyncTestTimeout];
+}
+
+- (void)test33ThatThumbnailVariantIsNotDerivedFromMemoryCacheImage {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Thumbnail variant decoded from downloaded data"];
+    NSURL *url = [NSURL fileURLWithPath:[self testPNGPath]];
+    SDImageCache *imageCache = [[SDImageCache alloc] initWithNamespace:@"TestDerivedVariant"];
+    // The memory cache may hold stale pixels for the same key
+    UIImage *staleImage = [[UIImage alloc] initWithContentsOfFile:[[NSBundle bundleForClass:[self class]] pathForResource:@"TestImage" ofType:@"jpg"]];
+    [imageCache storeImageToMemory:staleImage forKey:url.absoluteString];
+    NSUInteger derivedVariantCount = SDWebImageDownloaderOperation.derivedVariantCount;
+    
+    CGSize thumbnailSize = CGSizeMake(50, 50);
+    [SDWebImageDownloader.sharedDownloader downloadImageWithURL:url options:0 context:@{SDWebImageContextImageCache : imageCache, SDWebImageContextImageThumbnailPixelSize : @(thumbnailSize)} progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, BOOL finished) {
+        expect(image).notTo.beNil();
+        expect(image.sd_imageFormat).equal(SDImageFormatPNG);
+        expect(image.sd_isThumbnail).beTruthy();
+        expect(SDWebImageDownloaderOperation.derivedVariantCount).equal(derivedVariantCount);
+        [imageCache clearMemory];
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)test34ThatChunkedResponseBenchmark {
+    // Multi-MB PNG with random pixels, which can not be compressed
+    size_t width = 1600, height = 1600;
+    NSMutableData *pixels = [NSMutableData dataWithLength:width * height * 4];
+    arc4random_buf(pixels.mutableBytes, pixels.length);
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGContextRef context = CGBitmapContextCreate(pixels.mutableBytes, width, height, 8, width * 4, colorSpace, kCGBitmapByteOrderDefault | kCGImageAlphaNoneSkipLast);
+    CGImageRef imageRef = CGBitmapContextCreateImage(context);
+    CGContextRelease(context);
+    CGColorSpaceRelease(colorSpace);
+#if SD_MAC
+    UIImage *image = [[UIImage alloc] initWithCGImage:imageRef scale:1 orientation:kCGImagePropertyOrientationUp];
+#else
+    UIImage *image = [[UIImage alloc] initWithCGImage:imageRef];
+#endif
+    CGImageRelease(imageRef);
+    NSData *imageData = [SDImageIOCoder.sharedCoder encodedDataWithImage:image format:SDImageFormatPNG options:nil];
+    expect(imageData.length).beGreaterThan(4 * 1024 * 1024);
+    
+    // Compare the receive buffer with `NSMutableData` baseline, in 16KB chunks. With progressive ticks, a contiguous snapshot is taken for every 1MB
+    const NSUInteger chunkSize = 16 * 1024;
+    NSMutableArray<NSData *> *chunks = [NSMutableArray array];
+    for (NSUInteger offset = 0; offset < imageData.length; offset += chunkSize) {
+        [chunks addObject:[imageData subdataWithRange:NSMakeRange(offset, MIN(chunkSize, imageData.length - offset))]];
+    }
+    for (NSNumber *tickChunkCount in @[@(0), @(64)]) {
+        NSUInteger tick = tickChunkCount.unsignedIntegerValue;
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        NSMutableData *mutableData = [NSMutableData data];
+        for (NSUInteger i = 0; i < chunks.count; i++) {
+            [mutableData appendData:chunks[i]];
+            if (tick > 0 && i % tick == 0) {
+                NSData *snapshot = [mutableData copy];
+                expect(snapshot.bytes).notTo.beNil();
+            }
+        }
+        NSData *mutableResult = [mutableData copy];
+        CFAbsoluteTime mutableDuration = CFAbsoluteTimeGetCurrent() - start;
+        
+        start = CFAbsoluteTimeGetCurrent();
+        SDChunkedData *chunkedData = [[SDChunkedData alloc] init];
+        for (NSUInteger i = 0; i < chunks.count; i++) {
+            [chunkedData appendData:chunks[i]];
+            if (tick > 0 && i % tick == 0) {
+                NSData *snapshot = [chunkedData contiguousData];
+                expect(snapshot.bytes).notTo.beNil();
+            }
+        }
+        NSData *chunkedResult = [chunkedData contiguousData];
+        CFAbsoluteTime chunkedDuration = CFAbsoluteTimeGetCurrent() - start;
+        expect(chunkedResult).equal(mutableResult);
+        NSLog(@"Receive buffer (%lu chunks, progressive: %@), NSMutableData: %.2fms, SDChunkedData: %.2fms", (unsigned long)chunks.count, tick > 0 ? @"YES" : @"NO", mutableDuration * 1000, chunkedDuration * 1000);
+    }
+    
+    SDWebImageDownloaderConfig *config = [[SDWebImageDownloaderConfig alloc] init];
+    NSURLSessionConfiguration *sessionConfiguration = [NSURLSessionConfiguration ephemeralSessionConfiguration];
+    sessionConfiguration.protocolClasses = @[SDWebImageTestChunkedURLProtocol.class];
+    config.sessionConfiguration = sessionConfiguration;
+    SDWebImageDownloader *downloader = [[SDWebImageDownloader alloc] initWithConfig:config];
+    
+    NSUInteger count = 5;
+    NSMutableArray<XCTestExpectation *> *expectations = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"sdchunked://benchmark/%lu.png", (unsigned long)i]];
+        @synchronized (SDWebImageTestChunkedURLProtocol.class) {
+            SDWebImageTestChunkedURLProtocol.responseDatas[url] = imageData;
+        }
+        XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"Chunked response %lu", (unsigned long)i]];
+        [expectations addObject:expectation];
+        CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+        [downloader downloadImageWithURL:url options:SDWebImageDownloaderProgressiveLoad context:nil progress:^(NSInteger receivedSize, NSInteger expectedSize, NSURL * _Nullable targetURL) {
+            // Unknown size from chunked response
+            expect(expectedSize).beLessThanOrEqualTo(0);
+        } completed:^(UIImage * _Nullable downloadedImage, NSData * _Nullable data, NSError * _Nullable error, BOOL finished) {
+            if (!finished) {
+                return;
+            }
+            expect(error).beNil();
+            expect(data).equal(imageData);
+            expect(downloadedImage.size).equal(CGSizeMake(width, height));
+            NSLog(@"Chunked response %lu (%.2fMB), download and decode duration: %.2fms", (unsigned long)i, imageData.length / 1024.0 / 1024.0, (CFAbsoluteTimeGetCurrent() - startTime) * 1000);
+            [expectation fulfill];
+        }];
+    }
+    
+    [self waitForExpectations:expectations timeout:kAsyncTestTimeout * 2];
+    [downloader invalidateSessionAndCancel:YES];
+    @synchronized (SDWebImageTestChunkedURLProtocol.class) {
+        [SDWebImageTestChunkedURLProtocol.responseDatas removeAllObjects];
+    }
+}
+
+- (void)test35ThatImageVariantsDecodeConcurrently {
+    if (NSProcessInfo.processInfo.activeProcessorCount < 2) {
+        return;
+    }
+    NSURL *url = [NSURL fileURLWithPath:[self testPNGPath]];
+    SDWebImageTestSlowCoder *coder = [[SDWebImageTestSlowCoder alloc] init];
+    NSMutableArray<XCTestExpectation *> *expectations = [NSMutableArray array];
+    // The full image and the thumbnail both decode from data, they do not wait for each other
+    NSArray<SDWebImageContext *> *contexts = @[
+        @{SDWebImageContextImageCoder : coder},
+        @{SDWebImageContextImageCoder : coder, SDWebImageContextImageThumbnailPixelSize : @(CGSizeMake(50, 50))}
+    ];
+    for (SDWebImageContext *context in contexts) {
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Image variant callback"];
+        [expectations addObject:expectation];
+        [SDWebImageDownloader.sharedDownloader downloadImageWithURL:url options:0 context:context progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, BOOL finished) {
+            expect(image).notTo.beNil();
+            [expectation fulfill];
+        }];
+    }
+    [self waitForExpectations:expectations timeout:kAsyncTestTimeout];
+    
+    expect(coder.decodeTimeRanges.count).equal(2);
+    NSArray<NSNumber *> *range1 = coder.decodeTimeRanges[0];
+    NSArray<NSNumber *> *range2 = coder.decodeTimeRanges[1];
+    // Overlapped, each one start before the other end
+    expect(range1[0].doubleValue).beLessThan(range2[1].doubleValue);
+    expect(range2[0].doubleValue).beLessThan(range1[1].doubleValue);
+}
+
 #pragma mark - SDWebImageLoader
 - (void)testCustomImageLoaderWorks {
     XCTestExpectation *expectation = [self expectationWithDescription:@"Custom image not works"];
@@ -663,6 +663,49 @@
     [self waitForExpectationsWithCommonTimeout];
 }
 
+- (void)test23ThatTransformQueueDropsCancelledTransform {
+    NSURL *url = [NSURL fileURLWithPath:[self testJPEGPath]];
+    SDWebImageTestTransformer *transformer = [[SDWebImageTestTransformer alloc] init];
+    transformer.testImage = [[UIImage alloc] initWithContentsOfFile:[self testJPEGPath]];
+    transformer.transformDelay = 0.5;
+    SDImageCache *cache = [[SDImageCache alloc] initWithNamespace:@"TransformQueue"];
+    SDWebImageManager *manager = [[SDWebImageManager alloc] initWithCache:cache loader:SDWebImageDownloader.sharedDownloader];
+    expect(manager.maxConcurrentTransformCount).equal(NSProcessInfo.processInfo.activeProcessorCount);
+    manager.maxConcurrentTransformCount = 1;
+    
+    // The first one occupy the only transform slot
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Transform finished"];
+    __block SDWebImageCombinedOperation *runningOperation;
+    runningOperation = [manager loadImageWithURL:url options:SDWebImageFromLoaderOnly | SDWebImageHighPriority context:@{SDWebImageContextImageTransformer : transformer, SDWebImageContextStoreCacheType : @(SDImageCacheTypeNone)} progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, SDImageCacheType cacheType, BOOL finished, NSURL * _Nullable imageURL) {
+        expect(image).equal(transformer.testImage);
+        expect(runningOperation.transformDuration).beGreaterThanOrEqualTo(transformer.transformDelay);
+        expect(runningOperation.transformQueueDuration).beGreaterThanOrEqualTo(0);
+        [expectation fulfill];
+    }];
+    
+    // The others are cancelled while waiting, and should not be transformed
+    NSMutableArray<XCTestExpectation *> *expectations = [NSMutableArray arrayWithObject:expectation];
+    NSMutableArray<SDWebImageCombinedOperation *> *operations = [NSMutableArray array];
+    for (int i = 0; i < 5; i++) {
+        XCTestExpectation *cancelExpectation = [self expectationWithDescription:[NSString stringWithFormat:@"Transform %d cancelled", i]];
+        [expectations addObject:cancelExpectation];
+        SDWebImageCombinedOperation *operation = [manager loadImageWithURL:url options:SDWebImageFromLoaderOnly | SDWebImageLowPriority context:@{SDWebImageContextImageTransformer : transformer, SDWebImageContextStoreCacheType : @(SDImageCacheTypeNone)} progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, SDImageCacheType cacheType, BOOL finished, NSURL * _Nullable imageURL) {
+            expect(image).beNil();
+            expect(error.code).equal(SDWebImageErrorCancelled);
+            [cancelExpectation fulfill];
+        }];
+        [operations addObject:operation];
+    }
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.2 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        for (SDWebImageCombinedOperation *operation in operations) {
+            [operation cancel];
+        }
+    });
+    
+    [self waitForExpectations:expectations timeout:kAsyncTestTimeout];
+    expect(transformer.transformCount).equal(1);
+}
+
 - (NSString *)testJPEGPath {
     NSBundle *testBundle = [NSBundle bundleForClass:[self class]];
     return [testBundle pathForResource:@"TestImage" ofType:@"jpg"];
@@ -21,6 +21,8 @@
 @property (atomic, assign) NSUInteger finishedCount;
 @property (atomic, assign) NSUInteger skippedCount;
 @property (atomic, assign) NSUInteger totalCount;
+@property (atomic, strong) NSMutableArray<NSURL *> *workingSetURLs;
+@property (atomic, strong) XCTestExpectation *workingSetExpectation;
 
 @end
 
@@ -176,6 +178,44 @@
     [self waitForExpectationsWithCommonTimeout];
 }
 
+- (void)test08WorkingSetPrefetchInScoreOrderAndCountWaste {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Working set prefetch in score order"];
+    expectation.expectedFulfillmentCount = 3;
+    NSBundle *bundle = [NSBundle bundleForClass:[self class]];
+    NSURL *urlA = [bundle URLForResource:@"TestImage" withExtension:@"jpg"];
+    NSURL *urlB = [bundle URLForResource:@"TestImage" withExtension:@"png"];
+    NSURL *urlC = [bundle URLForResource:@"TestImage" withExtension:@"gif"];
+    
+    self.prefetcher = [SDWebImagePrefetcher new];
+    self.prefetcher.delegate = self;
+    self.prefetcher.maxConcurrentPrefetchCount = 1;
+    self.workingSetURLs = [NSMutableArray array];
+    self.workingSetExpectation = expectation;
+    // Lower score first, only one at a time
+    [self.prefetcher updateWorkingSetWithScores:@{urlA : @3, urlB : @1, urlC : @2} options:SDWebImageFromLoaderOnly context:@{SDWebImageContextStoreCacheType : @(SDImageCacheTypeNone)}];
+    
+    [self waitForExpectationsWithCommonTimeout];
+    expect(self.workingSetURLs).equal(@[urlB, urlC, urlA]);
+    
+    // B becomes visible (used), A leaves without being visible (wasted)
+    [self.prefetcher updateWorkingSetWithScores:@{urlB : @0, urlC : @5} options:SDWebImageFromLoaderOnly context:nil];
+    expect(self.prefetcher.usedPrefetchCount).equal(1);
+    expect(self.prefetcher.wastedPrefetchCount).equal(1);
+    expect(self.prefetcher.cancelledPrefetchCount).equal(0);
+    
+    // C leaves without being visible (wasted)
+    [self.prefetcher cancelPrefetching];
+    expect(self.prefetcher.usedPrefetchCount).equal(1);
+    expect(self.prefetcher.wastedPrefetchCount).equal(2);
+}
+
+- (void)imagePrefetcher:(SDWebImagePrefetcher *)imagePrefetcher didPrefetchWorkingSetURL:(NSURL *)imageURL error:(NSError *)error {
+    expect(imagePrefetcher).to.equal(self.prefetcher);
+    expect(error).beNil();
+    [self.workingSetURLs addObject:imageURL];
+    [self.workingSetExpectation fulfill];
+}
+
 - (void)imagePrefetcher:(SDWebImagePrefetcher *)imagePrefetcher didFinishWithTotalCount:(NSUInteger)totalCount skippedCount:(NSUInteger)skippedCount {
     expect(imagePrefetcher).to.equal(self.prefetcher);
     self.skippedCount = skippedCount;
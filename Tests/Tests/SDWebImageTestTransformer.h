@@ -12,5 +12,7 @@
 @interface SDWebImageTestTransformer : SDImageBaseTransformer
 
 @property (nonatomic, strong, nullable) UIImage *testImage;
+@property (nonatomic, assign) NSTimeInterval transformDelay; // Simulate the slow transform
+@property (atomic, assign, readonly) NSUInteger transformCount;
 
 @end
@@ -16,6 +16,12 @@
 }
 
 - (UIImage *)transformedImageWithImage:(UIImage *)image forKey:(NSString *)key {
+    @synchronized (self) {
+        _transformCount++;
+    }
+    if (self.transformDelay > 0) {
+        [NSThread sleepForTimeInterval:self.transformDelay];
+    }
     return self.testImage;
 }
 
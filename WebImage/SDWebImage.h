@@ -24,7 +24,9 @@ FOUNDATION_EXPORT const unsigned char SDWebImageVersionString[];
 #import <SDWebImage/SDImageCacheConfig.h>
 #import <SDWebImage/SDImageCache.h>
 #import <SDWebImage/SDMemoryCache.h>
+#import <SDWebImage/SDShardedMemoryCache.h>
 #import <SDWebImage/SDDiskCache.h>
+#import <SDWebImage/SDPackedDiskCache.h>
 #import <SDWebImage/SDImageCacheDefine.h>
 #import <SDWebImage/SDImageCachesManager.h>
 #import <SDWebImage/UIView+WebCache.h>
@@ -55,6 +57,8 @@ FOUNDATION_EXPORT const unsigned char SDWebImageVersionString[];
 #import <SDWebImage/SDAnimatedImageView.h>
 #import <SDWebImage/SDAnimatedImageView+WebCache.h>
 #import <SDWebImage/SDAnimatedImagePlayer.h>
+#import <SDWebImage/SDAnimatedImageGovernor.h>
+#import <SDWebImage/SDImageSourceCache.h>
 #import <SDWebImage/SDImageCodersManager.h>
 #import <SDWebImage/SDImageCoder.h>
 #import <SDWebImage/SDImageAPNGCoder.h>